@@ -0,0 +1,20 @@
+QT += core widgets concurrent
+
+CONFIG += c++17
+
+TARGET = biblioteca_virtuale
+TEMPLATE = app
+
+# L'eseguibile resta nella cartella principale di compilazione
+DESTDIR = $$BIBLIO_BUILD_ROOT
+
+include(../model/model.pri)
+include(../view/view.pri)
+
+SOURCES += \
+    ../main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,233 @@
+#include <QApplication>
+#include <QComboBox>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScrollArea>
+#include <QScrollBar>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <algorithm>
+#include "../common/BenchmarkSupport.h"
+#include "../common/CatalogGenerator.h"
+#include "../../model/Biblioteca.h"
+#include "../../persistence/JsonSerializer.h"
+#include "../../view/MainWindow.h"
+
+/**
+ * Benchmark di reattività della finestra principale.
+ *
+ * Eseguito sulla piattaforma offscreen (nessun display richiesto), carica
+ * cataloghi sintetici di dimensione crescente e misura:
+ * - caricamento e tempo al primo disegno della griglia
+ * - aggiornamento dopo un cambio di filtro (slot sincrono e disegno)
+ * - latenza della selezione con un click, attraverso MainWindow::eventFilter
+ * - durata dei frame di scorrimento della griglia
+ *
+ * I risultati sono scritti in JSON su standard output o nel file indicato:
+ *   ./bench_gui [risultati.json]
+ * Le dimensioni si scelgono con BIBLIO_BENCH_SIZES come per bench_model.
+ */
+namespace
+{
+    constexpr int TimeoutMs = 30000;
+    constexpr int MaxClick = 10;
+
+    // Registra il primo evento Paint ricevuto da un widget della griglia dopo arma().
+    // I widget della griglia sono quelli con la proprietà "media" impostata da MainWindow.
+    class PaintProbe : public QObject
+    {
+    public:
+        void arma()
+        {
+            disegnato = false;
+            timer.start();
+        }
+
+        bool attendi()
+        {
+            return QTest::qWaitFor([this]()
+                                   { return disegnato; },
+                                   TimeoutMs);
+        }
+
+        // Millisecondi da arma() al primo disegno (-1 se non avvenuto)
+        double millisecondi() const { return disegnato ? msDisegno : -1.0; }
+
+    protected:
+        bool eventFilter(QObject *obj, QEvent *event) override
+        {
+            if (!disegnato && event->type() == QEvent::Paint && obj->isWidgetType())
+            {
+                if (obj->property("media").isValid())
+                {
+                    msDisegno = timer.nsecsElapsed() / 1e6;
+                    disegnato = true;
+                }
+            }
+            return QObject::eventFilter(obj, event);
+        }
+
+    private:
+        QElapsedTimer timer;
+        bool disegnato = false;
+        double msDisegno = -1.0;
+    };
+
+    QJsonObject statistiche(QVector<double> campioni)
+    {
+        QJsonObject risultato;
+        risultato["campioni"] = campioni.size();
+        if (campioni.isEmpty())
+        {
+            return risultato;
+        }
+        std::sort(campioni.begin(), campioni.end());
+        risultato["mediana_ms"] = campioni.at(campioni.size() / 2);
+        risultato["p95_ms"] = campioni.at(qMin(campioni.size() - 1, int(campioni.size() * 0.95)));
+        risultato["max_ms"] = campioni.last();
+        return risultato;
+    }
+
+    double msDa(const QElapsedTimer &timer)
+    {
+        return timer.nsecsElapsed() / 1e6;
+    }
+
+    QJsonObject misura(int dimensione, const QString &percorso, const QString &sessione)
+    {
+        QJsonObject risultato;
+        risultato["dimensione"] = dimensione;
+
+        // Sessione nella cartella temporanea: niente snapshot accanto all'eseguibile
+        MainWindow finestra(sessione);
+        finestra.show();
+        if (!QTest::qWaitForWindowExposed(&finestra))
+        {
+            risultato["errore"] = "finestra non esposta";
+            return risultato;
+        }
+
+        QScrollArea *scrollArea = finestra.findChild<QScrollArea *>();
+        QComboBox *filtro = finestra.findChild<QComboBox *>();
+        PaintProbe sonda;
+        qApp->installEventFilter(&sonda);
+
+        // Caricamento e primo disegno
+        QElapsedTimer timer;
+        sonda.arma();
+        timer.start();
+        finestra.loadLibraryFromFile(percorso);
+        risultato["caricamento_ms"] = msDa(timer);
+        sonda.attendi();
+        risultato["primo_disegno_ms"] = sonda.millisecondi();
+
+        // Cambio di filtro: ogni tipo e ritorno a "Tutti"
+        QVector<double> filtroSincrono;
+        QVector<double> filtroDisegno;
+        for (int indice : {1, 2, 3, 0})
+        {
+            sonda.arma();
+            timer.start();
+            filtro->setCurrentIndex(indice);
+            filtroSincrono.append(msDa(timer));
+            sonda.attendi();
+            filtroDisegno.append(sonda.millisecondi());
+        }
+        risultato["filtro_sincrono"] = statistiche(filtroSincrono);
+        risultato["filtro_disegno"] = statistiche(filtroDisegno);
+
+        // Selezione con click sui widget della griglia
+        QVector<double> selezione;
+        QVector<double> selezioneDisegno;
+        const QList<QWidget *> figli = scrollArea->widget()->findChildren<QWidget *>(QString(), Qt::FindDirectChildrenOnly);
+        for (QWidget *widget : figli)
+        {
+            if (selezione.size() == MaxClick)
+            {
+                break;
+            }
+            if (!widget->property("clickable").toBool())
+            {
+                continue;
+            }
+            sonda.arma();
+            timer.start();
+            QTest::mouseClick(widget, Qt::LeftButton);
+            selezione.append(msDa(timer));
+            sonda.attendi();
+            selezioneDisegno.append(sonda.millisecondi());
+        }
+        risultato["selezione"] = statistiche(selezione);
+        risultato["selezione_disegno"] = statistiche(selezioneDisegno);
+
+        // Scorrimento a passi di un quarto di pagina
+        QVector<double> frame;
+        QScrollBar *barra = scrollArea->verticalScrollBar();
+        const int passo = qMax(1, barra->pageStep() / 4);
+        for (int valore = barra->minimum() + passo; valore <= barra->maximum(); valore += passo)
+        {
+            sonda.arma();
+            barra->setValue(valore);
+            sonda.attendi();
+            frame.append(sonda.millisecondi());
+        }
+        risultato["scorrimento"] = statistiche(frame);
+
+        qApp->removeEventFilter(&sonda);
+        risultato["picco_rss_kib"] = Benchmark::piccoRssKiB();
+        return risultato;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    QTemporaryDir cartella;
+    if (!cartella.isValid())
+    {
+        qCritical("Impossibile creare la cartella temporanea");
+        return 1;
+    }
+
+    QJsonArray risultati;
+    for (int dimensione : Benchmark::dimensioni())
+    {
+        const QString percorso = cartella.filePath(QString("catalogo_%1.json").arg(dimensione));
+        {
+            Biblioteca catalogo;
+            CatalogGenerator().riempi(catalogo, dimensione);
+            JsonSerializer::salvaBibliotecaThrows(catalogo, percorso);
+        }
+        risultati.append(misura(dimensione, percorso, cartella.filePath(QString("sessione_%1.json").arg(dimensione))));
+    }
+
+    QJsonObject documento;
+    documento["qt"] = QString::fromLatin1(qVersion());
+    documento["piattaforma"] = QGuiApplication::platformName();
+    documento["risultati"] = risultati;
+    const QByteArray json = QJsonDocument(documento).toJson();
+
+    const QStringList argomenti = QCoreApplication::arguments();
+    if (argomenti.size() > 1)
+    {
+        QFile file(argomenti.at(1));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+        {
+            qCritical("Impossibile scrivere %s", qPrintable(argomenti.at(1)));
+            return 1;
+        }
+        return 0;
+    }
+
+    QFile uscita;
+    uscita.open(stdout, QIODevice::WriteOnly);
+    uscita.write(json);
+    return 0;
+}
@@ -0,0 +1,16 @@
+QT = core gui widgets concurrent testlib
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = bench_gui
+TEMPLATE = app
+
+DESTDIR = $$OUT_PWD/..
+
+include(../../model/model.pri)
+include(../../view/view.pri)
+include(../common/common.pri)
+
+SOURCES += \
+    bench_gui.cpp
@@ -0,0 +1,331 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QMap>
+#include "../common/BenchmarkSupport.h"
+#include "../common/CatalogGenerator.h"
+#include "../../model/Biblioteca.h"
+#include "../../persistence/JsonSerializer.h"
+#include "../../persistence/StreamExporter.h"
+
+/**
+ * Benchmark del modello e della persistenza su cataloghi sintetici.
+ *
+ * Ogni benchmark è eseguito per tutte le dimensioni di Benchmark::dimensioni().
+ * Esempi:
+ *   ./bench_model
+ *   BIBLIO_BENCH_SIZES=1000,1000000 ./bench_model cercaPerTitolo
+ *   ./bench_model -o risultati.xml,xml
+ */
+class BenchModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~BenchModel() override { qDeleteAll(cataloghi); }
+
+private:
+    // Oltre questa dimensione l'inserimento singolo (con controllo dei duplicati
+    // lineare) richiederebbe minuti: si misura solo quello in blocco
+    static constexpr int LimiteInserimentoSingolo = 100000;
+    static constexpr int OperazioniPuntuali = 100;
+
+    QMap<int, Biblioteca *> cataloghi;
+    QTemporaryDir cartella;
+
+    // Catalogo condiviso per le misure in sola lettura, generato alla prima richiesta
+    Biblioteca &catalogo(int dimensione)
+    {
+        Biblioteca *&biblioteca = cataloghi[dimensione];
+        if (!biblioteca)
+        {
+            biblioteca = new Biblioteca;
+            CatalogGenerator().riempi(*biblioteca, dimensione);
+        }
+        return *biblioteca;
+    }
+
+    // Esportazione in streaming dell'intero catalogo, come "biblio-cli export"
+    void esporta(StreamExporter::Formato formato, const char *estensione)
+    {
+        QFETCH(int, dimensione);
+        QVERIFY(cartella.isValid());
+        const Biblioteca &biblioteca = catalogo(dimensione);
+        const RoaringBitmap tutti = biblioteca.eseguiQuery(MediaFilter::Query());
+        const QString percorso = cartella.filePath(QString("esportazione_%1.%2").arg(dimensione).arg(estensione));
+        StreamExporter::Opzioni opzioni;
+        opzioni.formato = formato;
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            const StreamExporter::Report report = StreamExporter::esportaThrows(biblioteca, tutti, percorso, opzioni);
+            QCOMPARE(report.esportati, dimensione);
+            misura.conta(dimensione);
+        }
+    }
+
+    static void datiDimensioni()
+    {
+        QTest::addColumn<int>("dimensione");
+        for (int dimensione : Benchmark::dimensioni())
+        {
+            QTest::newRow(QByteArray::number(dimensione).constData()) << dimensione;
+        }
+    }
+
+private slots:
+    void aggiungiMedia_data() { datiDimensioni(); }
+    void aggiungiMedia()
+    {
+        QFETCH(int, dimensione);
+        if (dimensione > LimiteInserimentoSingolo)
+        {
+            QSKIP("Inserimento singolo misurato solo fino a 100000 elementi");
+        }
+        const QList<Media *> originali = catalogo(dimensione).getTuttiMedia();
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            Biblioteca biblioteca;
+            for (Media *media : originali)
+            {
+                biblioteca.aggiungiMedia(media->clone());
+            }
+            misura.conta(dimensione);
+        }
+    }
+
+    void aggiungiMediaBulk_data() { datiDimensioni(); }
+    void aggiungiMediaBulk()
+    {
+        QFETCH(int, dimensione);
+        const QList<Media *> originali = catalogo(dimensione).getTuttiMedia();
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            QList<Media *> copie;
+            copie.reserve(originali.size());
+            for (Media *media : originali)
+            {
+                copie.append(media->clone());
+            }
+            Biblioteca biblioteca;
+            biblioteca.aggiungiMediaBulk(copie);
+            misura.conta(dimensione);
+        }
+    }
+
+    void contiene_data() { datiDimensioni(); }
+    void contiene()
+    {
+        QFETCH(int, dimensione);
+        QList<Media *> copie;
+        for (Media *media : catalogo(dimensione).getTuttiMedia())
+        {
+            copie.append(media->clone());
+        }
+        Container<Media> container;
+        container.addAll(copie);
+        // Elementi dalla fine: caso peggiore per la ricerca lineare
+        QList<Media *> cercati;
+        for (int i = 0; i < OperazioniPuntuali; ++i)
+        {
+            cercati.append(container.at(container.size() - 1 - i % container.size()));
+        }
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            int trovati = 0;
+            for (Media *media : qAsConst(cercati))
+            {
+                trovati += container.contains(media) ? 1 : 0;
+            }
+            QCOMPARE(trovati, OperazioniPuntuali);
+            misura.conta(OperazioniPuntuali);
+        }
+    }
+
+    void rimuoviMedia_data() { datiDimensioni(); }
+    void rimuoviMedia()
+    {
+        QFETCH(int, dimensione);
+        Biblioteca biblioteca(catalogo(dimensione));
+        const int daRimuovere = qMin(OperazioniPuntuali, dimensione);
+        Benchmark::Throughput misura;
+        // La rimozione modifica la biblioteca: una sola iterazione su una copia
+        QBENCHMARK_ONCE
+        {
+            for (int i = 0; i < daRimuovere; ++i)
+            {
+                biblioteca.rimuoviMediaAt(biblioteca.dimensione() / 2);
+            }
+            misura.conta(daRimuovere);
+        }
+        QCOMPARE(biblioteca.dimensione(), dimensione - daRimuovere);
+    }
+
+    void cercaPerTitolo_data() { datiDimensioni(); }
+    void cercaPerTitolo()
+    {
+        QFETCH(int, dimensione);
+        const Biblioteca &biblioteca = catalogo(dimensione);
+        const QString parola = CatalogGenerator::parole().first();
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            const QList<Media *> risultati = biblioteca.cercaPerTitolo(parola);
+            Q_UNUSED(risultati);
+            misura.conta(dimensione);
+        }
+    }
+
+    void cercaPerAnno_data() { datiDimensioni(); }
+    void cercaPerAnno()
+    {
+        QFETCH(int, dimensione);
+        const Biblioteca &biblioteca = catalogo(dimensione);
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            const QList<Media *> risultati = biblioteca.cercaPerAnno(1980);
+            Q_UNUSED(risultati);
+            misura.conta(dimensione);
+        }
+    }
+
+    void collectMediaByType_data() { datiDimensioni(); }
+    void collectMediaByType()
+    {
+        QFETCH(int, dimensione);
+        const Biblioteca &biblioteca = catalogo(dimensione);
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            int totale = biblioteca.collectMediaByType(MediaFilter::FilterType::BOOKS_ONLY).size();
+            totale += biblioteca.collectMediaByType(MediaFilter::FilterType::FILMS_ONLY).size();
+            totale += biblioteca.collectMediaByType(MediaFilter::FilterType::ARTICLES_ONLY).size();
+            QCOMPARE(totale, dimensione);
+            misura.conta(dimensione);
+        }
+    }
+
+    void copia_data() { datiDimensioni(); }
+    void copia()
+    {
+        QFETCH(int, dimensione);
+        const Biblioteca &originale = catalogo(dimensione);
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            Biblioteca copia(originale);
+            QCOMPARE(copia.dimensione(), dimensione);
+            misura.conta(dimensione);
+        }
+    }
+
+    void clona_data() { datiDimensioni(); }
+    void clona()
+    {
+        QFETCH(int, dimensione);
+        const QList<Media *> originali = catalogo(dimensione).getTuttiMedia();
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            QList<Media *> copie;
+            copie.reserve(originali.size());
+            for (Media *media : originali)
+            {
+                copie.append(media->clone());
+            }
+            qDeleteAll(copie);
+            misura.conta(dimensione);
+        }
+    }
+
+    void salvaJson_data() { datiDimensioni(); }
+    void salvaJson()
+    {
+        QFETCH(int, dimensione);
+        QVERIFY(cartella.isValid());
+        const Biblioteca &biblioteca = catalogo(dimensione);
+        const QString percorso = cartella.filePath(QString("catalogo_%1.json").arg(dimensione));
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            JsonSerializer::salvaBibliotecaThrows(biblioteca, percorso);
+            misura.conta(dimensione);
+        }
+    }
+
+    void caricaJson_data() { datiDimensioni(); }
+    void caricaJson()
+    {
+        QFETCH(int, dimensione);
+        QVERIFY(cartella.isValid());
+        const QString percorso = cartella.filePath(QString("catalogo_%1.json").arg(dimensione));
+        if (!QFile::exists(percorso))
+        {
+            JsonSerializer::salvaBibliotecaThrows(catalogo(dimensione), percorso);
+        }
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            Biblioteca biblioteca;
+            JsonSerializer::caricaBibliotecaThrows(biblioteca, percorso);
+            QCOMPARE(biblioteca.dimensione(), dimensione);
+            misura.conta(dimensione);
+        }
+    }
+
+    void esportaJsonLines_data() { datiDimensioni(); }
+    void esportaJsonLines() { esporta(StreamExporter::Formato::JsonLines, "jsonl"); }
+
+    void esportaCsv_data() { datiDimensioni(); }
+    void esportaCsv() { esporta(StreamExporter::Formato::Csv, "csv"); }
+
+    // Caricamento differito: solo tipo, titolo e anno decodificati, più la
+    // materializzazione di una schermata (40 Media) come fa la griglia
+    void caricaJsonDifferito_data() { datiDimensioni(); }
+    void caricaJsonDifferito()
+    {
+        QFETCH(int, dimensione);
+        QVERIFY(cartella.isValid());
+        const QString percorso = cartella.filePath(QString("catalogo_%1.json").arg(dimensione));
+        if (!QFile::exists(percorso))
+        {
+            JsonSerializer::salvaBibliotecaThrows(catalogo(dimensione), percorso);
+        }
+        JsonSerializer::Avanzamento opzioni;
+        opzioni.campiDifferiti = true;
+        Benchmark::Throughput misura;
+        QBENCHMARK
+        {
+            Biblioteca biblioteca;
+            JsonSerializer::caricaBibliotecaThrows(biblioteca, percorso, opzioni);
+            QCOMPARE(biblioteca.dimensione(), dimensione);
+            for (int i = 0; i < qMin(40, dimensione); ++i)
+            {
+                biblioteca.getMediaAt(i)->materializza();
+            }
+            misura.conta(dimensione);
+        }
+    }
+
+    // Costo della stima e byte per Media, per confrontare le ottimizzazioni di memoria
+    void memoryFootprint_data() { datiDimensioni(); }
+    void memoryFootprint()
+    {
+        QFETCH(int, dimensione);
+        const Biblioteca &biblioteca = catalogo(dimensione);
+        biblioteca.cercaPerAnno(2000); // indici costruiti, come dopo la prima query
+        MemoryReport report;
+        QBENCHMARK
+        {
+            report = biblioteca.memoryFootprint();
+        }
+        qInfo("%d media: %lld byte stimati (%lld per media, stringhe %lld)", dimensione, report.total(),
+              report.total() / qMax(1, dimensione), report.stringBytesTotal());
+    }
+};
+
+QTEST_GUILESS_MAIN(BenchModel)
+#include "bench_model.moc"
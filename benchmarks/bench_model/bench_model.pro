@@ -0,0 +1,15 @@
+QT = core concurrent testlib
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = bench_model
+TEMPLATE = app
+
+DESTDIR = $$OUT_PWD/..
+
+include(../../model/model.pri)
+include(../common/common.pri)
+
+SOURCES += \
+    bench_model.cpp
@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+# bench_model: modello e persistenza (QtCore)
+# bench_gui:   reattività della finestra principale (piattaforma offscreen)
+SUBDIRS += \
+    bench_model \
+    bench_gui
@@ -0,0 +1,61 @@
+#include "BenchmarkSupport.h"
+#include <QtTest>
+#include <QStringList>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace Benchmark
+{
+    QList<int> dimensioni(const QList<int> &predefinite)
+    {
+        const QByteArray valore = qgetenv("BIBLIO_BENCH_SIZES");
+        if (valore.isEmpty())
+        {
+            return predefinite;
+        }
+
+        QList<int> risultato;
+        for (const QString &parte : QString::fromLatin1(valore).split(QLatin1Char(',')))
+        {
+            bool ok = false;
+            const int dimensione = parte.trimmed().toInt(&ok);
+            if (ok && dimensione > 0)
+            {
+                risultato.append(dimensione);
+            }
+        }
+        return risultato.isEmpty() ? predefinite : risultato;
+    }
+
+    qint64 piccoRssKiB()
+    {
+#if defined(Q_OS_UNIX)
+        struct rusage uso;
+        if (getrusage(RUSAGE_SELF, &uso) == 0)
+        {
+#if defined(Q_OS_MACOS)
+            return qint64(uso.ru_maxrss) / 1024; // byte su macOS
+#else
+            return qint64(uso.ru_maxrss); // KiB su Linux
+#endif
+        }
+#endif
+        return -1;
+    }
+
+    Throughput::Throughput()
+    {
+        timer.start();
+    }
+
+    Throughput::~Throughput()
+    {
+        const qint64 nanosecondi = timer.nsecsElapsed();
+        const double perSecondo = nanosecondi > 0 ? double(totale) * 1e9 / double(nanosecondi) : 0.0;
+        qInfo("%s(%s): %.0f elementi/s, picco RSS %lld KiB",
+              QTest::currentTestFunction(), QTest::currentDataTag() ? QTest::currentDataTag() : "",
+              perSecondo, piccoRssKiB());
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef BENCHMARKSUPPORT_H
+#define BENCHMARKSUPPORT_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+namespace Benchmark
+{
+    /**
+     * Dimensioni dei cataloghi da misurare.
+     * La variabile d'ambiente BIBLIO_BENCH_SIZES (es. "1000,100000,10000000")
+     * sostituisce le dimensioni predefinite.
+     */
+    QList<int> dimensioni(const QList<int> &predefinite = {1000, 10000, 100000});
+
+    // Picco della memoria residente del processo in KiB (-1 se non disponibile)
+    qint64 piccoRssKiB();
+
+    /**
+     * Misura il throughput di un blocco QBENCHMARK: il blocco chiama conta()
+     * con il numero di elementi elaborati a ogni iterazione e alla distruzione
+     * viene stampata una riga con elementi/s e picco RSS.
+     */
+    class Throughput
+    {
+    public:
+        Throughput();
+        ~Throughput();
+
+        void conta(qint64 elementi) { totale += elementi; }
+
+    private:
+        QElapsedTimer timer;
+        qint64 totale = 0;
+    };
+}
+
+#endif // BENCHMARKSUPPORT_H
@@ -0,0 +1,105 @@
+#include "CatalogGenerator.h"
+#include "../../model/Biblioteca.h"
+#include "../../model/Book.h"
+#include "../../model/Film.h"
+#include "../../model/MagazineArticle.h"
+
+namespace
+{
+    const char *const Nomi[] = {"Anna", "Marco", "Giulia", "Luca", "Sara", "Paolo", "Elena", "Davide"};
+    const char *const Cognomi[] = {"Rossi", "Bianchi", "Ferrari", "Esposito", "Romano", "Colombo", "Ricci", "Greco"};
+    const char *const Generi[] = {"Drammatico", "Commedia", "Fantascienza", "Storico", "Documentario"};
+    const char *const Editori[] = {"Einaudi", "Mondadori", "Feltrinelli", "Adelphi", "Bompiani"};
+    const char *const Riviste[] = {"Nature", "Science", "Le Scienze", "Lancet", "Physical Review"};
+
+    template <typename T, int N>
+    constexpr int dimensione(const T (&)[N])
+    {
+        return N;
+    }
+}
+
+CatalogGenerator::CatalogGenerator(quint64 seme)
+    : stato(seme ? seme : 1)
+{
+}
+
+const QStringList &CatalogGenerator::parole()
+{
+    static const QStringList vocabolario = {
+        "rosa", "notte", "mare", "città", "tempo", "viaggio", "silenzio", "luce",
+        "guerra", "amore", "fiume", "inverno", "giardino", "specchio", "ombra", "vento"};
+    return vocabolario;
+}
+
+/**
+ * xorshift64*: veloce e identico su tutte le piattaforme e versioni di Qt
+ */
+quint32 CatalogGenerator::prossimo()
+{
+    stato ^= stato >> 12;
+    stato ^= stato << 25;
+    stato ^= stato >> 27;
+    return quint32((stato * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+int CatalogGenerator::intervallo(int minimo, int massimo)
+{
+    return minimo + int(prossimo() % quint32(massimo - minimo + 1));
+}
+
+QString CatalogGenerator::titolo()
+{
+    const QStringList &vocabolario = parole();
+    QString risultato = vocabolario.at(intervallo(0, vocabolario.size() - 1));
+    risultato[0] = risultato.at(0).toUpper();
+    risultato += QLatin1Char(' ');
+    risultato += vocabolario.at(intervallo(0, vocabolario.size() - 1));
+    risultato += QLatin1Char(' ');
+    risultato += QString::number(progressivo);
+    return risultato;
+}
+
+QString CatalogGenerator::persona()
+{
+    return QLatin1String(Nomi[intervallo(0, dimensione(Nomi) - 1)]) + QLatin1Char(' ') +
+           QLatin1String(Cognomi[intervallo(0, dimensione(Cognomi) - 1)]);
+}
+
+Media *CatalogGenerator::genera()
+{
+    ++progressivo;
+    const QString titoloRecord = titolo();
+    const int anno = intervallo(AnnoMinimo, AnnoMassimo);
+    const int tipo = intervallo(0, 9);
+
+    if (tipo < 5)
+    {
+        return new Book(titoloRecord, anno, persona(), QString::number(9780000000000LL + progressivo),
+                        QLatin1String(Editori[intervallo(0, dimensione(Editori) - 1)]));
+    }
+    if (tipo < 8)
+    {
+        return new Film(titoloRecord, anno, persona(), intervallo(60, 200),
+                        QLatin1String(Generi[intervallo(0, dimensione(Generi) - 1)]));
+    }
+    return new MagazineArticle(titoloRecord, anno, persona(),
+                               QLatin1String(Riviste[intervallo(0, dimensione(Riviste) - 1)]),
+                               QLatin1String("10.5555/") + QString::number(progressivo));
+}
+
+QList<Media *> CatalogGenerator::genera(int quantita)
+{
+    QList<Media *> risultato;
+    risultato.reserve(quantita);
+    for (int i = 0; i < quantita; ++i)
+    {
+        risultato.append(genera());
+    }
+    return risultato;
+}
+
+void CatalogGenerator::riempi(Biblioteca &biblioteca, int quantita)
+{
+    biblioteca.aggiungiMediaBulk(genera(quantita));
+}
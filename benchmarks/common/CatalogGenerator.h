@@ -0,0 +1,45 @@
+#ifndef CATALOGGENERATOR_H
+#define CATALOGGENERATOR_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class Media;
+class Biblioteca;
+
+/**
+ * CatalogGenerator - Catalogo sintetico per i benchmark
+ *
+ * Produce record misti (50% Book, 30% Film, 20% MagazineArticle) con titoli
+ * composti da un vocabolario fisso, anni tra 1900 e 2024 e identificativi unici.
+ * Il generatore è deterministico: a parità di seme produce sempre lo stesso
+ * catalogo, quindi i risultati sono confrontabili tra esecuzioni e versioni.
+ */
+class CatalogGenerator
+{
+public:
+    explicit CatalogGenerator(quint64 seme = 0x5EEDB1B1u);
+
+    // Un nuovo record; la proprietà passa al chiamante
+    Media *genera();
+    QList<Media *> genera(int quantita);
+    void riempi(Biblioteca &biblioteca, int quantita);
+
+    // Parole usate nei titoli: ognuna compare in circa un titolo su parole().size()
+    static const QStringList &parole();
+
+    static constexpr int AnnoMinimo = 1900;
+    static constexpr int AnnoMassimo = 2024;
+
+private:
+    quint64 stato;
+    int progressivo = 0;
+
+    quint32 prossimo();
+    int intervallo(int minimo, int massimo);
+    QString titolo();
+    QString persona();
+};
+
+#endif // CATALOGGENERATOR_H
@@ -0,0 +1,11 @@
+# Generatore di cataloghi e misure comuni ai benchmark
+
+QT *= testlib
+
+SOURCES += \
+    $$PWD/BenchmarkSupport.cpp \
+    $$PWD/CatalogGenerator.cpp
+
+HEADERS += \
+    $$PWD/BenchmarkSupport.h \
+    $$PWD/CatalogGenerator.h
@@ -0,0 +1,19 @@
+QT = core concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = biblio-cli
+TEMPLATE = app
+
+DESTDIR = $$BIBLIO_BUILD_ROOT
+
+include(../model/model.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,372 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+#include "../model/Biblioteca.h"
+#include "../model/DuplicateDetector.h"
+#include "../model/MediaVisitorT.h"
+#include "../persistence/JsonSerializer.h"
+#include "../persistence/ShardedCatalog.h"
+#include "../persistence/BatchImporter.h"
+#include "../persistence/StreamExporter.h"
+#include "../diagnostics/Tracing.h"
+
+/**
+ * biblio-cli - Elaborazione dei cataloghi senza interfaccia grafica
+ *
+ * Usa solo QtCore e la libreria del modello: può essere eseguito su server
+ * senza display (job notturni, script di importazione).
+ *
+ *   biblio-cli search <catalogo> [--titolo T] [--tipo K] [--anno A] [--limite N]
+ *   biblio-cli export <catalogo> <destinazione> [filtri] [--genere G] [--rivista R]
+ *              (destinazione JSON, oppure .csv, .jsonl in streaming con StreamExporter)
+ *   biblio-cli import <catalogo> <sorgente>... [--politica P] [--output F]
+ *              (sorgenti JSON, oppure .csv, .jsonl, .mrk con BatchImporter)
+ *   biblio-cli dedup  <catalogo> [--politica P] [--output F]
+ *   biblio-cli shard  <catalogo> <manifest> [--partizione tipo|hash] [--shard N]
+ *
+ * Ogni comando accetta come catalogo anche il manifest di un catalogo a shard.
+ */
+namespace
+{
+    enum CodiceUscita
+    {
+        Successo = 0,
+        Errore = 1,
+        UsoErrato = 2
+    };
+
+    QTextStream &uscita()
+    {
+        static QTextStream stream(stdout);
+        return stream;
+    }
+
+    QTextStream &errori()
+    {
+        static QTextStream stream(stderr);
+        return stream;
+    }
+
+    // Tag JSON del tipo concreto, con smistamento statico
+    class TagVisitor : public StaticMediaVisitor<TagVisitor, const char *>
+    {
+    public:
+        const char *visit(const Book &) const { return Book::TypeTag; }
+        const char *visit(const Film &) const { return Film::TypeTag; }
+        const char *visit(const MagazineArticle &) const { return MagazineArticle::TypeTag; }
+    };
+
+    bool leggiTipo(const QString &valore, MediaFilter::FilterType &tipo)
+    {
+        if (valore == "tutti")
+            tipo = MediaFilter::FilterType::ALL;
+        else if (valore == "libri")
+            tipo = MediaFilter::FilterType::BOOKS_ONLY;
+        else if (valore == "film")
+            tipo = MediaFilter::FilterType::FILMS_ONLY;
+        else if (valore == "articoli")
+            tipo = MediaFilter::FilterType::ARTICLES_ONLY;
+        else
+            return false;
+        return true;
+    }
+
+    bool leggiPolitica(const QString &valore, Deduplicazione::Politica &politica)
+    {
+        if (valore == "rifiuta")
+            politica = Deduplicazione::Politica::RIFIUTA;
+        else if (valore == "unisci")
+            politica = Deduplicazione::Politica::UNISCI;
+        else if (valore == "segnala")
+            politica = Deduplicazione::Politica::SEGNALA;
+        else
+            return false;
+        return true;
+    }
+
+    const char *nomeMotivo(Deduplicazione::Motivo motivo)
+    {
+        switch (motivo)
+        {
+        case Deduplicazione::Motivo::ISBN:
+            return "isbn";
+        case Deduplicazione::Motivo::DOI:
+            return "doi";
+        case Deduplicazione::Motivo::IMPRONTA:
+            return "impronta";
+        case Deduplicazione::Motivo::SIMILARITA:
+            return "similarita";
+        }
+        return "";
+    }
+
+    // Query dai filtri della riga di comando; false se un valore non è valido
+    bool leggiQuery(const QCommandLineParser &parser, MediaFilter::Query &query)
+    {
+        query.titolo = parser.value("titolo");
+        if (parser.isSet("tipo") && !leggiTipo(parser.value("tipo"), query.tipo))
+        {
+            errori() << "Tipo non valido: " << parser.value("tipo") << '\n';
+            return false;
+        }
+        if (parser.isSet("anno"))
+        {
+            bool ok = false;
+            query.anno = parser.value("anno").toInt(&ok);
+            query.filtraAnno = true;
+            if (!ok)
+            {
+                errori() << "Anno non valido: " << parser.value("anno") << '\n';
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Filtri sui campi non indicizzati dalla query (genere dei film, rivista degli articoli)
+    std::function<bool(const Media &)> leggiFiltro(const QCommandLineParser &parser)
+    {
+        if (!parser.isSet("genere") && !parser.isSet("rivista"))
+        {
+            return {};
+        }
+        const QString genere = parser.value("genere");
+        const QString rivista = parser.value("rivista");
+        return [genere, rivista](const Media &media)
+        {
+            // Con entrambi i filtri vengono esportati sia i film sia gli articoli corrispondenti
+            if (media.tipo() == MediaKind::Film && !genere.isEmpty())
+            {
+                return static_cast<const Film &>(media).getGenreRef().compare(genere, Qt::CaseInsensitive) == 0;
+            }
+            if (media.tipo() == MediaKind::MagazineArticle && !rivista.isEmpty())
+            {
+                return static_cast<const MagazineArticle &>(media).getMagazineRef().compare(rivista, Qt::CaseInsensitive) == 0;
+            }
+            return false;
+        };
+    }
+
+    void stampaMedia(Media *media)
+    {
+        TagVisitor tag;
+        uscita() << tag.apply(*media) << '\t' << media->getYear() << '\t' << media->getTitle() << '\n';
+    }
+
+    void stampaReport(const Deduplicazione::Report &report)
+    {
+        for (const Deduplicazione::Duplicato &duplicato : report.duplicati)
+        {
+            uscita() << nomeMotivo(duplicato.motivo) << '\t'
+                     << QString::number(duplicato.similarita, 'f', 2) << '\t'
+                     << duplicato.titolo << '\t' << duplicato.esistente->getTitle() << '\n';
+        }
+        errori() << "Esaminati: " << report.esaminati << ", aggiunti: " << report.aggiunti
+                 << ", rifiutati: " << report.rifiutati << ", uniti: " << report.uniti
+                 << ", segnalati: " << report.segnalati << '\n';
+    }
+
+    // Flussi CSV, JSON-lines e MARC passano dalla pipeline parallela; il resto è un catalogo JSON
+    Deduplicazione::Report importa(Biblioteca &biblioteca, const QString &sorgente, Deduplicazione::Politica politica)
+    {
+        BatchImporter::Formato formato;
+        if (!BatchImporter::formatoDaPath(sorgente, &formato))
+        {
+            return JsonSerializer::importaBibliotecaThrows(biblioteca, sorgente, politica);
+        }
+        BatchImporter::Opzioni opzioni;
+        opzioni.politica = politica;
+        const BatchImporter::Report report = BatchImporter::importaThrows(biblioteca, sorgente, opzioni);
+        for (const BatchImporter::ErroreRiga &errore : report.errori)
+        {
+            errori() << sorgente << ':' << errore.riga << ": " << errore.messaggio << '\n';
+        }
+        errori() << sorgente << ": record " << report.record << ", scartati " << report.scartati << '\n';
+        return report.deduplicazione;
+    }
+
+    int cerca(const Biblioteca &biblioteca, const MediaFilter::Query &query, int limite)
+    {
+        if (limite > 0)
+        {
+            const MediaFilter::Page pagina = biblioteca.eseguiQueryPaginata(query, 0, limite);
+            for (Media *media : pagina.items)
+            {
+                stampaMedia(media);
+            }
+            errori() << "Risultati: " << pagina.totaleStimato << (pagina.totaleEsatto ? "" : " (stima)") << '\n';
+            return Successo;
+        }
+
+        const RoaringBitmap risultati = biblioteca.eseguiQuery(query);
+        for (Media *media : biblioteca.materializza(risultati))
+        {
+            stampaMedia(media);
+        }
+        errori() << "Risultati: " << risultati.cardinality() << '\n';
+        return Successo;
+    }
+
+    // CSV e JSON-lines in streaming, senza copiare i risultati; il resto è un catalogo JSON
+    int esporta(const Biblioteca &biblioteca, const MediaFilter::Query &query,
+                const std::function<bool(const Media &)> &filtro, const QString &destinazione)
+    {
+        StreamExporter::Opzioni opzioni;
+        opzioni.filtro = filtro;
+        if (StreamExporter::formatoDaPath(destinazione, &opzioni.formato))
+        {
+            const StreamExporter::Report report =
+                StreamExporter::esportaThrows(biblioteca, biblioteca.eseguiQuery(query), destinazione, opzioni);
+            errori() << "Esportati: " << report.esportati << " (" << report.byte << " byte)" << '\n';
+            return Successo;
+        }
+
+        Biblioteca selezione;
+        QList<Media *> copie;
+        for (Media *media : biblioteca.materializza(biblioteca.eseguiQuery(query)))
+        {
+            if (!filtro || filtro(*media))
+            {
+                copie.append(media->clone());
+            }
+        }
+        selezione.aggiungiMediaBulk(copie);
+        JsonSerializer::salvaBibliotecaThrows(selezione, destinazione);
+        errori() << "Esportati: " << selezione.dimensione() << '\n';
+        return Successo;
+    }
+
+    int suddividi(const Biblioteca &biblioteca, const QString &manifest, const ShardedCatalog::Opzioni &opzioni)
+    {
+        const ShardedCatalog::Report report = ShardedCatalog::salvaThrows(biblioteca, manifest, opzioni);
+        errori() << "Shard: " << report.shardTotali << ", riscritti: " << report.shardScritti
+                 << " (" << report.byteScritti << " byte)" << '\n';
+        return Successo;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    Tracing::initFromEnvironment();
+    QCoreApplication::setApplicationName("biblio-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Importazione, esportazione, ricerca e deduplicazione di cataloghi");
+    parser.addHelpOption();
+    parser.addPositionalArgument("comando", "search | export | import | dedup | shard");
+    parser.addPositionalArgument("catalogo", "File JSON del catalogo");
+    parser.addOptions({
+        {"titolo", "Filtra per sottostringa del titolo.", "testo"},
+        {"tipo", "Filtra per tipo: tutti, libri, film, articoli.", "tipo"},
+        {"anno", "Filtra per anno di pubblicazione.", "anno"},
+        {"genere", "Solo i film del genere indicato (export).", "genere"},
+        {"rivista", "Solo gli articoli della rivista indicata (export).", "rivista"},
+        {"limite", "Numero massimo di risultati (search).", "n"},
+        {"politica", "Gestione dei duplicati: rifiuta, unisci, segnala.", "politica", "rifiuta"},
+        {"output", "File di destinazione (import, dedup).", "file"},
+        {"partizione", "Ripartizione degli shard: tipo, hash (shard).", "partizione", "hash"},
+        {"shard", "Numero di shard con la partizione per hash (shard).", "n", "8"},
+    });
+    parser.process(app);
+
+    const QStringList argomenti = parser.positionalArguments();
+    if (argomenti.size() < 2)
+    {
+        parser.showHelp(UsoErrato);
+    }
+    const QString comando = argomenti.at(0);
+    const QString catalogo = argomenti.at(1);
+
+    MediaFilter::Query query;
+    Deduplicazione::Politica politica = Deduplicazione::Politica::RIFIUTA;
+    if (!leggiQuery(parser, query))
+    {
+        return UsoErrato;
+    }
+    if (!leggiPolitica(parser.value("politica"), politica))
+    {
+        errori() << "Politica non valida: " << parser.value("politica") << '\n';
+        return UsoErrato;
+    }
+
+    ShardedCatalog::Opzioni opzioni;
+    if (parser.value("partizione") == "tipo")
+    {
+        opzioni.partizione = ShardedCatalog::Partizione::Tipo;
+    }
+    else if (parser.value("partizione") != "hash")
+    {
+        errori() << "Partizione non valida: " << parser.value("partizione") << '\n';
+        return UsoErrato;
+    }
+    bool numeroValido = false;
+    opzioni.numeroShard = parser.value("shard").toInt(&numeroValido);
+    if (!numeroValido || opzioni.numeroShard < 1)
+    {
+        errori() << "Numero di shard non valido: " << parser.value("shard") << '\n';
+        return UsoErrato;
+    }
+
+    try
+    {
+        Biblioteca biblioteca;
+        if (comando == "search")
+        {
+            JsonSerializer::caricaBibliotecaThrows(biblioteca, catalogo);
+            return cerca(biblioteca, query, parser.value("limite").toInt());
+        }
+        if (comando == "export" && argomenti.size() == 3)
+        {
+            JsonSerializer::caricaBibliotecaThrows(biblioteca, catalogo);
+            return esporta(biblioteca, query, leggiFiltro(parser), argomenti.at(2));
+        }
+        if (comando == "import" && argomenti.size() >= 3)
+        {
+            // Il catalogo di destinazione può non esistere ancora
+            if (QFile::exists(catalogo))
+            {
+                JsonSerializer::caricaBibliotecaThrows(biblioteca, catalogo);
+            }
+            Deduplicazione::Report totale;
+            for (int i = 2; i < argomenti.size(); ++i)
+            {
+                const Deduplicazione::Report report = importa(biblioteca, argomenti.at(i), politica);
+                totale.esaminati += report.esaminati;
+                totale.aggiunti += report.aggiunti;
+                totale.rifiutati += report.rifiutati;
+                totale.uniti += report.uniti;
+                totale.segnalati += report.segnalati;
+                totale.duplicati += report.duplicati;
+            }
+            stampaReport(totale);
+            JsonSerializer::salvaBibliotecaThrows(biblioteca, parser.isSet("output") ? parser.value("output") : catalogo);
+            return Successo;
+        }
+        if (comando == "dedup" && argomenti.size() == 2)
+        {
+            // Reimporta il catalogo in una biblioteca vuota: i duplicati interni
+            // vengono rilevati rispetto ai record già accettati
+            stampaReport(JsonSerializer::importaBibliotecaThrows(biblioteca, catalogo, politica));
+            if (parser.isSet("output"))
+            {
+                JsonSerializer::salvaBibliotecaThrows(biblioteca, parser.value("output"));
+            }
+            return Successo;
+        }
+        if (comando == "shard" && argomenti.size() == 3)
+        {
+            JsonSerializer::caricaBibliotecaThrows(biblioteca, catalogo);
+            return suddividi(biblioteca, argomenti.at(2), opzioni);
+        }
+    }
+    catch (const BibliotecaException &e)
+    {
+        errori() << "Errore: " << e.what() << '\n';
+        return Errore;
+    }
+
+    errori() << "Comando o argomenti non validi: " << argomenti.join(' ') << '\n';
+    return UsoErrato;
+}
@@ -0,0 +1,234 @@
+#include "Metrics.h"
+#include <QMutexLocker>
+#include <QStringList>
+#include <QtAlgorithms>
+
+namespace Metrics
+{
+    namespace
+    {
+        constexpr int SubBucketBits = 4; // 16 bucket per potenza di due
+        constexpr int SubBucketCount = 1 << SubBucketBits;
+        constexpr int LinearLimit = 2 * SubBucketCount; // valori esatti sotto 32
+
+        void storeMin(std::atomic<qint64> &target, qint64 value)
+        {
+            qint64 current = target.load(std::memory_order_relaxed);
+            while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        void storeMax(std::atomic<qint64> &target, qint64 value)
+        {
+            qint64 current = target.load(std::memory_order_relaxed);
+            while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+
+    int Histogram::bucketIndex(qint64 value)
+    {
+        if (value < LinearLimit)
+        {
+            return value < 0 ? 0 : int(value);
+        }
+        const int msb = 63 - int(qCountLeadingZeroBits(quint64(value)));
+        const int shift = msb - SubBucketBits;
+        return SubBucketCount * shift + int(value >> shift);
+    }
+
+    qint64 Histogram::bucketUpperBound(int index)
+    {
+        if (index < LinearLimit)
+        {
+            return index;
+        }
+        const int shift = index / SubBucketCount - 1;
+        const qint64 mantissa = index % SubBucketCount + SubBucketCount;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    void Histogram::record(qint64 value)
+    {
+        value = qBound(qint64(0), value, MaxValue);
+        buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        samples.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        storeMin(minimum, value);
+        storeMax(maximum, value);
+    }
+
+    qint64 Histogram::min() const
+    {
+        return count() > 0 ? minimum.load(std::memory_order_relaxed) : 0;
+    }
+
+    double Histogram::mean() const
+    {
+        const qint64 n = count();
+        return n > 0 ? double(sum.load(std::memory_order_relaxed)) / double(n) : 0.0;
+    }
+
+    /**
+     * Scorre i bucket fino a coprire la quota richiesta dei campioni.
+     * I contatori sono letti senza fermare chi registra: con aggiornamenti
+     * concorrenti il risultato è una stima coerente entro un bucket.
+     */
+    qint64 Histogram::percentile(double percent) const
+    {
+        const qint64 n = count();
+        if (n == 0)
+        {
+            return 0;
+        }
+        const qint64 target = qMax(qint64(1), qint64(qBound(0.0, percent, 100.0) / 100.0 * double(n) + 0.5));
+        qint64 seen = 0;
+        for (int i = 0; i < BucketCount; ++i)
+        {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= target)
+            {
+                return qMin(bucketUpperBound(i), max());
+            }
+        }
+        return max();
+    }
+
+    void Histogram::reset()
+    {
+        for (std::atomic<qint64> &bucket : buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        samples.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        minimum.store(MaxValue, std::memory_order_relaxed);
+        maximum.store(0, std::memory_order_relaxed);
+    }
+
+    QJsonObject Histogram::toJson() const
+    {
+        QJsonObject json;
+        json["campioni"] = count();
+        json["min"] = min();
+        json["media"] = mean();
+        json["p50"] = percentile(50);
+        json["p90"] = percentile(90);
+        json["p99"] = percentile(99);
+        json["max"] = max();
+        return json;
+    }
+
+    Registry &Registry::instance()
+    {
+        // Mai distrutto: le metriche possono essere aggiornate anche durante la chiusura
+        static Registry *registry = new Registry;
+        return *registry;
+    }
+
+    Counter &Registry::counter(const QString &name)
+    {
+        QMutexLocker locker(&mutex);
+        std::unique_ptr<Counter> &entry = counters[name];
+        if (!entry)
+        {
+            entry.reset(new Counter);
+        }
+        return *entry;
+    }
+
+    Gauge &Registry::gauge(const QString &name)
+    {
+        QMutexLocker locker(&mutex);
+        std::unique_ptr<Gauge> &entry = gauges[name];
+        if (!entry)
+        {
+            entry.reset(new Gauge);
+        }
+        return *entry;
+    }
+
+    Histogram &Registry::histogram(const QString &name)
+    {
+        QMutexLocker locker(&mutex);
+        std::unique_ptr<Histogram> &entry = histograms[name];
+        if (!entry)
+        {
+            entry.reset(new Histogram);
+        }
+        return *entry;
+    }
+
+    QJsonObject Registry::snapshot() const
+    {
+        QMutexLocker locker(&mutex);
+        QJsonObject contatori;
+        for (const auto &entry : counters)
+        {
+            contatori[entry.first] = entry.second->value();
+        }
+        QJsonObject indicatori;
+        for (const auto &entry : gauges)
+        {
+            indicatori[entry.first] = entry.second->value();
+        }
+        QJsonObject istogrammi;
+        for (const auto &entry : histograms)
+        {
+            istogrammi[entry.first] = entry.second->toJson();
+        }
+
+        QJsonObject json;
+        json["contatori"] = contatori;
+        json["indicatori"] = indicatori;
+        json["istogrammi"] = istogrammi;
+        return json;
+    }
+
+    void Registry::reset()
+    {
+        QMutexLocker locker(&mutex);
+        for (const auto &entry : counters)
+        {
+            entry.second->reset();
+        }
+        for (const auto &entry : gauges)
+        {
+            entry.second->reset();
+        }
+        for (const auto &entry : histograms)
+        {
+            entry.second->reset();
+        }
+    }
+
+    QString formatSnapshot(const QJsonObject &snapshot)
+    {
+        QStringList righe;
+        const QJsonObject contatori = snapshot["contatori"].toObject();
+        for (auto it = contatori.begin(); it != contatori.end(); ++it)
+        {
+            righe.append(QString("%1 = %2").arg(it.key()).arg(qint64(it.value().toDouble())));
+        }
+        const QJsonObject indicatori = snapshot["indicatori"].toObject();
+        for (auto it = indicatori.begin(); it != indicatori.end(); ++it)
+        {
+            righe.append(QString("%1 = %2").arg(it.key()).arg(qint64(it.value().toDouble())));
+        }
+        const QJsonObject istogrammi = snapshot["istogrammi"].toObject();
+        for (auto it = istogrammi.begin(); it != istogrammi.end(); ++it)
+        {
+            const QJsonObject h = it.value().toObject();
+            righe.append(QString("%1: n=%2 p50=%3 p90=%4 p99=%5 max=%6")
+                             .arg(it.key())
+                             .arg(qint64(h["campioni"].toDouble()))
+                             .arg(qint64(h["p50"].toDouble()))
+                             .arg(qint64(h["p90"].toDouble()))
+                             .arg(qint64(h["p99"].toDouble()))
+                             .arg(qint64(h["max"].toDouble())));
+        }
+        return righe.join('\n');
+    }
+}
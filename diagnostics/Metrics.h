@@ -0,0 +1,140 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+
+/**
+ * Metrics - Contatori, indicatori e istogrammi di latenza sempre attivi
+ *
+ * A differenza del tracing (diagnostics/Tracing.h) le metriche sono compilate
+ * sempre: ogni aggiornamento è una singola operazione atomica relaxed.
+ * Le istanze sono create dal Registry alla prima richiesta e non vengono mai
+ * distrutte, quindi i riferimenti si possono conservare in variabili statiche:
+ *
+ *   static Metrics::Histogram &latenza = Metrics::histogram("query.latenza_us");
+ *   Metrics::ScopedLatency misura(latenza);
+ *
+ * Per convenzione i nomi degli istogrammi terminano con l'unità ("_us").
+ */
+namespace Metrics
+{
+    class Counter
+    {
+    public:
+        void add(qint64 delta = 1) { total.fetch_add(delta, std::memory_order_relaxed); }
+        qint64 value() const { return total.load(std::memory_order_relaxed); }
+        void reset() { total.store(0, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<qint64> total{0};
+    };
+
+    class Gauge
+    {
+    public:
+        void set(qint64 value) { current.store(value, std::memory_order_relaxed); }
+        void add(qint64 delta) { current.fetch_add(delta, std::memory_order_relaxed); }
+        qint64 value() const { return current.load(std::memory_order_relaxed); }
+        void reset() { set(0); }
+
+    private:
+        std::atomic<qint64> current{0};
+    };
+
+    /**
+     * Istogramma a bucket log-lineari, nello stile di HdrHistogram.
+     * I valori sotto 32 hanno un bucket ciascuno; ogni potenza di due successiva
+     * è divisa in 16 bucket, quindi l'errore relativo dei percentili è al più 1/16.
+     * I valori oltre MaxValue finiscono nell'ultimo bucket.
+     */
+    class Histogram
+    {
+    public:
+        static constexpr qint64 MaxValue = (qint64(1) << 36) - 1;
+        static constexpr int BucketCount = 528;
+
+        void record(qint64 value);
+
+        qint64 count() const { return samples.load(std::memory_order_relaxed); }
+        qint64 min() const;
+        qint64 max() const { return maximum.load(std::memory_order_relaxed); }
+        double mean() const;
+
+        // Limite superiore del bucket che contiene il percentile (0-100), limitato al massimo osservato
+        qint64 percentile(double percent) const;
+
+        void reset();
+        QJsonObject toJson() const;
+
+        static int bucketIndex(qint64 value);
+        static qint64 bucketUpperBound(int index);
+
+    private:
+        std::atomic<qint64> buckets[BucketCount] = {};
+        std::atomic<qint64> samples{0};
+        std::atomic<qint64> sum{0};
+        std::atomic<qint64> minimum{MaxValue};
+        std::atomic<qint64> maximum{0};
+    };
+
+    class Registry
+    {
+    public:
+        static Registry &instance();
+
+        Counter &counter(const QString &name);
+        Gauge &gauge(const QString &name);
+        Histogram &histogram(const QString &name);
+
+        // Valori correnti: {"contatori": {...}, "indicatori": {...}, "istogrammi": {...}}
+        QJsonObject snapshot() const;
+        // Azzera i valori senza invalidare i riferimenti già distribuiti
+        void reset();
+
+    private:
+        Registry() = default;
+
+        mutable QMutex mutex;
+        std::map<QString, std::unique_ptr<Counter>> counters;
+        std::map<QString, std::unique_ptr<Gauge>> gauges;
+        std::map<QString, std::unique_ptr<Histogram>> histograms;
+    };
+
+    inline Counter &counter(const QString &name) { return Registry::instance().counter(name); }
+    inline Gauge &gauge(const QString &name) { return Registry::instance().gauge(name); }
+    inline Histogram &histogram(const QString &name) { return Registry::instance().histogram(name); }
+
+    // Testo leggibile dello snapshot, una metrica per riga
+    QString formatSnapshot(const QJsonObject &snapshot);
+
+    // Registra nell'istogramma la durata del blocco in microsecondi
+    class ScopedLatency
+    {
+    public:
+        explicit ScopedLatency(Histogram &target)
+            : target(target), start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedLatency()
+        {
+            target.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count());
+        }
+
+        ScopedLatency(const ScopedLatency &) = delete;
+        ScopedLatency &operator=(const ScopedLatency &) = delete;
+
+    private:
+        Histogram &target;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#endif // METRICS_H
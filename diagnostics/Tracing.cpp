@@ -0,0 +1,185 @@
+#include "Tracing.h"
+#include <QCoreApplication>
+#include <QByteArray>
+#include <QFile>
+
+namespace Tracing
+{
+    std::atomic<bool> enabledFlag{false};
+
+    namespace
+    {
+        constexpr int ChunkCapacity = 4096;
+
+        // Blocco di eventi: scritto da un solo thread, letto da chi esporta
+        struct Chunk
+        {
+            Event events[ChunkCapacity];
+            std::atomic<int> count{0};
+            std::atomic<Chunk *> next{nullptr};
+        };
+
+        struct ThreadBuffer
+        {
+            int threadId = 0;
+            int totalEvents = 0; // usato solo dal thread proprietario
+            Chunk *tail = nullptr;
+            Chunk first;
+            ThreadBuffer *nextBuffer = nullptr; // immutabile dopo la pubblicazione
+        };
+
+        // Lista dei buffer: inserimento in testa con compare-and-swap, mai rimozioni.
+        // I buffer vivono fino alla fine del processo, così l'esportazione all'uscita
+        // vede anche gli eventi dei thread già terminati.
+        std::atomic<ThreadBuffer *> buffers{nullptr};
+        std::atomic<int> nextThreadId{1};
+        std::atomic<int> dropped{0};
+
+        QString exitTracePath;
+
+        ThreadBuffer *createBuffer()
+        {
+            ThreadBuffer *buffer = new ThreadBuffer;
+            buffer->threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+            buffer->tail = &buffer->first;
+            ThreadBuffer *head = buffers.load(std::memory_order_relaxed);
+            do
+            {
+                buffer->nextBuffer = head;
+            } while (!buffers.compare_exchange_weak(head, buffer, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+            return buffer;
+        }
+
+        ThreadBuffer *currentBuffer()
+        {
+            thread_local ThreadBuffer *buffer = createBuffer();
+            return buffer;
+        }
+
+        void appendEscaped(QByteArray &out, const char *text)
+        {
+            for (; *text; ++text)
+            {
+                if (*text == '"' || *text == '\\')
+                {
+                    out += '\\';
+                }
+                out += *text;
+            }
+        }
+
+#ifdef BIBLIO_TRACING
+        void writeAtExit()
+        {
+            if (!exitTracePath.isEmpty())
+            {
+                writeChromeTrace(exitTracePath);
+            }
+        }
+#endif
+    }
+
+    void setEnabled(bool enabled)
+    {
+        enabledFlag.store(enabled, std::memory_order_relaxed);
+    }
+
+    void record(const char *category, const char *name, qint64 startNs, qint64 durationNs)
+    {
+        ThreadBuffer *buffer = currentBuffer();
+        if (buffer->totalEvents >= MaxEventsPerThread)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Chunk *chunk = buffer->tail;
+        int count = chunk->count.load(std::memory_order_relaxed);
+        if (count == ChunkCapacity)
+        {
+            Chunk *fresh = new Chunk;
+            chunk->next.store(fresh, std::memory_order_release);
+            buffer->tail = fresh;
+            chunk = fresh;
+            count = 0;
+        }
+
+        chunk->events[count] = Event{category, name, startNs, durationNs};
+        // Pubblica l'evento: chi legge count con acquire vede anche i dati scritti
+        chunk->count.store(count + 1, std::memory_order_release);
+        ++buffer->totalEvents;
+    }
+
+    int droppedEvents()
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Esporta gli eventi nel formato "trace event" (eventi completi "X",
+     * timestamp e durate in microsecondi). Può essere chiamata mentre altri
+     * thread continuano a registrare: vengono scritti gli eventi già pubblicati.
+     */
+    bool writeChromeTrace(const QString &filePath)
+    {
+        QByteArray out;
+        out.reserve(1 << 16);
+        out += "{\"traceEvents\":[";
+
+        const qint64 pid = QCoreApplication::applicationPid();
+        bool first = true;
+        for (ThreadBuffer *buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->nextBuffer)
+        {
+            for (const Chunk *chunk = &buffer->first; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+            {
+                const int count = chunk->count.load(std::memory_order_acquire);
+                for (int i = 0; i < count; ++i)
+                {
+                    const Event &event = chunk->events[i];
+                    out += first ? "\n" : ",\n";
+                    first = false;
+                    out += "{\"ph\":\"X\",\"cat\":\"";
+                    appendEscaped(out, event.category);
+                    out += "\",\"name\":\"";
+                    appendEscaped(out, event.name);
+                    out += "\",\"pid\":";
+                    out += QByteArray::number(pid);
+                    out += ",\"tid\":";
+                    out += QByteArray::number(buffer->threadId);
+                    out += ",\"ts\":";
+                    out += QByteArray::number(double(event.startNs) / 1000.0, 'f', 3);
+                    out += ",\"dur\":";
+                    out += QByteArray::number(double(event.durationNs) / 1000.0, 'f', 3);
+                    out += '}';
+                }
+            }
+        }
+        out += "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":";
+        out += QByteArray::number(droppedEvents());
+        out += "}}\n";
+
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            return false;
+        }
+        return file.write(out) == out.size();
+    }
+
+    void initFromEnvironment()
+    {
+        const QString path = QString::fromLocal8Bit(qgetenv("BIBLIO_TRACE_FILE"));
+        if (path.isEmpty())
+        {
+            return;
+        }
+#ifndef BIBLIO_TRACING
+        qWarning("BIBLIO_TRACE_FILE ignorata: compilare con CONFIG+=tracing");
+#else
+        exitTracePath = path;
+        setEnabled(true);
+        qAddPostRoutine(writeAtExit);
+#endif
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+
+/**
+ * Tracing - Strumentazione a basso costo dei percorsi caldi
+ *
+ * BIBLIO_TRACE_SCOPE("categoria", "nome") misura la durata del blocco che lo
+ * contiene. Gli eventi sono accodati in un buffer per thread: ogni thread scrive
+ * solo nel proprio buffer (nessun lock, nessuna operazione atomica read-modify-write
+ * sul percorso caldo) e chi esporta legge i conteggi pubblicati con semantica acquire.
+ *
+ * La strumentazione è compilata solo con "qmake CONFIG+=tracing" (definisce
+ * BIBLIO_TRACING); altrimenti la macro si espande nel nulla. Anche se compilata
+ * resta inattiva finché non viene chiamato setEnabled(true) o non è impostata la
+ * variabile d'ambiente BIBLIO_TRACE_FILE (vedi initFromEnvironment()).
+ *
+ * Il formato di esportazione è il JSON "trace event" di Chrome, apribile con
+ * chrome://tracing o ui.perfetto.dev.
+ */
+namespace Tracing
+{
+    struct Event
+    {
+        const char *category; // letterali: nessuna copia
+        const char *name;
+        qint64 startNs;
+        qint64 durationNs;
+    };
+
+    // Massimo numero di eventi per thread: oltre, gli eventi vengono contati come persi
+    constexpr int MaxEventsPerThread = 1 << 20;
+
+    extern std::atomic<bool> enabledFlag;
+
+    inline bool isEnabled()
+    {
+        return enabledFlag.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool enabled);
+
+    // Nanosecondi da un'origine fissa del processo
+    inline qint64 now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void record(const char *category, const char *name, qint64 startNs, qint64 durationNs);
+
+    // Scrive tutti gli eventi registrati finora; false se il file non è scrivibile
+    bool writeChromeTrace(const QString &filePath);
+
+    // Attiva il tracing se BIBLIO_TRACE_FILE è impostata e scrive la traccia all'uscita
+    void initFromEnvironment();
+
+    int droppedEvents();
+
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(const char *category, const char *name)
+            : category(category), name(name), startNs(isEnabled() ? now() : -1) {}
+
+        ~ScopedTimer()
+        {
+            if (startNs >= 0)
+            {
+                record(category, name, startNs, now() - startNs);
+            }
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        const char *category;
+        const char *name;
+        qint64 startNs;
+    };
+}
+
+#define BIBLIO_TRACE_CONCAT_IMPL(a, b) a##b
+#define BIBLIO_TRACE_CONCAT(a, b) BIBLIO_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef BIBLIO_TRACING
+#define BIBLIO_TRACE_SCOPE(category, name) \
+    const Tracing::ScopedTimer BIBLIO_TRACE_CONCAT(bibliotecaTrace_, __LINE__)(category, name)
+#else
+#define BIBLIO_TRACE_SCOPE(category, name) \
+    do                                     \
+    {                                      \
+    } while (false)
+#endif
+
+#endif // TRACING_H
@@ -1,9 +1,20 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
 #include "view/MainWindow.h"
 #include "view/LoginDialog.h"
+#include "diagnostics/Tracing.h"
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
+    Tracing::initFromEnvironment();
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption dumpMetrics("dump-metrics", "Scrive le metriche della sessione in JSON su standard output all'uscita.");
+    parser.addOption(dumpMetrics);
+    parser.process(app);
     
     // Show login dialog first
     LoginDialog loginDialog;
@@ -15,6 +26,12 @@ int main(int argc, char *argv[]) {
     MainWindow window;
     window.show();
     
-    return app.exec();
-}
+    const int result = app.exec();
 
+    if (parser.isSet(dumpMetrics)) {
+        QFile output;
+        output.open(stdout, QIODevice::WriteOnly);
+        output.write(QJsonDocument(window.metricsSnapshot()).toJson());
+    }
+    return result;
+}
@@ -2,7 +2,60 @@
 #include "Book.h"
 #include "Film.h"
 #include "MagazineArticle.h"
-#include "../view/MediaCollectorVisitor.h"
+#include "MediaVisitorT.h"
+#include "MemoryFootprintVisitor.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QtConcurrent>
+
+namespace
+{
+    /**
+     * Visitor che smista gli slot nelle partizioni per tipo.
+     * Ogni tipo di Media inserisce lo slot corrente nella propria bitmap,
+     * senza controlli di tipo espliciti. Lo smistamento è statico: nel ciclo di
+     * costruzione degli indici non ci sono chiamate virtuali per elemento.
+     */
+    class TypePartitionVisitor : public StaticMediaVisitor<TypePartitionVisitor>
+    {
+    public:
+        TypePartitionVisitor(RoaringBitmap &libri, RoaringBitmap &film, RoaringBitmap &articoli)
+            : libri(libri), film(film), articoli(articoli), slot(0) {}
+
+        void setSlot(quint32 newSlot) { slot = newSlot; }
+
+        void visit(const Book &) { libri.add(slot); }
+        void visit(const Film &) { film.add(slot); }
+        void visit(const MagazineArticle &) { articoli.add(slot); }
+
+    private:
+        RoaringBitmap &libri;
+        RoaringBitmap &film;
+        RoaringBitmap &articoli;
+        quint32 slot;
+    };
+
+    // Indici di un intervallo di slot, costruiti da un singolo thread
+    struct IndiciParziali
+    {
+        quint32 inizio = 0;
+        quint32 fine = 0;
+        RoaringBitmap libri;
+        RoaringBitmap film;
+        RoaringBitmap articoli;
+        QHash<int, RoaringBitmap> anni;
+    };
+
+    // Sotto questa soglia la costruzione sequenziale è più conveniente
+    const int SogliaIndiciParalleli = 2 * 65536;
+
+    // Latenza di tutte le ricerche e dei filtri, in microsecondi
+    Metrics::Histogram &latenzaQuery()
+    {
+        static Metrics::Histogram &istogramma = Metrics::histogram("query.latenza_us");
+        return istogramma;
+    }
+}
 
 /**
  * Costruttore di default della Biblioteca.
@@ -23,14 +76,12 @@ Biblioteca::~Biblioteca()
 /**
  * Costruttore di copia della Biblioteca.
  * Crea una nuova biblioteca copiando tutti i Media da un'altra biblioteca.
- * Utilizza il Container template che gestisce automaticamente il deep copy
- * tramite il metodo clone() di ogni Media, garantendo indipendenza tra oggetti.
+ * Il deep copy avviene tramite il Container (clone() di ogni Media).
  * @param other La biblioteca sorgente da copiare
  */
-// Costruttore di copia - ora gestito dal Container
-Biblioteca::Biblioteca(const Biblioteca &other) : mediaContainer(other.mediaContainer)
+Biblioteca::Biblioteca(const Biblioteca &other)
 {
-    // Il Container gestisce automaticamente il deep copy
+    copiaDa(other);
 }
 
 /**
@@ -46,11 +97,45 @@ Biblioteca &Biblioteca::operator=(const Biblioteca &other)
 {
     if (this != &other)
     {
-        mediaContainer = other.mediaContainer;
+        svuota();
+        copiaDa(other);
     }
     return *this;
 }
 
+/**
+ * Costruttore per spostamento: prende i Media di other senza clonarli.
+ * other resta una biblioteca vuota e valida.
+ */
+Biblioteca::Biblioteca(Biblioteca &&other) noexcept
+{
+    swap(other);
+}
+
+/**
+ * Assegnazione per spostamento: scambia il contenuto con other, che
+ * distruggerà i Media precedenti di questa biblioteca.
+ */
+Biblioteca &Biblioteca::operator=(Biblioteca &&other) noexcept
+{
+    swap(other);
+    return *this;
+}
+
+/**
+ * Scambia il contenuto con un'altra biblioteca in tempo costante.
+ * Gli indici seguono i rispettivi Media, quindi restano validi dopo lo scambio.
+ */
+void Biblioteca::swap(Biblioteca &other) noexcept
+{
+    mediaContainer.swap(other.mediaContainer);
+    std::swap(indiciValidi, other.indiciValidi);
+    std::swap(indiceLibri, other.indiceLibri);
+    std::swap(indiceFilm, other.indiceFilm);
+    std::swap(indiceArticoli, other.indiceArticoli);
+    indiceAnni.swap(other.indiceAnni);
+}
+
 /**
  * Aggiunge un nuovo Media alla biblioteca.
  * Delega al Container template l'inserimento del Media nel contenitore.
@@ -69,6 +154,64 @@ void Biblioteca::aggiungiMedia(Media *media)
     {
         throw; // rilancia l'eccezione per la gestione a livello superiore
     }
+
+    // Il nuovo Media occupa l'ultimo slot: gli indici già costruiti restano validi
+    if (indiciValidi)
+    {
+        indicizza(media, quint32(mediaContainer.size() - 1));
+    }
+}
+
+/**
+ * Aggiunge un insieme di Media in un'unica operazione.
+ * Rispetto a chiamate ripetute di aggiungiMedia() la capacità viene riservata una volta,
+ * i duplicati sono verificati con un insieme hash e gli indici secondari vengono
+ * ricostruiti una sola volta, in parallelo, al termine dell'inserimento.
+ * @param media Media da aggiungere (proprietà trasferita per quelli accettati)
+ * @return Numero di Media effettivamente aggiunti (nulli e già presenti sono saltati)
+ */
+int Biblioteca::aggiungiMediaBulk(const QList<Media *> &media)
+{
+    const bool ricostruisci = indiciValidi;
+    invalidaIndici();
+
+    const int aggiunti = mediaContainer.addAll(media);
+    if (ricostruisci)
+    {
+        costruisciIndici();
+    }
+    return aggiunti;
+}
+
+/**
+ * Aggiunge un insieme di Media con semantica tutto-o-niente.
+ * La validazione avviene prima di qualsiasi modifica; se anche la ricostruzione
+ * degli indici fallisce, gli elementi appena inseriti vengono rilasciati.
+ * @param media Media da aggiungere (proprietà trasferita solo in caso di successo)
+ * @throws InvalidDataException se un puntatore è nullo
+ * @throws DuplicateMediaException se un Media è già presente o ripetuto
+ */
+void Biblioteca::aggiungiMediaBulkTransazionale(const QList<Media *> &media)
+{
+    const bool ricostruisci = indiciValidi;
+    const int dimensionePrecedente = mediaContainer.size();
+
+    mediaContainer.addAllOrNothing(media);
+    invalidaIndici();
+
+    if (ricostruisci)
+    {
+        try
+        {
+            costruisciIndici();
+        }
+        catch (...)
+        {
+            mediaContainer.releaseLast(mediaContainer.size() - dimensionePrecedente);
+            invalidaIndici();
+            throw;
+        }
+    }
 }
 
 /**
@@ -80,15 +223,18 @@ void Biblioteca::aggiungiMedia(Media *media)
  */
 bool Biblioteca::rimuoviMedia(Media *media)
 {
-    try
-    {
-        mediaContainer.remove(media);
-        return true;
-    }
-    catch (const MediaNotFoundException &)
+    const Result<void> esito = mediaContainer.tryRemove(media);
+    if (!esito)
     {
+        // Solo l'assenza del Media è un caso ordinario; un puntatore nullo resta un errore
+        if (esito.error().code() != ErrorCode::NotFound)
+        {
+            esito.error().raise();
+        }
         return false;
     }
+    invalidaIndici(); // gli slot successivi sono stati traslati
+    return true;
 }
 
 /**
@@ -101,6 +247,7 @@ bool Biblioteca::rimuoviMedia(Media *media)
 void Biblioteca::rimuoviMediaAt(int index)
 {
     mediaContainer.removeAt(index);
+    invalidaIndici();
 }
 
 /**
@@ -115,6 +262,24 @@ Media *Biblioteca::getMediaAt(int index) const
     return mediaContainer.at(index);
 }
 
+/**
+ * Sostituisce il Media in una posizione mantenendo invariati gli altri slot.
+ * La biblioteca diventa proprietaria del nuovo Media e distrugge il precedente.
+ * @param index Indice posizionale (0-based)
+ * @param media Nuovo Media, non nullo e non già presente
+ * @throws BibliotecaException se l'indice non è valido o il Media è nullo/duplicato
+ */
+void Biblioteca::sostituisciMediaAt(int index, Media *media)
+{
+    mediaContainer.replaceAt(index, media);
+    invalidaIndici();
+}
+
+int Biblioteca::indiceDi(const Media *media) const
+{
+    return mediaContainer.indexOf(media);
+}
+
 /**
  * Ricerca Media per titolo nella biblioteca.
  * Effettua una ricerca case-insensitive che trova tutti i Media
@@ -124,8 +289,9 @@ Media *Biblioteca::getMediaAt(int index) const
  */
 QList<Media *> Biblioteca::cercaPerTitolo(const QString &titolo) const
 {
-    return mediaContainer.find([&titolo](Media *media)
-                               { return media->getTitle().contains(titolo, Qt::CaseInsensitive); });
+    BIBLIO_TRACE_SCOPE("query", "Biblioteca::cercaPerTitolo");
+    Metrics::ScopedLatency latenza(latenzaQuery());
+    return materializza(bitmapPerTitolo(titolo, bitmapTutti()));
 }
 
 /**
@@ -136,8 +302,9 @@ QList<Media *> Biblioteca::cercaPerTitolo(const QString &titolo) const
  */
 QList<Media *> Biblioteca::cercaPerAnno(int anno) const
 {
-    return mediaContainer.find([anno](Media *media)
-                               { return media->getYear() == anno; });
+    BIBLIO_TRACE_SCOPE("query", "Biblioteca::cercaPerAnno");
+    Metrics::ScopedLatency latenza(latenzaQuery());
+    return materializza(bitmapPerAnno(anno));
 }
 
 /**
@@ -152,28 +319,233 @@ QList<Media *> Biblioteca::getTuttiMedia() const
 
 /**
  * Raccoglie Media per tipo utilizzando il Pattern Visitor.
- * Questo metodo implementa polimorfismo non banale attraverso il Visitor pattern:
+ * Le partizioni per tipo sono costruite da TypePartitionVisitor:
  * - Ogni tipo di Media (Book, Film, MagazineArticle) ha comportamento visitor diverso
  * - Il filtering avviene tramite polimorfismo invece che controllo di tipo esplicito
- * - Dimostra uso sofisticato del polimorfismo per operazioni su collezioni
+ * - Il risultato è una bitmap di slot, materializzata solo alla fine
  * @param filterType Tipo di Media da raccogliere
  * @return Lista di Media che corrispondono al filtro specificato
  */
 QList<Media *> Biblioteca::collectMediaByType(MediaFilter::FilterType filterType) const
 {
-    MediaCollectorVisitor collector(filterType);
+    BIBLIO_TRACE_SCOPE("query", "Biblioteca::collectMediaByType");
+    Metrics::ScopedLatency latenza(latenzaQuery());
+    return materializza(bitmapPerTipo(filterType));
+}
 
-    // Applica il visitor a ogni Media - comportamento polimorfo per ogni tipo
-    QList<Media *> allMedia = getTuttiMedia();
-    for (Media *media : allMedia)
+/**
+ * Insieme di tutti gli slot occupati.
+ * Gli slot coincidono con le posizioni dei Media nel container, quindi sono densi.
+ * @return Bitmap con gli slot da 0 a dimensione() - 1
+ */
+RoaringBitmap Biblioteca::bitmapTutti() const
+{
+    return RoaringBitmap::range(0, quint32(mediaContainer.size()));
+}
+
+/**
+ * Partizione degli slot per tipo di Media.
+ * @param filterType Tipo richiesto (ALL restituisce tutti gli slot)
+ * @return Bitmap degli slot del tipo richiesto
+ */
+RoaringBitmap Biblioteca::bitmapPerTipo(MediaFilter::FilterType filterType) const
+{
+    assicuraIndici();
+    switch (filterType)
     {
-        if (media)
-        {
-            media->accept(collector); // Polimorfismo: ogni Media chiama visit() appropriato
-        }
+    case MediaFilter::FilterType::BOOKS_ONLY:
+        return indiceLibri;
+    case MediaFilter::FilterType::FILMS_ONLY:
+        return indiceFilm;
+    case MediaFilter::FilterType::ARTICLES_ONLY:
+        return indiceArticoli;
+    case MediaFilter::FilterType::ALL:
+        break;
+    }
+    return bitmapTutti();
+}
+
+/**
+ * Bucket degli slot per anno di pubblicazione.
+ * @param anno Anno richiesto
+ * @return Bitmap degli slot pubblicati nell'anno (vuota se nessuno)
+ */
+RoaringBitmap Biblioteca::bitmapPerAnno(int anno) const
+{
+    assicuraIndici();
+    return indiceAnni.value(anno);
+}
+
+/**
+ * Ricerca per titolo ristretta a un insieme di candidati.
+ * La sottostringa non è indicizzabile, quindi vengono esaminati solo gli slot
+ * già sopravvissuti agli altri filtri.
+ * @param titolo Stringa da cercare nei titoli (case-insensitive)
+ * @param candidati Slot su cui effettuare la ricerca
+ * @return Bitmap degli slot il cui titolo contiene la stringa
+ */
+RoaringBitmap Biblioteca::bitmapPerTitolo(const QString &titolo, const RoaringBitmap &candidati) const
+{
+    BIBLIO_TRACE_SCOPE("query", "Biblioteca::bitmapPerTitolo");
+    if (titolo.isEmpty())
+    {
+        return candidati;
+    }
+
+    RoaringBitmap risultato;
+    candidati.forEach([this, &titolo, &risultato](quint32 slot)
+                      {
+                          if (mediaContainer.at(int(slot))->getTitleRef().contains(titolo, Qt::CaseInsensitive))
+                          {
+                              risultato.add(slot);
+                          }
+                          return true;
+                      });
+    return risultato;
+}
+
+/**
+ * Esegue una query composita combinando le bitmap dei singoli criteri.
+ * I filtri indicizzati (tipo, anno) sono intersecati parola per parola;
+ * la ricerca sul titolo viene applicata per ultima sui soli candidati rimasti.
+ * @param query Criteri da applicare
+ * @return Bitmap degli slot che soddisfano tutti i criteri
+ */
+RoaringBitmap Biblioteca::eseguiQuery(const MediaFilter::Query &query) const
+{
+    BIBLIO_TRACE_SCOPE("query", "Biblioteca::eseguiQuery");
+    Metrics::ScopedLatency latenza(latenzaQuery());
+    return bitmapPerTitolo(query.titolo, candidatiIndicizzati(query));
+}
+
+/**
+ * Ricerca per titolo paginata.
+ * @param titolo Stringa da cercare nei titoli (case-insensitive)
+ * @param offset Numero di risultati da saltare
+ * @param limit Dimensione massima della pagina
+ * @return Pagina di risultati con stima del totale
+ */
+MediaFilter::Page Biblioteca::cercaPerTitoloPaginato(const QString &titolo, int offset, int limit) const
+{
+    return paginaDaCandidati(bitmapTutti(), titolo, 0, offset, limit);
+}
+
+/**
+ * Ricerca per anno paginata. Il totale è sempre esatto (cardinalità del bucket).
+ */
+MediaFilter::Page Biblioteca::cercaPerAnnoPaginato(int anno, int offset, int limit) const
+{
+    return paginaDaCandidati(bitmapPerAnno(anno), QString(), 0, offset, limit);
+}
+
+/**
+ * Raccolta per tipo paginata. Il totale è sempre esatto (cardinalità della partizione).
+ */
+MediaFilter::Page Biblioteca::collectMediaByTypePaginato(MediaFilter::FilterType filterType, int offset, int limit) const
+{
+    return paginaDaCandidati(bitmapPerTipo(filterType), QString(), 0, offset, limit);
+}
+
+/**
+ * Query composita paginata per offset.
+ * I filtri indicizzati sono intersecati per intero (costo proporzionale alle bitmap),
+ * mentre la ricerca sul titolo si ferma appena la pagina è piena.
+ * @param query Criteri da applicare
+ * @param offset Numero di risultati da saltare
+ * @param limit Dimensione massima della pagina
+ * @return Pagina di risultati con cursore per proseguire
+ */
+MediaFilter::Page Biblioteca::eseguiQueryPaginata(const MediaFilter::Query &query, int offset, int limit) const
+{
+    BIBLIO_TRACE_SCOPE("query", "Biblioteca::eseguiQueryPaginata");
+    Metrics::ScopedLatency latenza(latenzaQuery());
+    return paginaDaCandidati(candidatiIndicizzati(query), query.titolo, 0, offset, limit);
+}
+
+/**
+ * Query composita ripresa da un cursore restituito da una pagina precedente.
+ * Evita di riesaminare gli slot già visitati, quindi scorrere le pagine in avanti
+ * costa quanto la singola pagina anche con la ricerca sul titolo.
+ * @param query Criteri da applicare (devono coincidere con quelli della pagina precedente)
+ * @param cursore Valore di Page::cursore della pagina precedente (0 per la prima)
+ * @param limit Dimensione massima della pagina
+ * @return Pagina successiva di risultati
+ */
+MediaFilter::Page Biblioteca::eseguiQueryDaCursore(const MediaFilter::Query &query, quint32 cursore, int limit) const
+{
+    BIBLIO_TRACE_SCOPE("query", "Biblioteca::eseguiQueryDaCursore");
+    Metrics::ScopedLatency latenza(latenzaQuery());
+    return paginaDaCandidati(candidatiIndicizzati(query), query.titolo, cursore, 0, limit);
+}
+
+/**
+ * Converte una bitmap di slot nei corrispondenti puntatori a Media.
+ * Solo la finestra [offset, offset + limit) viene materializzata.
+ * @param selezione Slot da convertire
+ * @param offset Numero di slot da saltare
+ * @param limit Numero massimo di Media restituiti (-1 = nessun limite)
+ * @return Lista dei Media nella finestra richiesta, in ordine di slot
+ */
+QList<Media *> Biblioteca::materializza(const RoaringBitmap &selezione, int offset, int limit) const
+{
+    QList<Media *> risultato;
+    if (limit == 0)
+    {
+        return risultato;
     }
+    risultato.reserve(limit > 0 ? limit : selezione.cardinality());
 
-    return collector.getCollectedMedia();
+    int daSaltare = offset;
+    selezione.forEach([this, &risultato, &daSaltare, limit](quint32 slot)
+                      {
+                          if (daSaltare > 0)
+                          {
+                              --daSaltare;
+                              return true;
+                          }
+                          risultato.append(mediaContainer.at(int(slot)));
+                          return limit < 0 || risultato.size() < limit;
+                      });
+    return risultato;
+}
+
+/**
+ * Segnala che titolo o anno di un Media già presente sono stati modificati.
+ * Gli indici vengono ricostruiti alla prossima query.
+ * @param media Media modificato
+ */
+void Biblioteca::notificaModifica(Media *media)
+{
+    Q_UNUSED(media);
+    invalidaIndici();
+}
+
+/**
+ * Serializza tutti i Media in un array JSON.
+ * @return Array JSON con un oggetto per Media, nell'ordine degli slot
+ */
+QJsonArray Biblioteca::serializzaMedia() const
+{
+    QJsonArray array;
+    for (const Media *media : mediaContainer.getAll())
+    {
+        array.append(media->serializza());
+    }
+    return array;
+}
+
+/**
+ * Istantanea per valore dei Media, nell'ordine degli slot.
+ * È costruita dai Media a ogni richiesta, quindi riflette anche le modifiche
+ * fatte tramite i puntatori restituiti da getMediaAt(). Ogni Media viene
+ * copiato una volta nel variant; le QString non vengono duplicate, solo
+ * condivise: il salvataggio in background può leggerle mentre la GUI
+ * continua a modificare la biblioteca.
+ * @return Archivio indipendente dalla biblioteca
+ */
+MediaStore Biblioteca::istantanea() const
+{
+    return MediaStore::fromMedia(mediaContainer.getAll());
 }
 
 /**
@@ -184,6 +556,7 @@ QList<Media *> Biblioteca::collectMediaByType(MediaFilter::FilterType filterType
 void Biblioteca::svuota()
 {
     mediaContainer.clear();
+    invalidaIndici();
 }
 
 /**
@@ -205,3 +578,262 @@ bool Biblioteca::isEmpty() const
 {
     return mediaContainer.isEmpty();
 }
+
+/**
+ * Pubblica nel registro delle metriche la composizione della biblioteca:
+ * numero di Media per tipo e byte stimati occupati dalle stringhe.
+ * Costa una visita di tutti i Media, quindi va chiamato su richiesta
+ * (pannello diagnostico, --dump-metrics) e non a ogni modifica.
+ */
+void Biblioteca::aggiornaMetriche() const
+{
+    Metrics::gauge("biblioteca.media").set(dimensione());
+    Metrics::gauge("biblioteca.libri").set(bitmapPerTipo(MediaFilter::FilterType::BOOKS_ONLY).cardinality());
+    Metrics::gauge("biblioteca.film").set(bitmapPerTipo(MediaFilter::FilterType::FILMS_ONLY).cardinality());
+    Metrics::gauge("biblioteca.articoli").set(bitmapPerTipo(MediaFilter::FilterType::ARTICLES_ONLY).cardinality());
+
+    const MemoryReport memoria = memoryFootprint();
+    Metrics::gauge("biblioteca.byte_stringhe").set(memoria.stringBytesTotal());
+    Metrics::gauge("biblioteca.byte_totali").set(memoria.total());
+}
+
+/**
+ * Stima della memoria occupata dalla biblioteca, divisa per voce:
+ * - "Biblioteca": oggetto e vettore dei puntatori del container
+ * - un blocco per tipo di Media con l'oggetto e ogni campo testuale
+ * - "Indici": partizioni per tipo e bucket per anno, se già costruiti
+ * I buffer delle stringhe condivisi tra Media diversi sono contati una volta sola.
+ * @return Report con totali e dettaglio per campo
+ */
+MemoryReport Biblioteca::memoryFootprint() const
+{
+    MemoryReport report;
+    const QString voceBiblioteca = QStringLiteral("Biblioteca");
+    report.add(voceBiblioteca, "oggetto", sizeof(Biblioteca));
+    // QList non espone la capacità: stima per difetto (intestazione e un puntatore per Media)
+    report.add(voceBiblioteca, "contenitore",
+               MemoryReport::allocationBytes(16 + qint64(dimensione()) * qint64(sizeof(void *))), dimensione());
+
+    {
+        MemoryFootprintVisitor visitor(report);
+        for (int i = 0; i < mediaContainer.size(); ++i)
+        {
+            visitor.apply(*mediaContainer.at(i));
+        }
+    }
+
+    if (indiciValidi)
+    {
+        const QString voceIndici = QStringLiteral("Indici");
+        report.add(voceIndici, "libri", indiceLibri.memoryFootprint());
+        report.add(voceIndici, "film", indiceFilm.memoryFootprint());
+        report.add(voceIndici, "articoli", indiceArticoli.memoryFootprint());
+
+        // QHash: vettore dei bucket e un nodo (next, hash, chiave, valore) per anno
+        const qint64 nodo = MemoryReport::allocationBytes(sizeof(void *) + sizeof(uint) + sizeof(int) + sizeof(RoaringBitmap));
+        qint64 anni = MemoryReport::allocationBytes(qint64(indiceAnni.capacity()) * qint64(sizeof(void *)));
+        for (const RoaringBitmap &bucket : indiceAnni)
+        {
+            anni += nodo + bucket.memoryFootprint();
+        }
+        report.add(voceIndici, "anni", anni, indiceAnni.size());
+    }
+    return report;
+}
+
+/**
+ * Costruisce gli indici secondari se non sono aggiornati.
+ * Viene chiamato in modo pigro dalle query, così le mutazioni in serie
+ * non pagano la ricostruzione a ogni passo.
+ */
+void Biblioteca::assicuraIndici() const
+{
+    if (!indiciValidi)
+    {
+        costruisciIndici();
+    }
+}
+
+/**
+ * Ricostruisce da zero partizioni per tipo e bucket per anno.
+ * Sulle biblioteche grandi gli slot sono divisi in intervalli allineati ai blocchi
+ * da 65536 della RoaringBitmap: ogni intervallo è indicizzato da un thread diverso
+ * e le bitmap parziali, disgiunte, vengono poi unite in ordine.
+ */
+void Biblioteca::costruisciIndici() const
+{
+    BIBLIO_TRACE_SCOPE("indici", "Biblioteca::costruisciIndici");
+    indiceLibri.clear();
+    indiceFilm.clear();
+    indiceArticoli.clear();
+    indiceAnni.clear();
+
+    const QList<Media *> tutti = mediaContainer.getAll();
+    auto indicizzaIntervallo = [&tutti](IndiciParziali &parziali)
+    {
+        TypePartitionVisitor partitioner(parziali.libri, parziali.film, parziali.articoli);
+        for (quint32 slot = parziali.inizio; slot < parziali.fine; ++slot)
+        {
+            Media *media = tutti.at(int(slot));
+            partitioner.setSlot(slot);
+            partitioner.apply(*media);
+            parziali.anni[media->getYear()].add(slot);
+        }
+    };
+
+    QList<IndiciParziali> intervalli;
+    const quint32 totale = quint32(tutti.size());
+    const quint32 passo = totale < quint32(SogliaIndiciParalleli) ? qMax(totale, 1u) : 65536u;
+    for (quint32 inizio = 0; inizio < totale; inizio += passo)
+    {
+        IndiciParziali intervallo;
+        intervallo.inizio = inizio;
+        intervallo.fine = qMin(totale, inizio + passo);
+        intervalli.append(intervallo);
+    }
+
+    if (intervalli.size() > 1)
+    {
+        QtConcurrent::blockingMap(intervalli, indicizzaIntervallo);
+    }
+    else if (!intervalli.isEmpty())
+    {
+        indicizzaIntervallo(intervalli.first());
+    }
+
+    for (const IndiciParziali &parziali : qAsConst(intervalli))
+    {
+        indiceLibri |= parziali.libri;
+        indiceFilm |= parziali.film;
+        indiceArticoli |= parziali.articoli;
+        for (auto it = parziali.anni.constBegin(); it != parziali.anni.constEnd(); ++it)
+        {
+            indiceAnni[it.key()] |= it.value();
+        }
+    }
+    indiciValidi = true;
+}
+
+/**
+ * Inserisce un singolo slot nelle partizioni per tipo e nei bucket per anno.
+ * @param media Media che occupa lo slot
+ * @param slot Posizione del Media nel container
+ */
+void Biblioteca::indicizza(Media *media, quint32 slot) const
+{
+    TypePartitionVisitor partitioner(indiceLibri, indiceFilm, indiceArticoli);
+    partitioner.setSlot(slot);
+    partitioner.apply(*media);
+    indiceAnni[media->getYear()].add(slot);
+}
+
+void Biblioteca::invalidaIndici()
+{
+    indiciValidi = false;
+}
+
+/**
+ * Copia profonda dei Media di un'altra biblioteca in questa (vuota).
+ */
+void Biblioteca::copiaDa(const Biblioteca &other)
+{
+    mediaContainer = other.mediaContainer;
+    invalidaIndici();
+}
+
+/**
+ * Combina i soli criteri indicizzati (tipo e anno) di una query.
+ * @param query Criteri da applicare
+ * @return Bitmap degli slot candidati, prima della ricerca sul titolo
+ */
+RoaringBitmap Biblioteca::candidatiIndicizzati(const MediaFilter::Query &query) const
+{
+    RoaringBitmap candidati = bitmapPerTipo(query.tipo);
+    if (query.filtraAnno)
+    {
+        candidati &= bitmapPerAnno(query.anno);
+    }
+    return candidati;
+}
+
+/**
+ * Costruisce una pagina scorrendo i candidati a partire dal cursore.
+ * Senza ricerca sul titolo il totale è la cardinalità dei candidati; con la ricerca
+ * la scansione si ferma al primo risultato dopo la pagina piena (che rende vero
+ * altriRisultati) e il totale viene stimato in proporzione ai candidati esaminati.
+ * @param candidati Slot che soddisfano i criteri indicizzati
+ * @param titolo Filtro sul titolo (vuoto = nessuno)
+ * @param cursore Primo slot da esaminare
+ * @param offset Numero di risultati da saltare dopo il cursore
+ * @param limit Dimensione massima della pagina (<= 0 = nessun limite)
+ * @return Pagina di risultati
+ */
+MediaFilter::Page Biblioteca::paginaDaCandidati(const RoaringBitmap &candidati, const QString &titolo,
+                                                quint32 cursore, int offset, int limit) const
+{
+    MediaFilter::Page pagina;
+    pagina.cursore = cursore;
+    if (limit > 0)
+    {
+        pagina.items.reserve(limit);
+    }
+
+    int daSaltare = offset;
+    int esaminati = 0;
+    int corrispondenze = 0;
+    bool paginaPiena = false;
+    candidati.forEachFrom(cursore, [&](quint32 slot)
+                          {
+                              ++esaminati;
+                              Media *media = mediaContainer.at(int(slot));
+                              const bool corrisponde = titolo.isEmpty() || media->getTitleRef().contains(titolo, Qt::CaseInsensitive);
+                              if (paginaPiena)
+                              {
+                                  // Oltre la pagina si cerca solo il prossimo risultato, senza
+                                  // spostare il cursore: la pagina seguente riparte da qui
+                                  if (corrisponde)
+                                  {
+                                      ++corrispondenze;
+                                      pagina.altriRisultati = true;
+                                      return false;
+                                  }
+                                  return true;
+                              }
+                              pagina.cursore = slot + 1;
+                              if (!corrisponde)
+                              {
+                                  return true;
+                              }
+                              ++corrispondenze;
+                              if (daSaltare > 0)
+                              {
+                                  --daSaltare;
+                                  return true;
+                              }
+                              pagina.items.append(media);
+                              paginaPiena = limit > 0 && pagina.items.size() >= limit;
+                              return true;
+                          });
+
+    if (titolo.isEmpty())
+    {
+        pagina.totaleStimato = candidati.cardinality();
+        pagina.totaleEsatto = true;
+    }
+    else if (!pagina.altriRisultati && cursore == 0)
+    {
+        // Scansione completa: il conteggio è esatto
+        pagina.totaleStimato = corrispondenze;
+        pagina.totaleEsatto = true;
+    }
+    else
+    {
+        // Estrapola la frequenza osservata sui candidati esaminati
+        const int candidatiTotali = candidati.cardinality();
+        pagina.totaleStimato = esaminati > 0
+                                   ? int(qint64(corrispondenze) * candidatiTotali / esaminati)
+                                   : 0;
+        pagina.totaleEsatto = false;
+    }
+    return pagina;
+}
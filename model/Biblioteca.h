@@ -3,7 +3,11 @@
 
 #include <QList>
 #include <QString>
+#include <QHash>
 #include "Media.h"
+#include "RoaringBitmap.h"
+#include "MediaStore.h"
+#include "MemoryReport.h"
 #include "Container.h"
 #include "Exceptions.h"
 
@@ -20,6 +24,25 @@ namespace MediaFilter
         FILMS_ONLY,
         ARTICLES_ONLY
     };
+
+    // Query composita: i criteri presenti vengono combinati in AND
+    struct Query
+    {
+        FilterType tipo = FilterType::ALL;
+        QString titolo;     // vuoto = nessun filtro sul titolo
+        int anno = 0;       // usato solo se filtraAnno è true
+        bool filtraAnno = false;
+    };
+
+    // Pagina di risultati di una query, con cursore per riprendere la scansione
+    struct Page
+    {
+        QList<Media *> items;
+        int totaleStimato = 0;       // numero totale di risultati (stimato se non esatto)
+        bool totaleEsatto = true;    // false se la ricerca sul titolo è stata interrotta
+        quint32 cursore = 0;         // primo slot da esaminare per la pagina successiva
+        bool altriRisultati = false; // true se esiste almeno un altro risultato dopo il cursore
+    };
 }
 
 class Biblioteca
@@ -32,10 +55,27 @@ public:
     Biblioteca(const Biblioteca &other);
     Biblioteca &operator=(const Biblioteca &other);
 
+    // Spostamento e scambio: trasferiscono Media e indici senza copie
+    Biblioteca(Biblioteca &&other) noexcept;
+    Biblioteca &operator=(Biblioteca &&other) noexcept;
+    void swap(Biblioteca &other) noexcept;
+
     void aggiungiMedia(Media *media);
+
+    // Inserimento in blocco: capacità riservata in anticipo, validazione in una
+    // sola passata e indici ricostruiti una volta sola alla fine.
+    // Gli elementi nulli o già presenti vengono saltati; restituisce quanti sono stati aggiunti.
+    int aggiungiMediaBulk(const QList<Media *> &media);
+    // Variante transazionale: in caso di errore la biblioteca resta invariata
+    // e la proprietà dei Media resta al chiamante
+    void aggiungiMediaBulkTransazionale(const QList<Media *> &media);
     bool rimuoviMedia(Media *media);
     void rimuoviMediaAt(int index);
     Media *getMediaAt(int index) const;
+    // Sostituisce il Media alla posizione indicata, distruggendo il precedente
+    void sostituisciMediaAt(int index, Media *media);
+    // Posizione del Media nella biblioteca, -1 se non presente
+    int indiceDi(const Media *media) const;
     QList<Media *> cercaPerTitolo(const QString &titolo) const;
     QList<Media *> cercaPerAnno(int anno) const;
     QList<Media *> getTuttiMedia() const;
@@ -44,12 +84,62 @@ public:
     // Sostituisce getLibri(), getFilm(), getArticoli() con polimorfismo non banale
     QList<Media *> collectMediaByType(MediaFilter::FilterType filterType) const;
 
+    // Query su insiemi di slot (posizioni dei Media nel container) rappresentati
+    // come bitmap compresse, combinabili con &, | e andNot()
+    RoaringBitmap bitmapTutti() const;
+    RoaringBitmap bitmapPerTipo(MediaFilter::FilterType filterType) const;
+    RoaringBitmap bitmapPerAnno(int anno) const;
+    RoaringBitmap bitmapPerTitolo(const QString &titolo, const RoaringBitmap &candidati) const;
+    RoaringBitmap eseguiQuery(const MediaFilter::Query &query) const;
+
+    // Varianti paginate: la scansione si ferma appena la pagina è piena
+    MediaFilter::Page cercaPerTitoloPaginato(const QString &titolo, int offset, int limit) const;
+    MediaFilter::Page cercaPerAnnoPaginato(int anno, int offset, int limit) const;
+    MediaFilter::Page collectMediaByTypePaginato(MediaFilter::FilterType filterType, int offset, int limit) const;
+    MediaFilter::Page eseguiQueryPaginata(const MediaFilter::Query &query, int offset, int limit) const;
+    MediaFilter::Page eseguiQueryDaCursore(const MediaFilter::Query &query, quint32 cursore, int limit) const;
+
+    // Converte gli slot in puntatori, limitandosi alla pagina richiesta
+    QList<Media *> materializza(const RoaringBitmap &selezione, int offset = 0, int limit = -1) const;
+
+    // Da chiamare dopo aver modificato titolo/anno di un Media già presente
+    void notificaModifica(Media *media);
+
+    // Array JSON di tutti i Media, nel formato di JsonSerializer
+    QJsonArray serializzaMedia() const;
+
+    // Copia per valore di tutti i Media: le stringhe sono condivise (implicit sharing),
+    // quindi costa poco e può essere letta da un altro thread
+    MediaStore istantanea() const;
+
     void svuota();
     int dimensione() const;
     bool isEmpty() const;
 
+    // Aggiorna gli indicatori "biblioteca.*" del registro delle metriche
+    void aggiornaMetriche() const;
+
+    // Memoria stimata di Media, container e indici
+    MemoryReport memoryFootprint() const;
+
 private:
     Container<Media> mediaContainer;
+
+    // Indici secondari costruiti su richiesta e invalidati a ogni rimozione
+    mutable bool indiciValidi = false;
+    mutable RoaringBitmap indiceLibri;
+    mutable RoaringBitmap indiceFilm;
+    mutable RoaringBitmap indiceArticoli;
+    mutable QHash<int, RoaringBitmap> indiceAnni;
+
+    RoaringBitmap candidatiIndicizzati(const MediaFilter::Query &query) const;
+    MediaFilter::Page paginaDaCandidati(const RoaringBitmap &candidati, const QString &titolo,
+                                        quint32 cursore, int offset, int limit) const;
+    void assicuraIndici() const;
+    void costruisciIndici() const;
+    void indicizza(Media *media, quint32 slot) const;
+    void invalidaIndici();
+    void copiaDa(const Biblioteca &other);
 };
 
 #endif // BIBLIOTECA_H
@@ -1,69 +1,63 @@
 #include "Book.h"
 #include "MediaVisitor.h"
+#include "MediaSchema.h"
+#include "MediaTypeRegistry.h"
 
-Book::Book(const QString &title, int year, const QString &author, const QString &isbn, const QString &publisher, const QString &coverImagePath)
-    : Media(title, year, coverImagePath), author(author), publisher(publisher), isbn(isbn)
+namespace
 {
+    // Registrazione nel MediaTypeRegistry durante l'inizializzazione statica
+    const MediaTypeRegistrar<Book> registrazione(Book::TypeTag);
 }
 
-// Costruttore di copia
-Book::Book(const Book &other)
-    : Media(other), author(other.author), publisher(other.publisher), isbn(other.isbn)
+Book::Book(const QString &title, int year, const QString &author, const QString &isbn, const QString &publisher, const QString &coverImagePath)
+    : Media(MediaKind::Book, title, year, coverImagePath), author(author), publisher(publisher), isbn(isbn)
 {
 }
 
 QString Book::getAuthor() const
 {
+    assicuraCampi();
     return author;
 }
 
 QString Book::getIsbn() const
 {
+    assicuraCampi();
     return isbn;
 }
 
 QString Book::getPublisher() const
 {
+    assicuraCampi();
     return publisher;
 }
 
 void Book::setAuthor(const QString &newAuthor)
 {
+    assicuraCampi();
     author = newAuthor;
 }
 
 void Book::setIsbn(const QString &newIsbn)
 {
+    assicuraCampi();
     isbn = newIsbn;
 }
 
 void Book::setPublisher(const QString &newPublisher)
 {
+    assicuraCampi();
     publisher = newPublisher;
 }
 
 QString Book::visualizzaDettagli() const
 {
-    return QString("Libro: %1 (%2)\nAutore: %3\nISBN: %4\nEditore: %5\nCopertina: %6")
-        .arg(title)
-        .arg(year)
-        .arg(author)
-        .arg(isbn)
-        .arg(publisher)
-        .arg(coverImagePath);
+    return Schema::describe(*this);
 }
 
 QJsonObject Book::serializza() const
 {
-    QJsonObject jsonObject;
-    jsonObject["type"] = "Book";
-    jsonObject["title"] = title;
-    jsonObject["year"] = year;
-    jsonObject["author"] = author;
-    jsonObject["isbn"] = isbn;
-    jsonObject["publisher"] = publisher;
-    jsonObject["coverImagePath"] = coverImagePath;
-    return jsonObject;
+    return Schema::toJson(*this);
 }
 
 Media *Book::clone() const
@@ -73,13 +67,17 @@ Media *Book::clone() const
 
 Book *Book::deserializza(const QJsonObject &jsonObject)
 {
-    QString title = jsonObject["title"].toString();
-    int year = jsonObject["year"].toInt();
-    QString author = jsonObject["author"].toString();
-    QString isbn = jsonObject["isbn"].toString();
-    QString publisher = jsonObject["publisher"].toString();
-    QString coverImagePath = jsonObject["coverImagePath"].toString();
-    return new Book(title, year, author, isbn, publisher, coverImagePath);
+    return Schema::fromJson<Book>(jsonObject);
+}
+
+void Book::decodificaCampi(const QJsonObject &jsonObject)
+{
+    Schema::fromJsonDeferred(*this, jsonObject);
+}
+
+Media *Book::createEmpty(const QString &title, int year)
+{
+    return new Book(title, year, "", "", "");
 }
 
 QWidget *Book::accept(MediaVisitor &visitor)
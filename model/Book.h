@@ -7,14 +7,33 @@
 class Book : public Media
 {
 public:
+    // Tag del tipo nel campo "type" del JSON
+    static constexpr const char *TypeTag = "Book";
+
     Book(const QString &title, int year, const QString &author, const QString &isbn, const QString &publisher, const QString &coverImagePath = "");
 
     // Costruttore di copia
-    Book(const Book &other);
+    Book(const Book &other) = default;
 
     QString getAuthor() const;
     QString getIsbn() const;
     QString getPublisher() const;
+    // Versioni senza copia dei getter, vedi Media::getTitleRef()
+    const QString &getAuthorRef() const
+    {
+        assicuraCampi();
+        return author;
+    }
+    const QString &getIsbnRef() const
+    {
+        assicuraCampi();
+        return isbn;
+    }
+    const QString &getPublisherRef() const
+    {
+        assicuraCampi();
+        return publisher;
+    }
     void setAuthor(const QString &author);
     void setIsbn(const QString &isbn);
     void setPublisher(const QString &publisher);
@@ -23,8 +42,14 @@ public:
     QJsonObject serializza() const override;
     Media *clone() const override;
     static Book *deserializza(const QJsonObject &jsonObject);
+    // Media con i soli campi comuni, per la creazione generica tramite tag
+    static Media *createEmpty(const QString &title, int year);
 
     QWidget *accept(MediaVisitor &visitor) override;
+    using Media::accept;
+
+protected:
+    void decodificaCampi(const QJsonObject &jsonObject) override;
 
 private:
     QString author;
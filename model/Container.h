@@ -2,8 +2,10 @@
 #define CONTAINER_H
 
 #include <QList>
+#include <QSet>
 #include <algorithm>
 #include "Exceptions.h"
+#include "Result.h"
 
 template <typename T>
 class Container
@@ -42,7 +44,26 @@ public:
             }
         }
         return *this;
-    } // Distruttore
+    }
+
+    // Spostamento: trasferisce i puntatori senza clonare
+    Container(Container &&other) noexcept
+    {
+        items.swap(other.items);
+    }
+
+    Container &operator=(Container &&other) noexcept
+    {
+        items.swap(other.items);
+        return *this;
+    }
+
+    void swap(Container &other) noexcept
+    {
+        items.swap(other.items);
+    }
+
+    // Distruttore
     ~Container()
     {
         clear();
@@ -61,34 +82,122 @@ public:
         items.append(item);
     }
 
+    // Riserva spazio per almeno capacity elementi
+    void reserve(int capacity)
+    {
+        items.reserve(capacity);
+    }
+
+    // Inserimento in blocco: valida tutti gli elementi in un'unica passata
+    // usando un insieme hash invece di contains() per ogni elemento.
+    // Gli elementi nulli o già presenti vengono saltati.
+    // Restituisce il numero di elementi effettivamente aggiunti.
+    int addAll(const QList<T *> &nuovi)
+    {
+        QList<T *> validi = validateBatch(nuovi, false);
+        items.reserve(items.size() + validi.size());
+        for (T *item : validi)
+        {
+            items.append(item);
+        }
+        return validi.size();
+    }
+
+    // Variante transazionale: se un elemento non è valido lancia un'eccezione
+    // senza aver modificato il container
+    void addAllOrNothing(const QList<T *> &nuovi)
+    {
+        QList<T *> validi = validateBatch(nuovi, true);
+        // reserve() è l'unico passo che può fallire: avviene prima di ogni modifica
+        items.reserve(items.size() + validi.size());
+        for (T *item : validi)
+        {
+            items.append(item);
+        }
+    }
+
+    // Rimuove gli ultimi count elementi SENZA distruggerli: la proprietà torna
+    // al chiamante. Usato per annullare un inserimento in blocco.
+    void releaseLast(int count)
+    {
+        for (int i = 0; i < count && !items.isEmpty(); ++i)
+        {
+            items.removeLast();
+        }
+    }
+
     void remove(T *item)
+    {
+        tryRemove(item).orThrow();
+    }
+
+    void removeAt(int index)
+    {
+        tryRemoveAt(index).orThrow();
+    }
+
+    T *at(int index) const
+    {
+        return tryAt(index).orThrow();
+    }
+
+    // Sostituisce (e distrugge) l'elemento alla posizione indicata
+    void replaceAt(int index, T *item)
     {
         if (!item)
         {
-            throw InvalidDataException("Tentativo di rimuovere un puntatore nullo");
+            throw InvalidDataException("Tentativo di inserire un puntatore nullo");
+        }
+        T *vecchio = tryAt(index).orThrow();
+        if (vecchio != item)
+        {
+            if (contains(item))
+            {
+                throw DuplicateMediaException();
+            }
+            items[index] = item;
+            delete vecchio;
+        }
+    }
+
+    // Posizione dell'elemento, -1 se assente
+    int indexOf(const T *item) const
+    {
+        return items.indexOf(const_cast<T *>(item));
+    }
+
+    // Varianti senza eccezioni: i casi ordinari (elemento assente, indice
+    // fuori intervallo) vengono restituiti come Error
+    Result<void> tryRemove(T *item)
+    {
+        if (!item)
+        {
+            return Error(ErrorCode::InvalidData, "Tentativo di rimuovere un puntatore nullo");
         }
         int index = items.indexOf(item);
         if (index == -1)
         {
-            throw MediaNotFoundException("Item non presente nel container");
+            return Error(ErrorCode::NotFound, "Item non presente nel container");
         }
         delete items.takeAt(index);
+        return Result<void>();
     }
 
-    void removeAt(int index)
+    Result<void> tryRemoveAt(int index)
     {
         if (index < 0 || index >= items.size())
         {
-            throw MediaNotFoundException("Indice non valido: " + std::to_string(index));
+            return Error(ErrorCode::NotFound, "Indice non valido: ", index);
         }
         delete items.takeAt(index);
+        return Result<void>();
     }
 
-    T *at(int index) const
+    Result<T *> tryAt(int index) const
     {
         if (index < 0 || index >= items.size())
         {
-            throw MediaNotFoundException("Indice non valido: " + std::to_string(index));
+            return Error(ErrorCode::NotFound, "Indice non valido: ", index);
         }
         return items.at(index);
     }
@@ -160,6 +269,42 @@ public:
         }
         return result;
     }
+
+private:
+    QList<T *> validateBatch(const QList<T *> &nuovi, bool strict) const
+    {
+        QSet<T *> presenti;
+        presenti.reserve(items.size() + nuovi.size());
+        for (T *item : items)
+        {
+            presenti.insert(item);
+        }
+
+        QList<T *> validi;
+        validi.reserve(nuovi.size());
+        for (T *item : nuovi)
+        {
+            if (!item)
+            {
+                if (strict)
+                {
+                    throw InvalidDataException("Tentativo di aggiungere un puntatore nullo");
+                }
+                continue;
+            }
+            if (presenti.contains(item))
+            {
+                if (strict)
+                {
+                    throw DuplicateMediaException();
+                }
+                continue;
+            }
+            presenti.insert(item);
+            validi.append(item);
+        }
+        return validi;
+    }
 };
 
 #endif // CONTAINER_H
@@ -0,0 +1,530 @@
+#include "DuplicateDetector.h"
+#include "Biblioteca.h"
+#include "Book.h"
+#include "Film.h"
+#include "MagazineArticle.h"
+#include "MediaVisitorT.h"
+#include "MediaSchema.h"
+#include <QSet>
+
+namespace
+{
+    enum TipoMedia
+    {
+        TIPO_LIBRO = 0,
+        TIPO_FILM = 1,
+        TIPO_ARTICOLO = 2
+    };
+
+    /**
+     * Visitor che estrae i dati usati per il confronto:
+     * tipo, identificativo (campo con ruolo ISBN o DOI nello schema) e autore/regista
+     * (campo con ruolo CreatorRole).
+     */
+    class DedupKeyVisitor : public StaticMediaVisitor<DedupKeyVisitor>
+    {
+    public:
+        int tipo = -1;
+        QString identificativo;
+        QString autore;
+
+        void visit(const Book &book) { estrai(book, TIPO_LIBRO); }
+        void visit(const Film &film) { estrai(film, TIPO_FILM); }
+        void visit(const MagazineArticle &article) { estrai(article, TIPO_ARTICOLO); }
+
+    private:
+        template <typename T>
+        void estrai(const T &media, int tipoMedia)
+        {
+            tipo = tipoMedia;
+            autore = Schema::valueWithRole(media, Schema::CreatorRole);
+
+            const QString isbn = DuplicateDetector::normalizzaIsbn(Schema::valueWithRole(media, Schema::IsbnRole));
+            const QString doi = DuplicateDetector::normalizzaDoi(Schema::valueWithRole(media, Schema::DoiRole));
+            if (!isbn.isEmpty())
+            {
+                identificativo = "isbn:" + isbn;
+            }
+            else if (!doi.isEmpty())
+            {
+                identificativo = "doi:" + doi;
+            }
+        }
+    };
+
+    // Copia nei campi vuoti di destinazione i valori di sorgente, seguendo lo schema di T
+    template <typename T>
+    void completaCampi(T &destinazione, const T &sorgente)
+    {
+        Schema::forEachField<T>([&](const auto &field)
+                                {
+                                    if constexpr (std::decay_t<decltype(field)>::kind == Schema::FieldKind::Integer)
+                                    {
+                                        if (field.read(destinazione) == 0)
+                                            field.write(destinazione, field.read(sorgente));
+                                    }
+                                    else if (field.read(destinazione).isEmpty())
+                                    {
+                                        field.write(destinazione, field.read(sorgente));
+                                    } });
+    }
+
+    // Finalizzatore di splitmix64: mescola bene i bit con poche operazioni
+    quint64 mescola(quint64 x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+}
+
+DuplicateDetector::DuplicateDetector(double sogliaSimilarita)
+    : sogliaSimilarita(sogliaSimilarita)
+{
+}
+
+/**
+ * Normalizza un ISBN nella forma canonica ISBN-13 composta da sole cifre.
+ * Trattini e spazi vengono ignorati; un ISBN-10 viene convertito aggiungendo
+ * il prefisso 978 e ricalcolando la cifra di controllo.
+ * @param isbn ISBN così come inserito
+ * @return ISBN-13 canonico, le sole cifre se il formato non è riconosciuto,
+ *         stringa vuota se non contiene cifre
+ */
+QString DuplicateDetector::normalizzaIsbn(const QString &isbn)
+{
+    QString cifre;
+    cifre.reserve(isbn.size());
+    for (const QChar c : isbn)
+    {
+        if (c.isDigit() || c == QChar('X') || c == QChar('x'))
+        {
+            cifre.append(c.toUpper());
+        }
+    }
+
+    if (cifre.size() == 10)
+    {
+        QString isbn13 = "978" + cifre.left(9);
+        int somma = 0;
+        for (int i = 0; i < 12; ++i)
+        {
+            somma += isbn13.at(i).digitValue() * (i % 2 == 0 ? 1 : 3);
+        }
+        isbn13.append(QChar('0' + (10 - somma % 10) % 10));
+        return isbn13;
+    }
+    return cifre;
+}
+
+/**
+ * Normalizza un DOI: rimuove i prefissi di risoluzione e applica il case folding
+ * (i DOI sono case-insensitive).
+ * @param doi DOI così come inserito
+ * @return DOI normalizzato, vuoto se assente
+ */
+QString DuplicateDetector::normalizzaDoi(const QString &doi)
+{
+    QString risultato = doi.trimmed().toCaseFolded();
+    const QStringList prefissi = {"https://doi.org/", "http://doi.org/",
+                                  "https://dx.doi.org/", "http://dx.doi.org/", "doi:"};
+    for (const QString &prefisso : prefissi)
+    {
+        if (risultato.startsWith(prefisso))
+        {
+            risultato = risultato.mid(prefisso.size()).trimmed();
+            break;
+        }
+    }
+    return risultato;
+}
+
+/**
+ * Normalizza un testo per il confronto: case folding, rimozione degli accenti
+ * e della punteggiatura, spazi multipli ridotti a uno.
+ * @param testo Testo originale
+ * @return Testo normalizzato
+ */
+QString DuplicateDetector::normalizzaTesto(const QString &testo)
+{
+    const QString scomposto = testo.normalized(QString::NormalizationForm_D);
+    QString risultato;
+    risultato.reserve(scomposto.size());
+    bool separatore = false;
+    for (const QChar c : scomposto)
+    {
+        if (c.category() == QChar::Mark_NonSpacing)
+        {
+            continue; // accenti separati dalla decomposizione
+        }
+        if (c.isLetterOrNumber())
+        {
+            if (separatore && !risultato.isEmpty())
+            {
+                risultato.append(QChar(' '));
+            }
+            separatore = false;
+            risultato.append(c.toCaseFolded());
+        }
+        else
+        {
+            separatore = true;
+        }
+    }
+    return risultato;
+}
+
+/**
+ * Registra un Media come riferimento per i confronti successivi.
+ * @param media Media da indicizzare (la proprietà non viene trasferita)
+ */
+void DuplicateDetector::indicizza(Media *media)
+{
+    if (media)
+    {
+        registra(media, calcolaChiavi(media));
+    }
+}
+
+/**
+ * Registra tutti i Media di una biblioteca come riferimento.
+ * @param biblioteca Biblioteca di destinazione dell'importazione
+ */
+void DuplicateDetector::indicizza(const Biblioteca &biblioteca)
+{
+    const QList<Media *> tutti = biblioteca.getTuttiMedia();
+    voci.reserve(voci.size() + tutti.size());
+    perImpronta.reserve(perImpronta.size() + tutti.size());
+    for (Media *media : tutti)
+    {
+        indicizza(media);
+    }
+}
+
+void DuplicateDetector::svuota()
+{
+    perIdentificativo.clear();
+    perImpronta.clear();
+    perBanda.clear();
+    voci.clear();
+}
+
+/**
+ * Cerca tra i Media indicizzati un duplicato di quello indicato.
+ * @param media Media da verificare
+ * @param motivo Se non nullo, riceve il criterio che ha rilevato il duplicato
+ * @param similarita Se non nullo, riceve la similarità stimata (1.0 se esatto)
+ * @return Media duplicato già indicizzato, nullptr se non trovato
+ */
+Media *DuplicateDetector::trovaDuplicato(Media *media, Deduplicazione::Motivo *motivo, double *similarita) const
+{
+    if (!media)
+    {
+        return nullptr;
+    }
+    const int indice = cerca(calcolaChiavi(media), media->getYear(), motivo, similarita);
+    return indice >= 0 ? voci.at(indice).media : nullptr;
+}
+
+/**
+ * Importa una lista di Media nella biblioteca scartando, unendo o segnalando
+ * i duplicati. Anche i Media della stessa importazione vengono confrontati tra loro.
+ * @param destinazione Biblioteca in cui inserire i Media accettati
+ * @param nuovi Media da importare (proprietà trasferita)
+ * @param politica Comportamento in caso di duplicato
+ * @return Riepilogo dell'importazione
+ */
+Deduplicazione::Report DuplicateDetector::importa(Biblioteca &destinazione, const QList<Media *> &nuovi,
+                                                  Deduplicazione::Politica politica)
+{
+    Deduplicazione::Report report;
+    QList<Media *> daAggiungere;
+    daAggiungere.reserve(nuovi.size());
+    QSet<Media *> visti;
+    visti.reserve(nuovi.size());
+
+    for (Media *nuovo : nuovi)
+    {
+        if (!nuovo || visti.contains(nuovo))
+        {
+            continue;
+        }
+        visti.insert(nuovo);
+        ++report.esaminati;
+
+        const Chiavi chiavi = calcolaChiavi(nuovo);
+        Deduplicazione::Motivo motivo = Deduplicazione::Motivo::IMPRONTA;
+        double similarita = 0.0;
+        const int indice = cerca(chiavi, nuovo->getYear(), &motivo, &similarita);
+
+        if (indice >= 0)
+        {
+            Media *esistente = voci.at(indice).media;
+            report.duplicati.append({nuovo->getTitle(), esistente, motivo, similarita});
+
+            if (politica == Deduplicazione::Politica::RIFIUTA)
+            {
+                delete nuovo;
+                ++report.rifiutati;
+                continue;
+            }
+            if (politica == Deduplicazione::Politica::UNISCI)
+            {
+                unisci(esistente, nuovo);
+                // I campi completati (ISBN, DOI, autore) cambiano le chiavi dell'esistente
+                aggiorna(indice, calcolaChiavi(esistente));
+                destinazione.notificaModifica(esistente);
+                delete nuovo;
+                ++report.uniti;
+                continue;
+            }
+            ++report.segnalati;
+        }
+
+        registra(nuovo, chiavi);
+        daAggiungere.append(nuovo);
+    }
+
+    report.aggiunti = destinazione.aggiungiMediaBulk(daAggiungere);
+    return report;
+}
+
+DuplicateDetector::Chiavi DuplicateDetector::calcolaChiavi(Media *media) const
+{
+    DedupKeyVisitor estrattore;
+    estrattore.apply(*media);
+
+    Chiavi chiavi;
+    chiavi.tipo = estrattore.tipo;
+    chiavi.identificativo = estrattore.identificativo;
+    chiavi.autore = normalizzaTesto(estrattore.autore);
+
+    const QString titolo = normalizzaTesto(media->getTitleRef());
+    chiavi.impronta = QString::number(chiavi.tipo) + '|' + titolo + '|' + QString::number(media->getYear()) + '|' + chiavi.autore;
+    chiavi.firma = firmaMinHash(titolo);
+    return chiavi;
+}
+
+/**
+ * Ricerca effettiva di un duplicato, in ordine di affidabilità:
+ * identificativo, impronta esatta, similarità MinHash sui candidati delle bande.
+ * @return Indice in voci del duplicato, -1 se non trovato
+ */
+int DuplicateDetector::cerca(const Chiavi &chiavi, int anno, Deduplicazione::Motivo *motivo, double *similarita) const
+{
+    auto esito = [motivo, similarita](Deduplicazione::Motivo m, double s)
+    {
+        if (motivo)
+        {
+            *motivo = m;
+        }
+        if (similarita)
+        {
+            *similarita = s;
+        }
+    };
+
+    if (!chiavi.identificativo.isEmpty())
+    {
+        auto it = perIdentificativo.constFind(chiavi.identificativo);
+        if (it != perIdentificativo.constEnd())
+        {
+            esito(chiavi.identificativo.startsWith("isbn:") ? Deduplicazione::Motivo::ISBN
+                                                            : Deduplicazione::Motivo::DOI,
+                  1.0);
+            return it.value();
+        }
+    }
+
+    auto impronta = perImpronta.constFind(chiavi.impronta);
+    if (impronta != perImpronta.constEnd()
+        && identificativiCompatibili(chiavi.identificativo, voci.at(impronta.value()).identificativo))
+    {
+        esito(Deduplicazione::Motivo::IMPRONTA, 1.0);
+        return impronta.value();
+    }
+
+    // Due Media con identificativi diversi sono edizioni distinte: la similarità
+    // del titolo serve solo quando almeno uno dei due ne è privo
+    int migliore = -1;
+    double similaritaMigliore = sogliaSimilarita;
+    QSet<int> esaminati;
+    for (int banda = 0; banda < NumeroHash / RighePerBanda; ++banda)
+    {
+        const QList<int> candidati = perBanda.value(chiaveBanda(chiavi.firma, banda));
+        for (int indice : candidati)
+        {
+            if (esaminati.contains(indice))
+            {
+                continue;
+            }
+            esaminati.insert(indice);
+
+            const Voce &voce = voci.at(indice);
+            if (voce.tipo != chiavi.tipo || voce.anno != anno
+                || !identificativiCompatibili(chiavi.identificativo, voce.identificativo))
+            {
+                continue;
+            }
+            if (!voce.autore.isEmpty() && !chiavi.autore.isEmpty() && voce.autore != chiavi.autore)
+            {
+                continue;
+            }
+
+            const double s = similaritaFirme(chiavi.firma, voce.firma);
+            if (s >= similaritaMigliore)
+            {
+                similaritaMigliore = s;
+                migliore = indice;
+            }
+        }
+    }
+
+    if (migliore >= 0)
+    {
+        esito(Deduplicazione::Motivo::SIMILARITA, similaritaMigliore);
+    }
+    return migliore;
+}
+
+bool DuplicateDetector::identificativiCompatibili(const QString &a, const QString &b)
+{
+    return a.isEmpty() || b.isEmpty() || a == b;
+}
+
+/**
+ * Firma MinHash dei trigrammi di caratteri del titolo normalizzato.
+ * Ogni trigramma è codificato in un intero a 64 bit, quindi non servono
+ * stringhe temporanee; le funzioni hash sono varianti con seme di splitmix64.
+ * @param testoNormalizzato Titolo già normalizzato
+ * @return Firma di NumeroHash minimi
+ */
+QVector<quint32> DuplicateDetector::firmaMinHash(const QString &testoNormalizzato)
+{
+    QVector<quint32> firma(NumeroHash, 0xFFFFFFFFu);
+    const int lunghezza = testoNormalizzato.size();
+    const int trigrammi = lunghezza >= 3 ? lunghezza - 2 : (lunghezza > 0 ? 1 : 0);
+
+    for (int i = 0; i < trigrammi; ++i)
+    {
+        quint64 codice = 0;
+        for (int k = i; k < qMin(i + 3, lunghezza); ++k)
+        {
+            codice = (codice << 16) | testoNormalizzato.at(k).unicode();
+        }
+        for (int h = 0; h < NumeroHash; ++h)
+        {
+            const quint32 valore = quint32(mescola(codice ^ mescola(quint64(h) + 1)));
+            if (valore < firma.at(h))
+            {
+                firma[h] = valore;
+            }
+        }
+    }
+    return firma;
+}
+
+/**
+ * Stima della similarità di Jaccard: frazione di posizioni uguali nelle firme.
+ */
+double DuplicateDetector::similaritaFirme(const QVector<quint32> &a, const QVector<quint32> &b)
+{
+    int uguali = 0;
+    for (int i = 0; i < NumeroHash; ++i)
+    {
+        if (a.at(i) == b.at(i))
+        {
+            ++uguali;
+        }
+    }
+    return double(uguali) / NumeroHash;
+}
+
+quint64 DuplicateDetector::chiaveBanda(const QVector<quint32> &firma, int banda)
+{
+    quint64 chiave = mescola(quint64(banda) + 0x9e3779b97f4a7c15ULL);
+    for (int riga = 0; riga < RighePerBanda; ++riga)
+    {
+        chiave = mescola(chiave ^ firma.at(banda * RighePerBanda + riga));
+    }
+    return chiave;
+}
+
+/**
+ * Inserisce il Media in tutti gli indici.
+ * Le liste di candidati per banda sono limitate a MaxCandidatiPerBanda, così i titoli
+ * molto comuni non degradano l'importazione a un costo quadratico.
+ */
+void DuplicateDetector::registra(Media *media, const Chiavi &chiavi)
+{
+    const int indice = voci.size();
+    voci.append({media, chiavi.tipo, media->getYear(), chiavi.identificativo, chiavi.autore, chiavi.firma});
+
+    if (!chiavi.identificativo.isEmpty() && !perIdentificativo.contains(chiavi.identificativo))
+    {
+        perIdentificativo.insert(chiavi.identificativo, indice);
+    }
+    if (!perImpronta.contains(chiavi.impronta))
+    {
+        perImpronta.insert(chiavi.impronta, indice);
+    }
+    for (int banda = 0; banda < NumeroHash / RighePerBanda; ++banda)
+    {
+        QList<int> &bucket = perBanda[chiaveBanda(chiavi.firma, banda)];
+        if (bucket.size() < MaxCandidatiPerBanda)
+        {
+            bucket.append(indice);
+        }
+    }
+}
+
+/**
+ * Aggiorna la voce di un Media già registrato dopo che un'unione ne ha completato i campi.
+ * Le chiavi nuove vengono aggiunte agli indici; quelle precedenti restano, perché
+ * l'unione riempie solo campi vuoti e i vecchi valori sono compatibili con i nuovi.
+ */
+void DuplicateDetector::aggiorna(int indice, const Chiavi &chiavi)
+{
+    Voce &voce = voci[indice];
+    voce.anno = voce.media->getYear();
+    voce.identificativo = chiavi.identificativo;
+    voce.autore = chiavi.autore;
+
+    if (!chiavi.identificativo.isEmpty() && !perIdentificativo.contains(chiavi.identificativo))
+    {
+        perIdentificativo.insert(chiavi.identificativo, indice);
+    }
+    if (!perImpronta.contains(chiavi.impronta))
+    {
+        perImpronta.insert(chiavi.impronta, indice);
+    }
+    if (voce.firma != chiavi.firma)
+    {
+        // Titolo completato dall'unione: la voce entra anche nelle bande della nuova firma
+        voce.firma = chiavi.firma;
+        for (int banda = 0; banda < NumeroHash / RighePerBanda; ++banda)
+        {
+            QList<int> &bucket = perBanda[chiaveBanda(chiavi.firma, banda)];
+            if (bucket.size() < MaxCandidatiPerBanda && !bucket.contains(indice))
+            {
+                bucket.append(indice);
+            }
+        }
+    }
+}
+
+/**
+ * Completa i campi vuoti del Media esistente con quelli del duplicato importato.
+ * I campi già valorizzati (testo non vuoto, interi diversi da zero) non vengono mai
+ * sovrascritti. I campi sono quelli dello schema del tipo concreto, comuni compresi.
+ */
+void DuplicateDetector::unisci(Media *esistente, const Media *nuovo)
+{
+    Schema::dispatch(*esistente, [nuovo](auto &destinazione)
+                     {
+                         using T = std::decay_t<decltype(destinazione)>;
+                         if (const T *altro = dynamic_cast<const T *>(nuovo))
+                         {
+                             completaCampi(destinazione, *altro);
+                         } });
+}
@@ -0,0 +1,123 @@
+#ifndef DUPLICATEDETECTOR_H
+#define DUPLICATEDETECTOR_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include "Media.h"
+
+class Biblioteca;
+
+namespace Deduplicazione
+{
+    // Cosa fare quando un Media importato risulta duplicato
+    enum class Politica
+    {
+        RIFIUTA, // scarta il nuovo Media
+        UNISCI,  // completa i campi vuoti dell'esistente e scarta il nuovo
+        SEGNALA  // aggiunge comunque il nuovo Media, registrando il duplicato
+    };
+
+    enum class Motivo
+    {
+        ISBN,
+        DOI,
+        IMPRONTA,  // titolo, anno e autore normalizzati identici
+        SIMILARITA // titoli simili (MinHash) con stesso anno e autore
+    };
+
+    struct Duplicato
+    {
+        QString titolo;    // titolo del Media importato
+        Media *esistente;  // Media già presente (valido finché resta nella biblioteca)
+        Motivo motivo;
+        double similarita; // 1.0 per le corrispondenze esatte
+    };
+
+    struct Report
+    {
+        int esaminati = 0;
+        int aggiunti = 0;
+        int rifiutati = 0;
+        int uniti = 0;
+        int segnalati = 0;
+        QList<Duplicato> duplicati;
+    };
+}
+
+/**
+ * DuplicateDetector - Rilevamento dei duplicati durante le importazioni
+ *
+ * Mantiene indici hash su ISBN normalizzato (ISBN-10 convertito in ISBN-13),
+ * DOI normalizzato e impronta titolo+anno+autore. I Media senza identificativo
+ * vengono confrontati anche per similarità del titolo tramite firme MinHash
+ * suddivise in bande (LSH), così ogni inserimento esamina solo pochi candidati
+ * e l'importazione resta quasi lineare nel numero di record.
+ */
+class DuplicateDetector
+{
+public:
+    explicit DuplicateDetector(double sogliaSimilarita = 0.8);
+
+    // Normalizzazioni degli identificativi e del testo
+    static QString normalizzaIsbn(const QString &isbn);
+    static QString normalizzaDoi(const QString &doi);
+    static QString normalizzaTesto(const QString &testo);
+
+    // Registra Media già presenti come riferimento per i confronti
+    void indicizza(Media *media);
+    void indicizza(const Biblioteca &biblioteca);
+    void svuota();
+
+    // Cerca un duplicato del Media tra quelli indicizzati
+    Media *trovaDuplicato(Media *media, Deduplicazione::Motivo *motivo = nullptr,
+                          double *similarita = nullptr) const;
+
+    // Importa i Media nella biblioteca applicando la politica indicata.
+    // La proprietà di tutti i Media passati viene trasferita.
+    Deduplicazione::Report importa(Biblioteca &destinazione, const QList<Media *> &nuovi,
+                                   Deduplicazione::Politica politica);
+
+private:
+    static constexpr int NumeroHash = 32;
+    static constexpr int RighePerBanda = 4;
+    static constexpr int MaxCandidatiPerBanda = 64;
+
+    struct Chiavi
+    {
+        int tipo = -1;
+        QString identificativo; // ISBN o DOI normalizzato (vuoto se assente)
+        QString impronta;
+        QString autore;
+        QVector<quint32> firma;
+    };
+
+    struct Voce
+    {
+        Media *media;
+        int tipo;
+        int anno;
+        QString identificativo;
+        QString autore;
+        QVector<quint32> firma;
+    };
+
+    double sogliaSimilarita;
+    QHash<QString, int> perIdentificativo; // valori: indici in voci
+    QHash<QString, int> perImpronta;
+    QHash<quint64, QList<int>> perBanda;
+    QVector<Voce> voci;
+
+    Chiavi calcolaChiavi(Media *media) const;
+    int cerca(const Chiavi &chiavi, int anno, Deduplicazione::Motivo *motivo, double *similarita) const;
+    static bool identificativiCompatibili(const QString &a, const QString &b);
+    static QVector<quint32> firmaMinHash(const QString &testoNormalizzato);
+    static double similaritaFirme(const QVector<quint32> &a, const QVector<quint32> &b);
+    static quint64 chiaveBanda(const QVector<quint32> &firma, int banda);
+    void registra(Media *media, const Chiavi &chiavi);
+    void aggiorna(int indice, const Chiavi &chiavi);
+    static void unisci(Media *esistente, const Media *nuovo);
+};
+
+#endif // DUPLICATEDETECTOR_H
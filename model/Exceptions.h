@@ -50,4 +50,10 @@ public:
     DuplicateMediaException() : BibliotecaException("Media già presente nella biblioteca") {}
 };
 
+class OperazioneAnnullataException : public BibliotecaException
+{
+public:
+    OperazioneAnnullataException() : BibliotecaException("Operazione annullata") {}
+};
+
 #endif // EXCEPTIONS_H
@@ -1,69 +1,63 @@
 #include "Film.h"
 #include "MediaVisitor.h"
+#include "MediaSchema.h"
+#include "MediaTypeRegistry.h"
 
-Film::Film(const QString &title, int year, const QString &director, int duration, const QString &genre, const QString &coverImagePath)
-    : Media(title, year, coverImagePath), director(director), duration(duration), genre(genre)
+namespace
 {
+    // Registrazione nel MediaTypeRegistry durante l'inizializzazione statica
+    const MediaTypeRegistrar<Film> registrazione(Film::TypeTag);
 }
 
-// Costruttore di copia
-Film::Film(const Film &other)
-    : Media(other), director(other.director), duration(other.duration), genre(other.genre)
+Film::Film(const QString &title, int year, const QString &director, int duration, const QString &genre, const QString &coverImagePath)
+    : Media(MediaKind::Film, title, year, coverImagePath), director(director), duration(duration), genre(genre)
 {
 }
 
 QString Film::getDirector() const
 {
+    assicuraCampi();
     return director;
 }
 
 int Film::getDuration() const
 {
+    assicuraCampi();
     return duration;
 }
 
 QString Film::getGenre() const
 {
+    assicuraCampi();
     return genre;
 }
 
 void Film::setDirector(const QString &newDirector)
 {
+    assicuraCampi();
     director = newDirector;
 }
 
 void Film::setDuration(int newDuration)
 {
+    assicuraCampi();
     duration = newDuration;
 }
 
 void Film::setGenre(const QString &newGenre)
 {
+    assicuraCampi();
     genre = newGenre;
 }
 
 QString Film::visualizzaDettagli() const
 {
-    return QString("Film: %1 (%2)\nRegista: %3\nDurata: %4 min\nGenere: %5\nCopertina: %6")
-        .arg(title)
-        .arg(year)
-        .arg(director)
-        .arg(duration)
-        .arg(genre)
-        .arg(coverImagePath);
+    return Schema::describe(*this);
 }
 
 QJsonObject Film::serializza() const
 {
-    QJsonObject jsonObject;
-    jsonObject["type"] = "Film";
-    jsonObject["title"] = title;
-    jsonObject["year"] = year;
-    jsonObject["director"] = director;
-    jsonObject["duration"] = duration;
-    jsonObject["genre"] = genre;
-    jsonObject["coverImagePath"] = coverImagePath;
-    return jsonObject;
+    return Schema::toJson(*this);
 }
 
 Media *Film::clone() const
@@ -73,13 +67,17 @@ Media *Film::clone() const
 
 Film *Film::deserializza(const QJsonObject &jsonObject)
 {
-    QString title = jsonObject["title"].toString();
-    int year = jsonObject["year"].toInt();
-    QString director = jsonObject["director"].toString();
-    int duration = jsonObject["duration"].toInt();
-    QString genre = jsonObject["genre"].toString();
-    QString coverImagePath = jsonObject["coverImagePath"].toString();
-    return new Film(title, year, director, duration, genre, coverImagePath);
+    return Schema::fromJson<Film>(jsonObject);
+}
+
+void Film::decodificaCampi(const QJsonObject &jsonObject)
+{
+    Schema::fromJsonDeferred(*this, jsonObject);
+}
+
+Media *Film::createEmpty(const QString &title, int year)
+{
+    return new Film(title, year, "", 0, "");
 }
 
 QWidget *Film::accept(MediaVisitor &visitor)
@@ -7,14 +7,28 @@
 class Film : public Media
 {
 public:
+    // Tag del tipo nel campo "type" del JSON
+    static constexpr const char *TypeTag = "Film";
+
     Film(const QString &title, int year, const QString &director, int duration, const QString &genre, const QString &coverImagePath = "");
 
     // Costruttore di copia
-    Film(const Film &other);
+    Film(const Film &other) = default;
 
     QString getDirector() const;
     int getDuration() const;
     QString getGenre() const;
+    // Versioni senza copia dei getter, vedi Media::getTitleRef()
+    const QString &getDirectorRef() const
+    {
+        assicuraCampi();
+        return director;
+    }
+    const QString &getGenreRef() const
+    {
+        assicuraCampi();
+        return genre;
+    }
     void setDirector(const QString &director);
     void setDuration(int duration);
     void setGenre(const QString &genre);
@@ -23,8 +37,14 @@ public:
     QJsonObject serializza() const override;
     Media *clone() const override;
     static Film *deserializza(const QJsonObject &jsonObject);
+    // Media con i soli campi comuni, per la creazione generica tramite tag
+    static Media *createEmpty(const QString &title, int year);
 
     QWidget *accept(MediaVisitor &visitor) override;
+    using Media::accept;
+
+protected:
+    void decodificaCampi(const QJsonObject &jsonObject) override;
 
 private:
     QString director;
@@ -1,67 +1,61 @@
 #include "MagazineArticle.h"
 #include "MediaVisitor.h"
+#include "MediaSchema.h"
+#include "MediaTypeRegistry.h"
 
-MagazineArticle::MagazineArticle(const QString &title, int year, const QString &author, const QString &magazine, const QString &doi, const QString &coverImagePath)
-    : Media(title, year, coverImagePath), author(author), magazine(magazine), doi(doi) {}
-
-// Costruttore di copia
-MagazineArticle::MagazineArticle(const MagazineArticle &other)
-    : Media(other), author(other.author), magazine(other.magazine), doi(other.doi)
+namespace
 {
+    // Registrazione nel MediaTypeRegistry durante l'inizializzazione statica
+    const MediaTypeRegistrar<MagazineArticle> registrazione(MagazineArticle::TypeTag);
 }
 
+MagazineArticle::MagazineArticle(const QString &title, int year, const QString &author, const QString &magazine, const QString &doi, const QString &coverImagePath)
+    : Media(MediaKind::MagazineArticle, title, year, coverImagePath), author(author), magazine(magazine), doi(doi) {}
+
 QString MagazineArticle::getAuthor() const
 {
+    assicuraCampi();
     return author;
 }
 
 QString MagazineArticle::getMagazine() const
 {
+    assicuraCampi();
     return magazine;
 }
 
 QString MagazineArticle::getDoi() const
 {
+    assicuraCampi();
     return doi;
 }
 
 void MagazineArticle::setAuthor(const QString &newAuthor)
 {
+    assicuraCampi();
     author = newAuthor;
 }
 
 void MagazineArticle::setMagazine(const QString &newMagazine)
 {
+    assicuraCampi();
     magazine = newMagazine;
 }
 
 void MagazineArticle::setDoi(const QString &newDoi)
 {
+    assicuraCampi();
     doi = newDoi;
 }
 
 QString MagazineArticle::visualizzaDettagli() const
 {
-    return QString("Articolo: %1 (%2)\nAutore: %3\nRivista: %4\nDOI: %5\nCopertina: %6")
-        .arg(title)
-        .arg(year)
-        .arg(author)
-        .arg(magazine)
-        .arg(doi)
-        .arg(coverImagePath);
+    return Schema::describe(*this);
 }
 
 QJsonObject MagazineArticle::serializza() const
 {
-    QJsonObject jsonObject;
-    jsonObject["type"] = "MagazineArticle";
-    jsonObject["title"] = title;
-    jsonObject["year"] = year;
-    jsonObject["author"] = author;
-    jsonObject["magazine"] = magazine;
-    jsonObject["doi"] = doi;
-    jsonObject["coverImagePath"] = coverImagePath;
-    return jsonObject;
+    return Schema::toJson(*this);
 }
 
 Media *MagazineArticle::clone() const
@@ -71,13 +65,17 @@ Media *MagazineArticle::clone() const
 
 MagazineArticle *MagazineArticle::deserializza(const QJsonObject &jsonObject)
 {
-    QString title = jsonObject["title"].toString();
-    int year = jsonObject["year"].toInt();
-    QString author = jsonObject["author"].toString();
-    QString magazine = jsonObject["magazine"].toString();
-    QString doi = jsonObject["doi"].toString();
-    QString coverImagePath = jsonObject["coverImagePath"].toString();
-    return new MagazineArticle(title, year, author, magazine, doi, coverImagePath);
+    return Schema::fromJson<MagazineArticle>(jsonObject);
+}
+
+void MagazineArticle::decodificaCampi(const QJsonObject &jsonObject)
+{
+    Schema::fromJsonDeferred(*this, jsonObject);
+}
+
+Media *MagazineArticle::createEmpty(const QString &title, int year)
+{
+    return new MagazineArticle(title, year, "", "", "");
 }
 
 QWidget *MagazineArticle::accept(MediaVisitor &visitor)
@@ -7,14 +7,33 @@
 class MagazineArticle : public Media
 {
 public:
+    // Tag del tipo nel campo "type" del JSON
+    static constexpr const char *TypeTag = "MagazineArticle";
+
     MagazineArticle(const QString &title, int year, const QString &author, const QString &magazine, const QString &doi, const QString &coverImagePath = "");
 
     // Costruttore di copia
-    MagazineArticle(const MagazineArticle &other);
+    MagazineArticle(const MagazineArticle &other) = default;
 
     QString getAuthor() const;
     QString getMagazine() const;
     QString getDoi() const;
+    // Versioni senza copia dei getter, vedi Media::getTitleRef()
+    const QString &getAuthorRef() const
+    {
+        assicuraCampi();
+        return author;
+    }
+    const QString &getMagazineRef() const
+    {
+        assicuraCampi();
+        return magazine;
+    }
+    const QString &getDoiRef() const
+    {
+        assicuraCampi();
+        return doi;
+    }
     void setAuthor(const QString &author);
     void setMagazine(const QString &magazine);
     void setDoi(const QString &doi);
@@ -23,8 +42,14 @@ public:
     QJsonObject serializza() const override;
     Media *clone() const override;
     static MagazineArticle *deserializza(const QJsonObject &jsonObject);
+    // Media con i soli campi comuni, per la creazione generica tramite tag
+    static Media *createEmpty(const QString &title, int year);
 
     QWidget *accept(MediaVisitor &visitor) override;
+    using Media::accept;
+
+protected:
+    void decodificaCampi(const QJsonObject &jsonObject) override;
 
 private:
     QString author;
@@ -1,10 +1,10 @@
 #include "Media.h"
-#include "Book.h"
-#include "Film.h"
-#include "MagazineArticle.h"
+#include "MediaKeys.h"
+#include "MediaTypeRegistry.h"
+#include "../diagnostics/Metrics.h"
 
-Media::Media(const QString& title, int year, const QString& coverImagePath)
-    : title(title), year(year), coverImagePath(coverImagePath) {}
+Media::Media(MediaKind kind, const QString& title, int year, const QString& coverImagePath)
+    : title(title), year(year), coverImagePath(coverImagePath), kind(kind) {}
 
 QString Media::getTitle() const {
     return title;
@@ -15,10 +15,12 @@ int Media::getYear() const {
 }
 
 QString Media::getCoverImagePath() const {
+    assicuraCampi();
     return coverImagePath;
 }
 
 void Media::setCoverImagePath(const QString& path) {
+    assicuraCampi();
     coverImagePath = path;
 }
 
@@ -31,14 +33,34 @@ void Media::setYear(int newYear) {
 }
 
 Media* Media::deserializza(const QJsonObject& jsonObject) {
-    QString type = jsonObject["type"].toString();
-    if (type == "Book") {
-        return Book::deserializza(jsonObject);
-    } else if (type == "Film") {
-        return Film::deserializza(jsonObject);
-    } else if (type == "MagazineArticle") {
-        return MagazineArticle::deserializza(jsonObject);
-    }
-    return nullptr; // O lanciare un'eccezione
+    // I tipi concreti si registrano nel MediaTypeRegistry; nullptr se il tipo è sconosciuto
+    return MediaTypeRegistry::instance().createFromJson(jsonObject.value(MediaKeys::Type).toString(), jsonObject);
+}
+
+
+/**
+ * Rimanda la decodifica dei campi diversi da titolo e anno: il Media
+ * conserva solo il riferimento al record, condiviso con il documento JSON.
+ * @param jsonObject Record completo da cui decodificare gli altri campi
+ */
+void Media::differisci(const QJsonObject& jsonObject) {
+    sorgente = jsonObject;
 }
 
+/**
+ * Decodifica i campi differiti e rilascia il record di origine.
+ * Il valore logico del Media non cambia, solo la sua rappresentazione:
+ * per questo è const e può essere invocata dai getter.
+ * Non è sincronizzata: un Media differito va letto da un solo thread.
+ */
+void Media::materializza() const {
+    if (sorgente.isEmpty()) {
+        return;
+    }
+    static Metrics::Counter &materializzati = Metrics::counter("media.materializzati");
+    Media* self = const_cast<Media*>(this);
+    const QJsonObject jsonObject = self->sorgente;
+    self->sorgente = QJsonObject(); // prima della decodifica: i setter non devono ripartire da qui
+    self->decodificaCampi(jsonObject);
+    materializzati.add();
+}
@@ -5,16 +5,38 @@
 #include <QJsonObject>
 
 class MediaVisitor;
+class QWidget;
+
+template <typename R>
+class MediaVisitorT;
+
+// Tipo concreto di un Media, memorizzato nella base per lo smistamento statico
+enum class MediaKind : quint8
+{
+    Book,
+    Film,
+    MagazineArticle
+};
 
 class Media
 {
 public:
-    Media(const QString &title, int year, const QString &coverImagePath = "");
+    Media(MediaKind kind, const QString &title, int year, const QString &coverImagePath = "");
     virtual ~Media() = default;
 
+    MediaKind tipo() const { return kind; }
+
     QString getTitle() const;
     int getYear() const;
     QString getCoverImagePath() const;
+    // Accesso senza copia per le scansioni in sola lettura (nessun incremento del
+    // contatore condiviso): il riferimento vale finché il Media non viene modificato
+    const QString &getTitleRef() const { return title; }
+    const QString &getCoverImagePathRef() const
+    {
+        assicuraCampi();
+        return coverImagePath;
+    }
     void setCoverImagePath(const QString &path);
     void setTitle(const QString &title);
     void setYear(int year);
@@ -26,10 +48,41 @@ public:
 
     virtual QWidget *accept(MediaVisitor &visitor) = 0;
 
+    // Visita con valore di ritorno generico, senza QtWidgets (definito in MediaVisitorT.h)
+    template <typename R>
+    R accept(MediaVisitorT<R> &visitor);
+
+    // Byte stimati nello heap per oggetto e campi testuali (definito in MemoryFootprintVisitor.cpp)
+    qint64 memoryFootprint() const;
+
+    // Caricamento differito: titolo e anno sono già decodificati, gli altri campi
+    // restano nel record JSON di origine fino al primo accesso
+    void differisci(const QJsonObject &jsonObject);
+    bool campiDifferiti() const { return !sorgente.isEmpty(); }
+    // Decodifica subito i campi differiti (nessun effetto se già decodificati)
+    void materializza() const;
+
 protected:
+    // Legge dal record i campi diversi da titolo e anno
+    virtual void decodificaCampi(const QJsonObject &jsonObject) = 0;
+    // Da chiamare in getter e setter dei campi differiti
+    void assicuraCampi() const
+    {
+        if (!sorgente.isEmpty())
+        {
+            materializza();
+        }
+    }
+
     QString title;
     int year;
     QString coverImagePath;
+
+private:
+    MediaKind kind;
+    // Record di origine dei campi non ancora decodificati (vuoto se materializzato).
+    // Condivide i dati del documento JSON caricato: non alloca stringhe per campo.
+    QJsonObject sorgente;
 };
 
 #endif // MEDIA_H
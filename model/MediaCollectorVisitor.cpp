@@ -1,8 +1,8 @@
 #include "MediaCollectorVisitor.h"
-#include "../model/Media.h"
-#include "../model/Book.h"
-#include "../model/Film.h"
-#include "../model/MagazineArticle.h"
+#include "Media.h"
+#include "Book.h"
+#include "Film.h"
+#include "MagazineArticle.h"
 
 /**
  * Costruttore del MediaCollectorVisitor
@@ -21,13 +21,12 @@ MediaCollectorVisitor::MediaCollectorVisitor(FilterType type)
  * - Altrimenti: ignora il Book
  * Dimostra polimorfismo non banale attraverso comportamenti specifici per tipo
  */
-QWidget *MediaCollectorVisitor::visit(Book *book)
+void MediaCollectorVisitor::visit(Book &book)
 {
-    if (book && (filterType == FilterType::ALL || filterType == FilterType::BOOKS_ONLY))
+    if (filterType == FilterType::ALL || filterType == FilterType::BOOKS_ONLY)
     {
-        collectedMedia.append(book);
+        collectedMedia.append(&book);
     }
-    return nullptr; // Questo visitor non genera widget
 }
 
 /**
@@ -35,13 +34,12 @@ QWidget *MediaCollectorVisitor::visit(Book *book)
  * Comportamento specifico per Film: raccoglie solo se il filtro lo consente
  * Dimostra come ogni tipo di Media ha un comportamento visitor diverso
  */
-QWidget *MediaCollectorVisitor::visit(Film *film)
+void MediaCollectorVisitor::visit(Film &film)
 {
-    if (film && (filterType == FilterType::ALL || filterType == FilterType::FILMS_ONLY))
+    if (filterType == FilterType::ALL || filterType == FilterType::FILMS_ONLY)
     {
-        collectedMedia.append(film);
+        collectedMedia.append(&film);
     }
-    return nullptr;
 }
 
 /**
@@ -49,13 +47,12 @@ QWidget *MediaCollectorVisitor::visit(Film *film)
  * Comportamento specifico per articoli: logica di raccolta dedicata
  * Ogni implementazione di visit() può avere logica completamente diversa
  */
-QWidget *MediaCollectorVisitor::visit(MagazineArticle *article)
+void MediaCollectorVisitor::visit(MagazineArticle &article)
 {
-    if (article && (filterType == FilterType::ALL || filterType == FilterType::ARTICLES_ONLY))
+    if (filterType == FilterType::ALL || filterType == FilterType::ARTICLES_ONLY)
     {
-        collectedMedia.append(article);
+        collectedMedia.append(&article);
     }
-    return nullptr;
 }
 
 /**
@@ -1,8 +1,8 @@
 #ifndef MEDIACOLLECTORVISITOR_H
 #define MEDIACOLLECTORVISITOR_H
 
-#include "../model/MediaVisitor.h"
-#include "../model/Biblioteca.h"
+#include "MediaVisitorT.h"
+#include "Biblioteca.h"
 #include <QList>
 #include <QString>
 
@@ -18,8 +18,10 @@ class MagazineArticle;
  * - Ogni metodo visit() ha un comportamento diverso basato sul tipo dinamico
  * - Utilizza il pattern Visitor invece del controllo di tipo esplicito
  * - Dimostra un uso sofisticato del polimorfismo per filtrare collezioni
+ *
+ * È un MediaVisitorT<void>: non restituisce widget e non dipende da QtWidgets.
  */
-class MediaCollectorVisitor : public MediaVisitor
+class MediaCollectorVisitor : public MediaVisitorT<void>
 {
 public:
     // Usa l'enum dal namespace MediaFilter per coerenza
@@ -39,26 +41,23 @@ public:
     /**
      * Visita un oggetto Book
      * Comportamento polimorfo: raccoglie il Book solo se il filtro lo consente
-     * @param book Puntatore al Book da visitare
-     * @return nullptr (questo visitor non genera widget)
+     * @param book Book da visitare
      */
-    QWidget *visit(Book *book) override;
+    void visit(Book &book) override;
 
     /**
      * Visita un oggetto Film
      * Comportamento polimorfo: raccoglie il Film solo se il filtro lo consente
-     * @param film Puntatore al Film da visitare
-     * @return nullptr (questo visitor non genera widget)
+     * @param film Film da visitare
      */
-    QWidget *visit(Film *film) override;
+    void visit(Film &film) override;
 
     /**
      * Visita un oggetto MagazineArticle
      * Comportamento polimorfo: raccoglie l'articolo solo se il filtro lo consente
-     * @param article Puntatore al MagazineArticle da visitare
-     * @return nullptr (questo visitor non genera widget)
+     * @param article MagazineArticle da visitare
      */
-    QWidget *visit(MagazineArticle *article) override;
+    void visit(MagazineArticle &article) override;
 
     /**
      * Ottiene i Media raccolti durante la visita
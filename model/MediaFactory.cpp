@@ -1,5 +1,7 @@
 #include "MediaFactory.h"
 #include <QStringList>
+#include "MediaKeys.h"
+#include "MediaTypeRegistry.h"
 
 Media *MediaFactory::createBook(const QString &title, int year, const QString &author,
                                 const QString &isbn, const QString &publisher,
@@ -25,130 +27,221 @@ Media *MediaFactory::createMagazineArticle(const QString &title, int year, const
     return new MagazineArticle(title, year, author, magazine, doi, coverImagePath);
 }
 
-Media *MediaFactory::createFromJson(const QJsonObject &jsonObject)
+Result<Media *> MediaFactory::tryCreateBook(const QString &title, int year, const QString &author,
+                                            const QString &isbn, const QString &publisher,
+                                            const QString &coverImagePath)
 {
-    if (!jsonObject.contains("type"))
+    Result<void> valido = tryValidateBookData(title, year, author, isbn, publisher);
+    if (!valido)
     {
-        throw JsonParseException("Tipo media mancante nel JSON");
+        return valido.error();
     }
+    return static_cast<Media *>(new Book(title, year, author, isbn, publisher, coverImagePath));
+}
 
-    QString type = jsonObject["type"].toString();
-
-    if (type == "Book")
+Result<Media *> MediaFactory::tryCreateFilm(const QString &title, int year, const QString &director,
+                                            int duration, const QString &genre,
+                                            const QString &coverImagePath)
+{
+    Result<void> valido = tryValidateFilmData(title, year, director, duration, genre);
+    if (!valido)
     {
-        return Book::deserializza(jsonObject);
+        return valido.error();
     }
-    else if (type == "Film")
+    return static_cast<Media *>(new Film(title, year, director, duration, genre, coverImagePath));
+}
+
+Result<Media *> MediaFactory::tryCreateMagazineArticle(const QString &title, int year, const QString &author,
+                                                       const QString &magazine, const QString &doi,
+                                                       const QString &coverImagePath)
+{
+    Result<void> valido = tryValidateMagazineData(title, year, author, magazine, doi);
+    if (!valido)
     {
-        return Film::deserializza(jsonObject);
+        return valido.error();
+    }
+    return static_cast<Media *>(new MagazineArticle(title, year, author, magazine, doi, coverImagePath));
+}
+
+Media *MediaFactory::createFromJson(const QJsonObject &jsonObject)
+{
+    return tryCreateFromJson(jsonObject).orThrow();
+}
+
+namespace
+{
+    // Una ricerca nella tabella dei tipi al posto di una catena di confronti
+    Result<const MediaTypeRegistry::Entry *> tipoDaJson(const QJsonObject &jsonObject)
+    {
+        const QJsonValue typeValue = jsonObject.value(MediaKeys::Type);
+        if (typeValue.isUndefined())
+        {
+            return Error(ErrorCode::JsonParse, "Tipo media mancante nel JSON");
+        }
+
+        const QString type = typeValue.toString();
+        const MediaTypeRegistry::Entry *entry = MediaTypeRegistry::instance().find(type);
+        if (!entry)
+        {
+            return Error(ErrorCode::InvalidData, "Tipo media non supportato: ", type);
+        }
+        return entry;
     }
-    else if (type == "MagazineArticle")
+}
+
+Result<Media *> MediaFactory::tryCreateFromJson(const QJsonObject &jsonObject)
+{
+    const Result<const MediaTypeRegistry::Entry *> entry = tipoDaJson(jsonObject);
+    if (!entry)
     {
-        return MagazineArticle::deserializza(jsonObject);
+        return entry.error();
     }
-    else
+    return entry.value()->fromJson(jsonObject);
+}
+
+/**
+ * Come tryCreateFromJson(), ma decodifica solo tipo, titolo e anno (i campi
+ * usati dagli indici); gli altri restano nel record fino al primo accesso.
+ */
+Result<Media *> MediaFactory::tryCreateDeferredFromJson(const QJsonObject &jsonObject)
+{
+    const Result<const MediaTypeRegistry::Entry *> entry = tipoDaJson(jsonObject);
+    if (!entry)
     {
-        throw InvalidDataException("Tipo media non supportato: " + type.toStdString());
+        return entry.error();
     }
+    Media *media = entry.value()->empty(jsonObject.value(MediaKeys::Title).toString(),
+                                        jsonObject.value(MediaKeys::Year).toInt());
+    media->differisci(jsonObject);
+    return media;
 }
 
 Media *MediaFactory::createMedia(const QString &type, const QString &title, int year)
 {
     validateCommonData(title, year);
 
-    if (type == "Book")
-    {
-        return new Book(title, year, "", "", "");
-    }
-    else if (type == "Film")
-    {
-        return new Film(title, year, "", 0, "");
-    }
-    else if (type == "MagazineArticle")
-    {
-        return new MagazineArticle(title, year, "", "", "");
-    }
-    else
+    Media *media = MediaTypeRegistry::instance().createEmpty(type, title, year);
+    if (!media)
     {
         throw InvalidDataException("Tipo media non supportato: " + type.toStdString());
     }
+    return media;
 }
 
 bool MediaFactory::isValidType(const QString &type)
 {
-    return getSupportedTypes().contains(type);
+    return MediaTypeRegistry::instance().contains(type);
 }
 
 QStringList MediaFactory::getSupportedTypes()
 {
-    return QStringList() << "Book" << "Film" << "MagazineArticle";
+    return MediaTypeRegistry::instance().tags();
 }
 
 void MediaFactory::validateBookData(const QString &title, int year, const QString &author,
                                     const QString &isbn, const QString &publisher)
 {
-    validateCommonData(title, year);
+    tryValidateBookData(title, year, author, isbn, publisher).orThrow();
+}
+
+void MediaFactory::validateFilmData(const QString &title, int year, const QString &director,
+                                    int duration, const QString &genre)
+{
+    tryValidateFilmData(title, year, director, duration, genre).orThrow();
+}
+
+void MediaFactory::validateMagazineData(const QString &title, int year, const QString &author,
+                                        const QString &magazine, const QString &doi)
+{
+    tryValidateMagazineData(title, year, author, magazine, doi).orThrow();
+}
+
+void MediaFactory::validateCommonData(const QString &title, int year)
+{
+    tryValidateCommonData(title, year).orThrow();
+}
+
+Result<void> MediaFactory::tryValidateBookData(const QString &title, int year, const QString &author,
+                                               const QString &isbn, const QString &publisher)
+{
+    Result<void> common = tryValidateCommonData(title, year);
+    if (!common)
+    {
+        return common;
+    }
 
     if (author.trimmed().isEmpty())
     {
-        throw InvalidDataException("Autore del libro non può essere vuoto");
+        return Error(ErrorCode::InvalidData, "Autore del libro non può essere vuoto");
     }
     if (isbn.trimmed().isEmpty())
     {
-        throw InvalidDataException("ISBN non può essere vuoto");
+        return Error(ErrorCode::InvalidData, "ISBN non può essere vuoto");
     }
     if (publisher.trimmed().isEmpty())
     {
-        throw InvalidDataException("Editore non può essere vuoto");
+        return Error(ErrorCode::InvalidData, "Editore non può essere vuoto");
     }
+    return Result<void>();
 }
 
-void MediaFactory::validateFilmData(const QString &title, int year, const QString &director,
-                                    int duration, const QString &genre)
+Result<void> MediaFactory::tryValidateFilmData(const QString &title, int year, const QString &director,
+                                               int duration, const QString &genre)
 {
-    validateCommonData(title, year);
+    Result<void> common = tryValidateCommonData(title, year);
+    if (!common)
+    {
+        return common;
+    }
 
     if (director.trimmed().isEmpty())
     {
-        throw InvalidDataException("Regista non può essere vuoto");
+        return Error(ErrorCode::InvalidData, "Regista non può essere vuoto");
     }
     if (duration <= 0)
     {
-        throw InvalidDataException("Durata deve essere maggiore di 0");
+        return Error(ErrorCode::InvalidData, "Durata deve essere maggiore di 0");
     }
     if (genre.trimmed().isEmpty())
     {
-        throw InvalidDataException("Genere non può essere vuoto");
+        return Error(ErrorCode::InvalidData, "Genere non può essere vuoto");
     }
+    return Result<void>();
 }
 
-void MediaFactory::validateMagazineData(const QString &title, int year, const QString &author,
-                                        const QString &magazine, const QString &doi)
+Result<void> MediaFactory::tryValidateMagazineData(const QString &title, int year, const QString &author,
+                                                   const QString &magazine, const QString &doi)
 {
-    validateCommonData(title, year);
+    Result<void> common = tryValidateCommonData(title, year);
+    if (!common)
+    {
+        return common;
+    }
 
     if (author.trimmed().isEmpty())
     {
-        throw InvalidDataException("Autore dell'articolo non può essere vuoto");
+        return Error(ErrorCode::InvalidData, "Autore dell'articolo non può essere vuoto");
     }
     if (magazine.trimmed().isEmpty())
     {
-        throw InvalidDataException("Nome della rivista non può essere vuoto");
+        return Error(ErrorCode::InvalidData, "Nome della rivista non può essere vuoto");
     }
     if (doi.trimmed().isEmpty())
     {
-        throw InvalidDataException("DOI non può essere vuoto");
+        return Error(ErrorCode::InvalidData, "DOI non può essere vuoto");
     }
+    return Result<void>();
 }
 
-void MediaFactory::validateCommonData(const QString &title, int year)
+Result<void> MediaFactory::tryValidateCommonData(const QString &title, int year)
 {
     if (title.trimmed().isEmpty())
     {
-        throw InvalidDataException("Titolo non può essere vuoto");
+        return Error(ErrorCode::InvalidData, "Titolo non può essere vuoto");
     }
     if (year < 1000 || year > 2025)
     {
-        throw InvalidDataException("Anno deve essere compreso tra 1000 e 2025");
+        return Error(ErrorCode::InvalidData, "Anno deve essere compreso tra 1000 e 2025");
     }
+    return Result<void>();
 }
@@ -8,6 +8,7 @@
 #include "Film.h"
 #include "MagazineArticle.h"
 #include "Exceptions.h"
+#include "Result.h"
 
 class MediaFactory
 {
@@ -25,8 +26,23 @@ public:
                                         const QString &magazine, const QString &doi,
                                         const QString &coverImagePath = "");
 
+    // Varianti senza eccezioni con la stessa validazione, per le importazioni in blocco
+    static Result<Media *> tryCreateBook(const QString &title, int year, const QString &author,
+                                         const QString &isbn, const QString &publisher,
+                                         const QString &coverImagePath = "");
+    static Result<Media *> tryCreateFilm(const QString &title, int year, const QString &director,
+                                         int duration, const QString &genre,
+                                         const QString &coverImagePath = "");
+    static Result<Media *> tryCreateMagazineArticle(const QString &title, int year, const QString &author,
+                                                    const QString &magazine, const QString &doi,
+                                                    const QString &coverImagePath = "");
+
     // Crea un Media da JSON (per deserializzazione)
     static Media *createFromJson(const QJsonObject &jsonObject);
+    // Variante senza eccezioni, per i cicli di importazione su dati non affidabili
+    static Result<Media *> tryCreateFromJson(const QJsonObject &jsonObject);
+    // Caricamento differito: vedi Media::differisci()
+    static Result<Media *> tryCreateDeferredFromJson(const QJsonObject &jsonObject);
 
     // Crea un Media da tipo stringa e parametri base
     static Media *createMedia(const QString &type, const QString &title, int year);
@@ -35,6 +51,15 @@ public:
     static bool isValidType(const QString &type);
     static QStringList getSupportedTypes();
 
+    // Validazione senza eccezioni: il primo campo non valido viene restituito come Error
+    static Result<void> tryValidateBookData(const QString &title, int year, const QString &author,
+                                            const QString &isbn, const QString &publisher);
+    static Result<void> tryValidateFilmData(const QString &title, int year, const QString &director,
+                                            int duration, const QString &genre);
+    static Result<void> tryValidateMagazineData(const QString &title, int year, const QString &author,
+                                                const QString &magazine, const QString &doi);
+    static Result<void> tryValidateCommonData(const QString &title, int year);
+
 private:
     MediaFactory() = default; // Factory non deve essere istanziata
 
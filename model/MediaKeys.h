@@ -0,0 +1,45 @@
+#ifndef MEDIAKEYS_H
+#define MEDIAKEYS_H
+
+#include <QLatin1String>
+
+/**
+ * MediaKeys - Chiavi JSON condivise da serializzazione e deserializzazione
+ *
+ * QJsonObject (Qt 5) memorizza le chiavi ordinate e le cerca per confronto:
+ * un letterale come jsonObject["title"] costruisce ogni volta un QString
+ * temporaneo convertendo da UTF-8. Queste costanti QLatin1String sono costruite
+ * a tempo di compilazione e vengono confrontate direttamente con le chiavi
+ * memorizzate, senza allocazioni né conversioni per record.
+ */
+namespace MediaKeys
+{
+    // La lunghezza viene dal tipo dell'array: il costruttore con dimensione è constexpr
+    // in tutte le versioni di Qt 5, a differenza di quello che usa strlen()
+    template <int N>
+    constexpr QLatin1String key(const char (&literal)[N])
+    {
+        return QLatin1String(literal, N - 1);
+    }
+
+    constexpr QLatin1String Type = key("type");
+    constexpr QLatin1String Title = key("title");
+    constexpr QLatin1String Year = key("year");
+    constexpr QLatin1String CoverImagePath = key("coverImagePath");
+
+    // Book
+    constexpr QLatin1String Author = key("author");
+    constexpr QLatin1String Isbn = key("isbn");
+    constexpr QLatin1String Publisher = key("publisher");
+
+    // Film
+    constexpr QLatin1String Director = key("director");
+    constexpr QLatin1String Duration = key("duration");
+    constexpr QLatin1String Genre = key("genre");
+
+    // MagazineArticle (usa anche Author)
+    constexpr QLatin1String Magazine = key("magazine");
+    constexpr QLatin1String Doi = key("doi");
+}
+
+#endif // MEDIAKEYS_H
@@ -0,0 +1,365 @@
+#ifndef MEDIASCHEMA_H
+#define MEDIASCHEMA_H
+
+#include <QString>
+#include <QList>
+#include <QVariant>
+#include <QJsonObject>
+#include <QDataStream>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Media.h"
+#include "Book.h"
+#include "Film.h"
+#include "MagazineArticle.h"
+#include "MediaKeys.h"
+#include "MediaVisitorT.h"
+
+/**
+ * MediaSchema - Descrizione a tempo di compilazione dei campi di ogni tipo di Media
+ *
+ * Ogni campo è descritto da chiave JSON, etichetta, getter/setter (puntatori a membro)
+ * ed eventuali ruoli. Serializzazione JSON e binaria, testo dei dettagli, comparatori
+ * ed estrazione delle chiavi di indicizzazione sono generati dai template di questo file:
+ * il ciclo sui campi viene espanso dal compilatore, senza chiamate virtuali per campo
+ * né ricerche per nome. Un nuovo campo aggiunto allo schema raggiunge così tutti i
+ * sottosistemi (persistenza, UI, deduplicazione) in un solo punto.
+ */
+namespace Schema
+{
+    enum class FieldKind
+    {
+        Text,
+        Integer
+    };
+
+    // Ruoli usati dagli indici (combinabili)
+    enum FieldRole
+    {
+        NoRole = 0,
+        IsbnRole = 1,   // identificativo ISBN
+        DoiRole = 2,    // identificativo DOI
+        CreatorRole = 4 // autore o regista
+    };
+
+    template <typename Getter>
+    struct GetterTraits;
+
+    template <typename Class, typename Result>
+    struct GetterTraits<Result (Class::*)() const>
+    {
+        using Return = Result;
+        using Value = std::decay_t<Result>;
+    };
+
+    template <typename Getter, typename Setter>
+    struct Field
+    {
+        using Value = typename GetterTraits<Getter>::Value;
+        static constexpr FieldKind kind = std::is_same<Value, int>::value ? FieldKind::Integer : FieldKind::Text;
+
+        QLatin1String key;
+        const char *label;
+        Getter get;
+        Setter set;
+        int roles;
+        int minimum;
+        int maximum;
+        const char *suffix;
+
+        // Per i campi testuali è un riferimento al membro: nessuna copia della stringa
+        template <typename T>
+        typename GetterTraits<Getter>::Return read(const T &media) const { return (media.*get)(); }
+
+        template <typename T>
+        void write(T &media, const Value &value) const { (media.*set)(value); }
+    };
+
+    template <typename Getter, typename Setter>
+    constexpr Field<Getter, Setter> text(QLatin1String key, const char *label, Getter get, Setter set,
+                                         int roles = NoRole)
+    {
+        return {key, label, get, set, roles, 0, 0, ""};
+    }
+
+    template <typename Getter, typename Setter>
+    constexpr Field<Getter, Setter> integer(QLatin1String key, const char *label, Getter get, Setter set,
+                                            int minimum, int maximum, const char *suffix = "")
+    {
+        return {key, label, get, set, NoRole, minimum, maximum, suffix};
+    }
+
+    // Campi comuni a tutti i Media
+    constexpr auto commonFields = std::make_tuple(
+        text(MediaKeys::Title, "Titolo", &Media::getTitleRef, &Media::setTitle),
+        integer(MediaKeys::Year, "Anno", &Media::getYear, &Media::setYear, 1000, 2100),
+        text(MediaKeys::CoverImagePath, "Copertina", &Media::getCoverImagePathRef, &Media::setCoverImagePath));
+
+    // Campi specifici: una specializzazione per ogni tipo concreto
+    template <typename T>
+    struct MediaSchema;
+
+    template <>
+    struct MediaSchema<Book>
+    {
+        static constexpr const char *label = "Libro";
+        static constexpr auto fields = std::make_tuple(
+            text(MediaKeys::Author, "Autore", &Book::getAuthorRef, &Book::setAuthor, CreatorRole),
+            text(MediaKeys::Isbn, "ISBN", &Book::getIsbnRef, &Book::setIsbn, IsbnRole),
+            text(MediaKeys::Publisher, "Editore", &Book::getPublisherRef, &Book::setPublisher));
+    };
+
+    template <>
+    struct MediaSchema<Film>
+    {
+        static constexpr const char *label = "Film";
+        static constexpr auto fields = std::make_tuple(
+            text(MediaKeys::Director, "Regista", &Film::getDirectorRef, &Film::setDirector, CreatorRole),
+            integer(MediaKeys::Duration, "Durata", &Film::getDuration, &Film::setDuration, 1, 1000, " min"),
+            text(MediaKeys::Genre, "Genere", &Film::getGenreRef, &Film::setGenre));
+    };
+
+    template <>
+    struct MediaSchema<MagazineArticle>
+    {
+        static constexpr const char *label = "Articolo";
+        static constexpr auto fields = std::make_tuple(
+            text(MediaKeys::Author, "Autore", &MagazineArticle::getAuthorRef, &MagazineArticle::setAuthor, CreatorRole),
+            text(MediaKeys::Magazine, "Rivista", &MagazineArticle::getMagazineRef, &MagazineArticle::setMagazine),
+            text(MediaKeys::Doi, "DOI", &MagazineArticle::getDoiRef, &MagazineArticle::setDoi, DoiRole));
+    };
+
+    // Applica visit a ogni elemento di una tupla di campi (espanso a tempo di compilazione)
+    template <typename Tuple, typename Visit>
+    void forEach(const Tuple &fields, Visit &&visit)
+    {
+        std::apply([&visit](const auto &...field)
+                   { (visit(field), ...); },
+                   fields);
+    }
+
+    // Tutti i campi di T: prima i comuni, poi gli specifici
+    template <typename T, typename Visit>
+    void forEachField(Visit &&visit)
+    {
+        forEach(commonFields, visit);
+        forEach(MediaSchema<T>::fields, visit);
+    }
+
+    template <typename FieldT>
+    typename FieldT::Value fromJsonValue(const FieldT &, const QJsonValue &value)
+    {
+        if constexpr (FieldT::kind == FieldKind::Integer)
+        {
+            return value.toInt();
+        }
+        else
+        {
+            return value.toString();
+        }
+    }
+
+    template <typename T>
+    QJsonObject toJson(const T &media)
+    {
+        QJsonObject jsonObject;
+        jsonObject[MediaKeys::Type] = QLatin1String(T::TypeTag);
+        forEachField<T>([&](const auto &field)
+                        { jsonObject[field.key] = field.read(media); });
+        return jsonObject;
+    }
+
+    template <typename T>
+    T *fromJson(const QJsonObject &jsonObject)
+    {
+        T *media = static_cast<T *>(T::createEmpty(QString(), 0));
+        forEachField<T>([&](const auto &field)
+                        { field.write(*media, fromJsonValue(field, jsonObject.value(field.key))); });
+        return media;
+    }
+
+    // Campi diversi da titolo e anno, per i Media caricati in modalità differita
+    template <typename T>
+    void fromJsonDeferred(T &media, const QJsonObject &jsonObject)
+    {
+        forEachField<T>([&](const auto &field)
+                        {
+                            if (field.key != MediaKeys::Title && field.key != MediaKeys::Year)
+                            {
+                                field.write(media, fromJsonValue(field, jsonObject.value(field.key)));
+                            } });
+    }
+
+    // Formato binario compatto: i campi in ordine di schema, senza chiavi
+    template <typename T>
+    void writeBinary(QDataStream &out, const T &media)
+    {
+        forEachField<T>([&](const auto &field)
+                        {
+                            if constexpr (std::decay_t<decltype(field)>::kind == FieldKind::Integer)
+                            {
+                                out << qint32(field.read(media));
+                            }
+                            else
+                            {
+                                out << field.read(media);
+                            } });
+    }
+
+    template <typename T>
+    T *readBinary(QDataStream &in)
+    {
+        T *media = static_cast<T *>(T::createEmpty(QString(), 0));
+        forEachField<T>([&](const auto &field)
+                        {
+                            if constexpr (std::decay_t<decltype(field)>::kind == FieldKind::Integer)
+                            {
+                                qint32 value = 0;
+                                in >> value;
+                                field.write(*media, int(value));
+                            }
+                            else
+                            {
+                                QString value;
+                                in >> value;
+                                field.write(*media, value);
+                            } });
+        return media;
+    }
+
+    // Testo di visualizzaDettagli(): intestazione, campi specifici e copertina
+    template <typename T>
+    QString describe(const T &media)
+    {
+        QString result = QString::fromLatin1(MediaSchema<T>::label);
+        result += QLatin1String(": ") + media.getTitleRef();
+        result += QLatin1String(" (") + QString::number(media.getYear()) + QLatin1Char(')');
+        forEach(MediaSchema<T>::fields, [&](const auto &field)
+                {
+                    result += QLatin1Char('\n');
+                    result += QLatin1String(field.label);
+                    result += QLatin1String(": ");
+                    if constexpr (std::decay_t<decltype(field)>::kind == FieldKind::Integer)
+                    {
+                        result += QString::number(field.read(media));
+                    }
+                    else
+                    {
+                        result += field.read(media);
+                    }
+                    result += QLatin1String(field.suffix); });
+        result += QLatin1String("\nCopertina: ") + media.getCoverImagePathRef();
+        return result;
+    }
+
+    // Confronto a tre vie sul campo con la chiave indicata (0 se la chiave è sconosciuta)
+    template <typename T>
+    int compare(const T &a, const T &b, QLatin1String key)
+    {
+        int result = 0;
+        forEachField<T>([&](const auto &field)
+                        {
+                            if (field.key != key)
+                            {
+                                return;
+                            }
+                            const auto &left = field.read(a);
+                            const auto &right = field.read(b);
+                            result = left < right ? -1 : (right < left ? 1 : 0); });
+        return result;
+    }
+
+    // Comparatore per std::sort su un campo scelto a tempo di compilazione
+    template <typename T, std::size_t Index>
+    struct FieldLess
+    {
+        bool operator()(const T *a, const T *b) const
+        {
+            const auto &field = std::get<Index>(MediaSchema<T>::fields);
+            return field.read(*a) < field.read(*b);
+        }
+    };
+
+    // Valore del primo campo con il ruolo indicato (stringa vuota se nessuno), senza copia
+    template <typename T>
+    const QString &valueWithRole(const T &media, int role)
+    {
+        static const QString empty;
+        const QString *result = &empty;
+        forEach(MediaSchema<T>::fields, [&](const auto &field)
+                {
+                    if constexpr (std::decay_t<decltype(field)>::kind == FieldKind::Text)
+                    {
+                        if (result == &empty && (field.roles & role))
+                        {
+                            result = &field.read(media);
+                        }
+                    } });
+        return *result;
+    }
+
+    /**
+     * Descrittore a runtime di un campo specifico, per costruire form e tabelle.
+     * Non è usato sui percorsi caldi: l'accesso passa per std::function e QVariant.
+     */
+    struct FieldInfo
+    {
+        QLatin1String key;
+        QString label;
+        FieldKind kind;
+        int minimum;
+        int maximum;
+        QString suffix;
+        std::function<QVariant(const Media *)> read;
+        std::function<void(Media *, const QVariant &)> write;
+    };
+
+    template <typename T>
+    QList<FieldInfo> fieldInfos()
+    {
+        QList<FieldInfo> result;
+        forEach(MediaSchema<T>::fields, [&result](const auto &field)
+                {
+                    using FieldT = std::decay_t<decltype(field)>;
+                    const FieldT copy = field;
+                    FieldInfo info{field.key, QString::fromUtf8(field.label), FieldT::kind,
+                                   field.minimum, field.maximum, QString::fromUtf8(field.suffix),
+                                   [copy](const Media *media)
+                                   { return QVariant(copy.read(*static_cast<const T *>(media))); },
+                                   [copy](Media *media, const QVariant &value)
+                                   { copy.write(*static_cast<T *>(media), value.value<typename FieldT::Value>()); }};
+                    result.append(info); });
+        return result;
+    }
+
+    // Adatta una lambda generica ai tre overload di visit richiesti da visitMedia
+    template <typename Visit>
+    struct Dispatcher
+    {
+        Visit &callback;
+
+        void visit(Book &book) { callback(book); }
+        void visit(Film &film) { callback(film); }
+        void visit(MagazineArticle &article) { callback(article); }
+    };
+
+    // Invoca visit con il tipo concreto del Media (smistamento statico)
+    template <typename Visit>
+    void dispatch(Media &media, Visit visit)
+    {
+        visitMedia(Dispatcher<Visit>{visit}, media);
+    }
+
+    // Campi specifici del tipo concreto di media
+    inline QList<FieldInfo> fieldInfosFor(Media &media)
+    {
+        QList<FieldInfo> result;
+        dispatch(media, [&result](auto &concrete)
+                 { result = fieldInfos<std::decay_t<decltype(concrete)>>(); });
+        return result;
+    }
+}
+
+#endif // MEDIASCHEMA_H
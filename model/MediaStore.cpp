@@ -0,0 +1,46 @@
+#include "MediaStore.h"
+#include "MediaSchema.h"
+
+/**
+ * Costruisce l'archivio copiando i Media nell'ordine indicato.
+ * @param media Media da copiare (i puntatori restano di proprietà del chiamante)
+ * @return Archivio con un valore per ogni Media non nullo
+ */
+MediaStore MediaStore::fromMedia(const QList<Media *> &media)
+{
+    MediaStore store;
+    store.values.reserve(std::size_t(media.size()));
+    for (Media *item : media)
+    {
+        if (item)
+        {
+            store.append(*item);
+        }
+    }
+    return store;
+}
+
+void MediaStore::append(Media &media)
+{
+    Schema::dispatch(media, [this](const auto &concrete)
+                     { values.emplace_back(concrete); });
+}
+
+const Media &MediaStore::asMedia(const MediaValue &value)
+{
+    return std::visit([](const auto &concrete) -> const Media &
+                      { return concrete; },
+                      value);
+}
+
+/**
+ * Serializza tutti i valori nel formato di JsonSerializer.
+ * Lo schema del tipo concreto è noto a tempo di compilazione in ogni ramo di std::visit.
+ */
+QJsonArray MediaStore::toJson() const
+{
+    QJsonArray array;
+    forEach([&array](const auto &concrete)
+            { array.append(Schema::toJson(concrete)); });
+    return array;
+}
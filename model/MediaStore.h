@@ -0,0 +1,69 @@
+#ifndef MEDIASTORE_H
+#define MEDIASTORE_H
+
+#include <QList>
+#include <QJsonArray>
+#include <variant>
+#include <vector>
+#include "Book.h"
+#include "Film.h"
+#include "MagazineArticle.h"
+
+// Un Media memorizzato per valore: la gerarchia è chiusa, quindi basta un variant
+using MediaValue = std::variant<Book, Film, MagazineArticle>;
+
+// Combina più lambda in un unico visitatore per std::visit
+template <typename... Handlers>
+struct Overloaded : Handlers...
+{
+    using Handlers::operator()...;
+};
+template <typename... Handlers>
+Overloaded(Handlers...) -> Overloaded<Handlers...>;
+
+/**
+ * MediaStore - Archivio contiguo dei Media per valore
+ *
+ * Copia compatta del container di puntatori: tutti i Media stanno in un unico
+ * vettore di std::variant, nello stesso ordine degli slot della Biblioteca.
+ * È l'istantanea usata dai salvataggi (Biblioteca::istantanea()), costruita a
+ * ogni richiesta e indipendente dalla biblioteca.
+ * Le scansioni usano std::visit, che seleziona il tipo concreto con un salto su
+ * indice e permette al compilatore di espandere le chiamate (nessuna chiamata
+ * virtuale, nessun salto tra oggetti sparsi nello heap).
+ */
+class MediaStore
+{
+public:
+    MediaStore() = default;
+
+    // Copia i Media indicati (una sola visita virtuale per elemento)
+    static MediaStore fromMedia(const QList<Media *> &media);
+
+    int size() const { return int(values.size()); }
+    bool isEmpty() const { return values.empty(); }
+    const MediaValue &at(int slot) const { return values[std::size_t(slot)]; }
+
+    // Vista del valore come Media, per il codice che lavora sull'interfaccia comune
+    static const Media &asMedia(const MediaValue &value);
+
+    // Applica visit al valore concreto di ogni slot, in ordine
+    template <typename Visit>
+    void forEach(Visit visit) const
+    {
+        for (const MediaValue &value : values)
+        {
+            std::visit(visit, value);
+        }
+    }
+
+    // Serializzazione senza chiamate virtuali
+    QJsonArray toJson() const;
+
+private:
+    void append(Media &media);
+
+    std::vector<MediaValue> values;
+};
+
+#endif // MEDIASTORE_H
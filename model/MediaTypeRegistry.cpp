@@ -0,0 +1,143 @@
+#include "MediaTypeRegistry.h"
+#include "Media.h"
+
+/**
+ * Calcola l'hash FNV-1a di un tag letto dal JSON.
+ * Produce lo stesso valore di hashTag(const char *) per i tag ASCII.
+ */
+quint32 MediaTypeRegistry::hashTag(const QString &tag)
+{
+    quint32 hash = 2166136261u;
+    for (const QChar c : tag)
+    {
+        hash = (hash ^ quint32(c.unicode())) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Istanza unica del registro.
+ * Costruita al primo utilizzo, quindi disponibile anche durante l'inizializzazione
+ * statica dei MediaTypeRegistrar nelle altre unità di traduzione.
+ */
+MediaTypeRegistry &MediaTypeRegistry::instance()
+{
+    static MediaTypeRegistry registry;
+    return registry;
+}
+
+/**
+ * Registra un tipo di Media con le relative factory.
+ * Se il nuovo tag collide con una cella già occupata, la tabella viene ricostruita
+ * con un altro seme finché tutti i tag occupano celle distinte.
+ * @param tag Tag JSON del tipo (letterale con durata statica)
+ * @return true se la registrazione è andata a buon fine
+ */
+bool MediaTypeRegistry::registerType(const char *tag, JsonFactory fromJson, EmptyFactory empty)
+{
+    if (!tag || !fromJson || count >= TableSize || contains(QString::fromLatin1(tag)))
+    {
+        return false;
+    }
+
+    QList<Entry> entries;
+    for (const Entry &entry : table)
+    {
+        if (entry.tag)
+        {
+            entries.append(entry);
+        }
+    }
+
+    Entry nuova;
+    nuova.tag = tag;
+    nuova.hash = hashTag(tag);
+    nuova.fromJson = fromJson;
+    nuova.empty = empty;
+    entries.append(nuova);
+
+    if (!rebuild(entries))
+    {
+        return false;
+    }
+    ++count;
+    return true;
+}
+
+const MediaTypeRegistry::Entry *MediaTypeRegistry::find(const QString &tag) const
+{
+    if (count == 0)
+    {
+        return nullptr;
+    }
+    const Entry &entry = table[slotFor(hashTag(tag), seed)];
+    // Un solo confronto di conferma: la cella è l'unica candidata possibile
+    if (!entry.tag || tag != QLatin1String(entry.tag))
+    {
+        return nullptr;
+    }
+    return &entry;
+}
+
+Media *MediaTypeRegistry::createFromJson(const QString &tag, const QJsonObject &jsonObject) const
+{
+    const Entry *entry = find(tag);
+    return entry ? entry->fromJson(jsonObject) : nullptr;
+}
+
+Media *MediaTypeRegistry::createEmpty(const QString &tag, const QString &title, int year) const
+{
+    const Entry *entry = find(tag);
+    return entry && entry->empty ? entry->empty(title, year) : nullptr;
+}
+
+QStringList MediaTypeRegistry::tags() const
+{
+    QStringList result;
+    for (const Entry &entry : table)
+    {
+        if (entry.tag)
+        {
+            result.append(QString::fromLatin1(entry.tag));
+        }
+    }
+    result.sort();
+    return result;
+}
+
+int MediaTypeRegistry::slotFor(quint32 hash, quint32 seed)
+{
+    // Rimescolamento moltiplicativo: il seme cambia la distribuzione delle celle
+    const quint32 mixed = (hash ^ seed) * 0x9E3779B1u;
+    return int(mixed >> 27) & (TableSize - 1);
+}
+
+/**
+ * Cerca un seme per cui tutte le voci cadono in celle distinte e ripopola la tabella.
+ * Con poche voci e 32 celle un seme valido si trova in pochi tentativi.
+ */
+bool MediaTypeRegistry::rebuild(const QList<Entry> &entries)
+{
+    for (quint32 candidate = 0; candidate < quint32(MaxSeedAttempts); ++candidate)
+    {
+        std::array<Entry, TableSize> nuovaTabella{};
+        bool perfetta = true;
+        for (const Entry &entry : entries)
+        {
+            Entry &cella = nuovaTabella[slotFor(entry.hash, candidate)];
+            if (cella.tag)
+            {
+                perfetta = false;
+                break;
+            }
+            cella = entry;
+        }
+        if (perfetta)
+        {
+            table = nuovaTabella;
+            seed = candidate;
+            return true;
+        }
+    }
+    return false;
+}
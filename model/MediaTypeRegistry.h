@@ -0,0 +1,101 @@
+#ifndef MEDIATYPEREGISTRY_H
+#define MEDIATYPEREGISTRY_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QJsonObject>
+#include <array>
+
+class Media;
+
+/**
+ * MediaTypeRegistry - Tabella dei tipi di Media indicizzata per tag
+ *
+ * Ogni sottoclasse di Media si registra con il proprio tag JSON ("Book", "Film", ...)
+ * tramite un oggetto MediaTypeRegistrar nel proprio file .cpp: aggiungere un tipo
+ * non richiede modifiche a MediaFactory.
+ *
+ * Il tag viene ridotto a un hash FNV-1a (calcolabile a tempo di compilazione per i
+ * letterali). La tabella ha dimensione fissa e, a ogni registrazione, viene scelto un
+ * seme per cui tutti i tag registrati cadono in celle distinte (hashing perfetto):
+ * la ricerca costa un hash, un accesso alla tabella e un solo confronto di conferma,
+ * invece di una catena di confronti tra stringhe.
+ */
+class MediaTypeRegistry
+{
+public:
+    using JsonFactory = Media *(*)(const QJsonObject &jsonObject);
+    using EmptyFactory = Media *(*)(const QString &title, int year);
+
+    struct Entry
+    {
+        const char *tag = nullptr;
+        quint32 hash = 0;
+        JsonFactory fromJson = nullptr;
+        EmptyFactory empty = nullptr;
+    };
+
+    // Hash FNV-1a sulle unità di codice: per tag ASCII coincide tra char e QChar
+    static constexpr quint32 hashTag(const char *tag)
+    {
+        quint32 hash = 2166136261u;
+        for (; *tag; ++tag)
+        {
+            hash = (hash ^ quint32(quint8(*tag))) * 16777619u;
+        }
+        return hash;
+    }
+    static quint32 hashTag(const QString &tag);
+
+    static MediaTypeRegistry &instance();
+
+    // Registra un tipo; restituisce false se il tag è già registrato o la tabella è piena
+    bool registerType(const char *tag, JsonFactory fromJson, EmptyFactory empty);
+
+    // nullptr se il tag non è registrato
+    const Entry *find(const QString &tag) const;
+
+    Media *createFromJson(const QString &tag, const QJsonObject &jsonObject) const;
+    Media *createEmpty(const QString &tag, const QString &title, int year) const;
+
+    bool contains(const QString &tag) const { return find(tag) != nullptr; }
+    // Tag registrati, in ordine alfabetico
+    QStringList tags() const;
+
+private:
+    static constexpr int TableSize = 32; // potenza di 2
+    static constexpr int MaxSeedAttempts = 1024;
+
+    MediaTypeRegistry() = default;
+
+    static int slotFor(quint32 hash, quint32 seed);
+    bool rebuild(const QList<Entry> &entries);
+
+    std::array<Entry, TableSize> table{};
+    quint32 seed = 0;
+    int count = 0;
+};
+
+/**
+ * MediaTypeRegistrar - Registra un tipo di Media durante l'inizializzazione statica.
+ * Il tipo deve fornire static T *deserializza(const QJsonObject &) e un costruttore
+ * usabile con (title, year) tramite createEmpty.
+ */
+template <typename T>
+class MediaTypeRegistrar
+{
+public:
+    explicit MediaTypeRegistrar(const char *tag)
+    {
+        MediaTypeRegistry::instance().registerType(tag, &fromJson, &T::createEmpty);
+    }
+
+private:
+    static Media *fromJson(const QJsonObject &jsonObject)
+    {
+        return T::deserializza(jsonObject);
+    }
+};
+
+#endif // MEDIATYPEREGISTRY_H
@@ -1,7 +1,7 @@
 #ifndef MEDIAVISITOR_H
 #define MEDIAVISITOR_H
 
-#include <QWidget>
+class QWidget;
 
 class Book;
 class Film;
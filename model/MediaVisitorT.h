@@ -0,0 +1,95 @@
+#ifndef MEDIAVISITORT_H
+#define MEDIAVISITORT_H
+
+#include <type_traits>
+#include "Media.h"
+#include "Book.h"
+#include "Film.h"
+#include "MagazineArticle.h"
+
+/**
+ * MediaVisitorT - Visitor con valore di ritorno generico
+ *
+ * MediaVisitor restituisce QWidget* ed è pensato per la vista: gli attraversamenti
+ * del modello (raccolta, hashing, stima della memoria, indicizzazione) non devono
+ * dipendere da QtWidgets né restituire puntatori fittizi.
+ *
+ * Sono disponibili due meccanismi:
+ * - MediaVisitorT<R>: visitor polimorfo, per visitor estendibili o memorizzati
+ *   tramite puntatore alla base. Media::accept<R>() smista con il tag MediaKind
+ *   memorizzato nella base, quindi costa una sola chiamata virtuale (visit).
+ * - StaticMediaVisitor<Derived, R> e visitMedia(): smistamento statico (CRTP) per i
+ *   cicli caldi. Lo switch sul tag seleziona il metodo visit del tipo concreto a
+ *   tempo di compilazione: nessuna chiamata virtuale, il corpo può essere espanso
+ *   inline e non serve alcuna allocazione.
+ */
+template <typename R>
+class MediaVisitorT
+{
+public:
+    virtual ~MediaVisitorT() = default;
+    virtual R visit(Book &book) = 0;
+    virtual R visit(Film &film) = 0;
+    virtual R visit(MagazineArticle &article) = 0;
+};
+
+namespace MediaDispatch
+{
+    // Concrete con la stessa costanza di MediaT (Media oppure const Media)
+    template <typename MediaT, typename Concrete>
+    using Like = std::conditional_t<std::is_const<MediaT>::value, const Concrete, Concrete>;
+}
+
+/**
+ * Invoca visitor.visit() con il tipo concreto di media.
+ * Funziona con qualsiasi oggetto che offra i tre overload di visit, anche const.
+ */
+template <typename Visitor, typename MediaT>
+decltype(auto) visitMedia(Visitor &&visitor, MediaT &concrete)
+{
+    static_assert(std::is_base_of<Media, std::remove_const_t<MediaT>>::value,
+                  "visitMedia richiede un Media");
+    MediaDispatch::Like<MediaT, Media> &media = concrete;
+    switch (media.tipo())
+    {
+    case MediaKind::Film:
+        return visitor.visit(static_cast<MediaDispatch::Like<MediaT, Film> &>(media));
+    case MediaKind::MagazineArticle:
+        return visitor.visit(static_cast<MediaDispatch::Like<MediaT, MagazineArticle> &>(media));
+    case MediaKind::Book:
+        break;
+    }
+    return visitor.visit(static_cast<MediaDispatch::Like<MediaT, Book> &>(media));
+}
+
+/**
+ * Base CRTP per visitor a smistamento statico.
+ * Derived definisce visit(Book&), visit(Film&), visit(MagazineArticle&)
+ * (o le versioni const) e li applica con apply().
+ */
+template <typename Derived, typename R = void>
+class StaticMediaVisitor
+{
+public:
+    R apply(Media &media)
+    {
+        return visitMedia(static_cast<Derived &>(*this), media);
+    }
+
+    R apply(const Media &media)
+    {
+        return visitMedia(static_cast<Derived &>(*this), media);
+    }
+
+protected:
+    StaticMediaVisitor() = default;
+    ~StaticMediaVisitor() = default;
+};
+
+template <typename R>
+R Media::accept(MediaVisitorT<R> &visitor)
+{
+    return visitMedia(visitor, *this);
+}
+
+#endif // MEDIAVISITORT_H
@@ -0,0 +1,133 @@
+#include "MemoryFootprintVisitor.h"
+#include "MediaKeys.h"
+
+namespace
+{
+    // Campi testuali per tipo, nell'ordine in cui il visitor li passa a conta()
+    const QLatin1String CampiLibro[] = {MediaKeys::Title, MediaKeys::CoverImagePath,
+                                        MediaKeys::Author, MediaKeys::Isbn, MediaKeys::Publisher};
+    const QLatin1String CampiFilm[] = {MediaKeys::Title, MediaKeys::CoverImagePath,
+                                       MediaKeys::Director, MediaKeys::Genre};
+    const QLatin1String CampiArticolo[] = {MediaKeys::Title, MediaKeys::CoverImagePath,
+                                           MediaKeys::Author, MediaKeys::Magazine, MediaKeys::Doi};
+
+    const QString VoceOggetto = QStringLiteral("oggetto");
+    const QString VoceDifferiti = QStringLiteral("differiti");
+}
+
+MemoryFootprintVisitor::MemoryFootprintVisitor(MemoryReport &report, bool contaOggetti)
+    : report(report), contaOggetti(contaOggetti),
+      libri{Book::TypeTag, CampiLibro, 5},
+      film{Film::TypeTag, CampiFilm, 4},
+      articoli{MagazineArticle::TypeTag, CampiArticolo, 5} {}
+
+MemoryFootprintVisitor::~MemoryFootprintVisitor()
+{
+    flush();
+}
+
+// I Media differiti vengono contati senza materializzarli: solo il titolo è già decodificato
+
+void MemoryFootprintVisitor::visit(const Book &book)
+{
+    if (book.campiDifferiti())
+    {
+        contaDifferito(libri, sizeof(Book), book.getTitleRef());
+        return;
+    }
+    conta(libri, sizeof(Book),
+          {book.getTitleRef(), book.getCoverImagePathRef(), book.getAuthorRef(), book.getIsbnRef(), book.getPublisherRef()});
+}
+
+void MemoryFootprintVisitor::visit(const Film &film)
+{
+    if (film.campiDifferiti())
+    {
+        contaDifferito(this->film, sizeof(Film), film.getTitleRef());
+        return;
+    }
+    conta(this->film, sizeof(Film),
+          {film.getTitleRef(), film.getCoverImagePathRef(), film.getDirectorRef(), film.getGenreRef()});
+}
+
+void MemoryFootprintVisitor::visit(const MagazineArticle &article)
+{
+    if (article.campiDifferiti())
+    {
+        contaDifferito(articoli, sizeof(MagazineArticle), article.getTitleRef());
+        return;
+    }
+    conta(articoli, sizeof(MagazineArticle),
+          {article.getTitleRef(), article.getCoverImagePathRef(), article.getAuthorRef(), article.getMagazineRef(), article.getDoiRef()});
+}
+
+void MemoryFootprintVisitor::conta(Accumulo &accumulo, qint64 dimensione, std::initializer_list<std::reference_wrapper<const QString>> valori)
+{
+    if (contaOggetti)
+    {
+        ++accumulo.oggetti;
+        accumulo.byteOggetti += MemoryReport::allocationBytes(dimensione);
+    }
+    int campo = 0;
+    for (const QString &valore : valori)
+    {
+        ++accumulo.stringhe[campo];
+        accumulo.byteStringhe[campo] += report.uniqueStringBytes(valore);
+        ++campo;
+    }
+}
+
+void MemoryFootprintVisitor::contaDifferito(Accumulo &accumulo, qint64 dimensione, const QString &titolo)
+{
+    conta(accumulo, dimensione, {titolo});
+    ++accumulo.differiti;
+}
+
+void MemoryFootprintVisitor::flush()
+{
+    flush(libri);
+    flush(film);
+    flush(articoli);
+}
+
+void MemoryFootprintVisitor::flush(Accumulo &accumulo)
+{
+    const QString tipo = QLatin1String(accumulo.tipo);
+    if (accumulo.oggetti > 0)
+    {
+        report.add(tipo, VoceOggetto, accumulo.byteOggetti, accumulo.oggetti);
+    }
+    if (accumulo.differiti > 0)
+    {
+        // Nessun byte proprio: i record sono nel documento JSON condiviso
+        report.add(tipo, VoceDifferiti, 0, accumulo.differiti);
+    }
+    for (int campo = 0; campo < accumulo.numeroCampi; ++campo)
+    {
+        if (accumulo.stringhe[campo] > 0)
+        {
+            report.addStrings(tipo, accumulo.campi[campo], accumulo.byteStringhe[campo], accumulo.stringhe[campo]);
+        }
+        accumulo.stringhe[campo] = 0;
+        accumulo.byteStringhe[campo] = 0;
+    }
+    accumulo.oggetti = 0;
+    accumulo.byteOggetti = 0;
+    accumulo.differiti = 0;
+}
+
+/**
+ * Memoria stimata del Media: oggetto e buffer dei campi testuali.
+ * Le stringhe condivise con altri Media sono comunque contate per intero,
+ * perché il report è limitato a questo oggetto.
+ * @return Byte stimati nello heap
+ */
+qint64 Media::memoryFootprint() const
+{
+    MemoryReport report;
+    {
+        MemoryFootprintVisitor visitor(report);
+        visitor.apply(*this);
+    }
+    return report.total();
+}
@@ -0,0 +1,67 @@
+#ifndef MEMORYFOOTPRINTVISITOR_H
+#define MEMORYFOOTPRINTVISITOR_H
+
+#include <QLatin1String>
+#include <functional>
+#include <initializer_list>
+#include "MediaVisitorT.h"
+#include "MemoryReport.h"
+
+/**
+ * MemoryFootprintVisitor - Visitor che stima la memoria dei Media visitati
+ *
+ * Per ogni tipo concreto conta l'oggetto (sizeof arrotondato dall'allocatore)
+ * e i buffer di ogni campo testuale. I totali sono accumulati nel visitor,
+ * senza cercare le voci del report per ogni Media, e scritti nel report da
+ * flush() o dal distruttore.
+ *
+ * Con contaOggetti = false vengono contate solo le stringhe: serve per i Media
+ * memorizzati per valore in un contenitore già contato (MediaStore).
+ *
+ * I Media differiti (Media::campiDifferiti()) non vengono materializzati: si
+ * contano oggetto e titolo, e il loro numero nella voce "differiti". Il
+ * documento JSON da cui leggeranno gli altri campi non è stimato.
+ */
+class MemoryFootprintVisitor : public StaticMediaVisitor<MemoryFootprintVisitor>
+{
+public:
+    explicit MemoryFootprintVisitor(MemoryReport &report, bool contaOggetti = true);
+    ~MemoryFootprintVisitor();
+
+    MemoryFootprintVisitor(const MemoryFootprintVisitor &) = delete;
+    MemoryFootprintVisitor &operator=(const MemoryFootprintVisitor &) = delete;
+
+    void visit(const Book &book);
+    void visit(const Film &film);
+    void visit(const MagazineArticle &article);
+
+    // Scrive nel report i totali accumulati e li azzera
+    void flush();
+
+private:
+    static constexpr int MaxCampi = 5;
+
+    struct Accumulo
+    {
+        const char *tipo;
+        const QLatin1String *campi;
+        int numeroCampi;
+        qint64 oggetti = 0;
+        qint64 byteOggetti = 0;
+        qint64 differiti = 0;
+        qint64 stringhe[MaxCampi] = {};
+        qint64 byteStringhe[MaxCampi] = {};
+    };
+
+    void conta(Accumulo &accumulo, qint64 dimensione, std::initializer_list<std::reference_wrapper<const QString>> valori);
+    void contaDifferito(Accumulo &accumulo, qint64 dimensione, const QString &titolo);
+    void flush(Accumulo &accumulo);
+
+    MemoryReport &report;
+    bool contaOggetti;
+    Accumulo libri;
+    Accumulo film;
+    Accumulo articoli;
+};
+
+#endif // MEMORYFOOTPRINTVISITOR_H
@@ -0,0 +1,147 @@
+#include "MemoryReport.h"
+#include <QStringList>
+
+/**
+ * Arrotondamento di malloc (glibc, 64 bit): 8 byte di intestazione per blocco,
+ * blocchi multipli di 16 byte e mai più piccoli di 32.
+ */
+qint64 MemoryReport::allocationBytes(qint64 requested)
+{
+    if (requested <= 0)
+    {
+        return 0;
+    }
+    return qMax(qint64(32), (requested + 8 + 15) & ~qint64(15));
+}
+
+/**
+ * Le stringhe null, vuote e i letterali QStringLiteral usano dati statici
+ * (capacità 0) e non occupano heap; le altre allocano intestazione, caratteri
+ * e terminatore.
+ */
+qint64 MemoryReport::stringBytes(const QString &value)
+{
+    if (value.capacity() == 0)
+    {
+        return 0;
+    }
+    return allocationBytes(qint64(sizeof(QArrayData)) + qint64(value.capacity() + 1) * qint64(sizeof(QChar)));
+}
+
+qint64 MemoryReport::arrayBytes(qint64 capacity, qint64 elementSize)
+{
+    return capacity > 0 ? allocationBytes(qint64(sizeof(QArrayData)) + capacity * elementSize) : 0;
+}
+
+void MemoryReport::add(const QString &category, const QString &entry, qint64 bytes, qint64 count)
+{
+    Entry &voce = voci[category][entry];
+    voce.bytes += bytes;
+    voce.count += count;
+}
+
+qint64 MemoryReport::uniqueStringBytes(const QString &value)
+{
+    const qint64 byte = stringBytes(value);
+    if (byte == 0)
+    {
+        return 0;
+    }
+    if (buffersVisti.contains(value.constData()))
+    {
+        condivise += byte;
+        return 0;
+    }
+    buffersVisti.insert(value.constData());
+    return byte;
+}
+
+void MemoryReport::addStrings(const QString &category, const QString &entry, qint64 bytes, qint64 count)
+{
+    add(category, entry, bytes, count);
+    stringhe += bytes;
+}
+
+qint64 MemoryReport::total() const
+{
+    qint64 totale = 0;
+    for (auto categoria = voci.constBegin(); categoria != voci.constEnd(); ++categoria)
+    {
+        totale += bytes(categoria.key());
+    }
+    return totale;
+}
+
+qint64 MemoryReport::bytes(const QString &category) const
+{
+    qint64 totale = 0;
+    const QMap<QString, Entry> voceCategoria = voci.value(category);
+    for (const Entry &voce : voceCategoria)
+    {
+        totale += voce.bytes;
+    }
+    return totale;
+}
+
+qint64 MemoryReport::bytes(const QString &category, const QString &entry) const
+{
+    return voci.value(category).value(entry).bytes;
+}
+
+QJsonObject MemoryReport::toJson() const
+{
+    QJsonObject categorie;
+    for (auto categoria = voci.constBegin(); categoria != voci.constEnd(); ++categoria)
+    {
+        QJsonObject voceJson;
+        for (auto voce = categoria.value().constBegin(); voce != categoria.value().constEnd(); ++voce)
+        {
+            QJsonObject dettaglio;
+            dettaglio["byte"] = voce.value().bytes;
+            dettaglio["numero"] = voce.value().count;
+            voceJson[voce.key()] = dettaglio;
+        }
+        categorie[categoria.key()] = voceJson;
+    }
+
+    QJsonObject json;
+    json["totale"] = total();
+    json["stringhe"] = stringhe;
+    json["stringheCondivise"] = condivise;
+    json["categorie"] = categorie;
+    return json;
+}
+
+QString MemoryReport::format() const
+{
+    const qint64 totale = total();
+    auto riga = [totale](const QString &nome, qint64 byte, qint64 numero)
+    {
+        const double percentuale = totale > 0 ? 100.0 * double(byte) / double(totale) : 0.0;
+        return QString("%1 %2 %3% %4")
+            .arg(nome, -32)
+            .arg(byte, 14)
+            .arg(percentuale, 6, 'f', 1)
+            .arg(numero, 10);
+    };
+
+    QStringList righe;
+    righe.append(QString("%1 %2 %3 %4").arg("voce", -32).arg("byte", 14).arg("quota", 7).arg("numero", 10));
+    for (auto categoria = voci.constBegin(); categoria != voci.constEnd(); ++categoria)
+    {
+        // Elementi della categoria: la voce più numerosa (di solito "oggetto")
+        qint64 numero = 0;
+        for (const Entry &voce : categoria.value())
+        {
+            numero = qMax(numero, voce.count);
+        }
+        righe.append(riga(categoria.key(), bytes(categoria.key()), numero));
+        for (auto voce = categoria.value().constBegin(); voce != categoria.value().constEnd(); ++voce)
+        {
+            righe.append(riga("  " + voce.key(), voce.value().bytes, voce.value().count));
+        }
+    }
+    righe.append(riga("totale", totale, 0));
+    righe.append(QString("stringhe: %1 byte, condivise non contate: %2 byte").arg(stringhe).arg(condivise));
+    return righe.join('\n');
+}
@@ -0,0 +1,64 @@
+#ifndef MEMORYREPORT_H
+#define MEMORYREPORT_H
+
+#include <QJsonObject>
+#include <QMap>
+#include <QSet>
+#include <QString>
+
+/**
+ * MemoryReport - Stima della memoria occupata, divisa per categoria e voce
+ *
+ * Le categorie sono i tipi concreti dei Media ("Book", "Film", ...) e le
+ * strutture della Biblioteca ("Biblioteca", "Indici"); le voci
+ * sono i campi (con le stesse chiavi del JSON) oppure "oggetto", "contenitore", ...
+ *
+ * Le stime seguono Qt 5 su piattaforme a 64 bit: ogni allocazione è arrotondata
+ * come fa malloc di glibc e i buffer delle QString includono l'intestazione
+ * QArrayData. Un buffer condiviso tra più QString (implicit sharing) è contato
+ * una sola volta per report, la prima volta che viene incontrato.
+ */
+class MemoryReport
+{
+public:
+    struct Entry
+    {
+        qint64 bytes = 0;
+        qint64 count = 0; // oggetti o stringhe contati nella voce
+    };
+
+    // Byte effettivamente riservati dall'allocatore per una richiesta di requested byte
+    static qint64 allocationBytes(qint64 requested);
+    // Byte nello heap del buffer di una QString (0 per stringhe null, vuote o letterali)
+    static qint64 stringBytes(const QString &value);
+    // Byte nello heap del buffer di un QVector (o altro QArrayData) di capacity elementi
+    static qint64 arrayBytes(qint64 capacity, qint64 elementSize);
+
+    void add(const QString &category, const QString &entry, qint64 bytes, qint64 count = 1);
+
+    // Byte del buffer della stringa se non è già stato contato, altrimenti 0
+    qint64 uniqueStringBytes(const QString &value);
+    // Come add(), ma la voce viene sommata anche al totale delle stringhe
+    void addStrings(const QString &category, const QString &entry, qint64 bytes, qint64 count);
+
+    qint64 total() const;
+    qint64 bytes(const QString &category) const;
+    qint64 bytes(const QString &category, const QString &entry) const;
+    qint64 stringBytesTotal() const { return stringhe; }
+    // Byte di stringhe non contati perché condivisi con una stringa già vista
+    qint64 sharedStringBytes() const { return condivise; }
+
+    QMap<QString, QMap<QString, Entry>> entries() const { return voci; }
+
+    QJsonObject toJson() const;
+    // Tabella leggibile: una riga per voce, con totali per categoria
+    QString format() const;
+
+private:
+    QMap<QString, QMap<QString, Entry>> voci;
+    QSet<const void *> buffersVisti;
+    qint64 stringhe = 0;
+    qint64 condivise = 0;
+};
+
+#endif // MEMORYREPORT_H
@@ -0,0 +1,159 @@
+#ifndef RESULT_H
+#define RESULT_H
+
+#include <string>
+#include <utility>
+#include <QString>
+#include "Exceptions.h"
+
+/**
+ * Error / Result - Esito di un'operazione senza eccezioni (stile "expected")
+ *
+ * Sui percorsi caldi (importazioni con molti record non validi, ricerche fallite)
+ * lanciare e catturare un'eccezione per ogni caso ordinario costa più del lavoro utile.
+ * Le API try* restituiscono invece un Result che contiene il valore oppure un Error.
+ * L'Error memorizza solo un codice, un testo statico e un eventuale dettaglio:
+ * il messaggio completo viene composto solo se qualcuno lo richiede.
+ * Le API che lanciano restano disponibili come sottili wrapper tramite orThrow().
+ */
+
+enum class ErrorCode
+{
+    None,
+    InvalidData,  // InvalidDataException
+    NotFound,     // MediaNotFoundException
+    Duplicate,    // DuplicateMediaException
+    JsonParse     // JsonParseException
+};
+
+class Error
+{
+public:
+    Error() = default;
+
+    Error(ErrorCode code, const char *text)
+        : errorCode(code), text(text) {}
+
+    Error(ErrorCode code, const char *text, const QString &detail)
+        : errorCode(code), text(text), textDetail(detail) {}
+
+    Error(ErrorCode code, const char *text, int detail)
+        : errorCode(code), text(text), numericDetail(detail), hasNumericDetail(true) {}
+
+    ErrorCode code() const { return errorCode; }
+
+    // Dettaglio formattato al momento della richiesta (come passato alle eccezioni)
+    std::string details() const
+    {
+        std::string result = text ? text : "";
+        if (hasNumericDetail)
+        {
+            result += std::to_string(numericDetail);
+        }
+        else if (!textDetail.isEmpty())
+        {
+            result += textDetail.toStdString();
+        }
+        return result;
+    }
+
+    // Messaggio completo, identico al what() dell'eccezione corrispondente
+    std::string message() const
+    {
+        switch (errorCode)
+        {
+        case ErrorCode::None:
+            return std::string();
+        case ErrorCode::InvalidData:
+            return InvalidDataException(details()).what();
+        case ErrorCode::NotFound:
+            return MediaNotFoundException(details()).what();
+        case ErrorCode::Duplicate:
+            return DuplicateMediaException().what();
+        case ErrorCode::JsonParse:
+            return JsonParseException(details()).what();
+        }
+        return details();
+    }
+
+    // Converte l'errore nell'eccezione equivalente
+    [[noreturn]] void raise() const
+    {
+        switch (errorCode)
+        {
+        case ErrorCode::InvalidData:
+            throw InvalidDataException(details());
+        case ErrorCode::NotFound:
+            throw MediaNotFoundException(details());
+        case ErrorCode::Duplicate:
+            throw DuplicateMediaException();
+        case ErrorCode::JsonParse:
+            throw JsonParseException(details());
+        case ErrorCode::None:
+            break;
+        }
+        throw BibliotecaException(details());
+    }
+
+private:
+    ErrorCode errorCode = ErrorCode::None;
+    const char *text = nullptr; // sempre un letterale: nessuna allocazione
+    QString textDetail;         // condiviso implicitamente, nessuna copia profonda
+    int numericDetail = 0;
+    bool hasNumericDetail = false;
+};
+
+template <typename T>
+class Result
+{
+public:
+    Result(T value) : val(std::move(value)) {}
+    Result(const Error &error) : err(error) {}
+
+    bool isOk() const { return err.code() == ErrorCode::None; }
+    explicit operator bool() const { return isOk(); }
+
+    const Error &error() const { return err; }
+    const T &value() const { return val; }
+    T valueOr(const T &fallback) const { return isOk() ? val : fallback; }
+
+    // Restituisce il valore o lancia l'eccezione equivalente all'errore
+    T orThrow() const
+    {
+        if (!isOk())
+        {
+            err.raise();
+        }
+        return val;
+    }
+
+private:
+    T val{};
+    Error err;
+};
+
+template <>
+class Result<void>
+{
+public:
+    Result() = default;
+    Result(const Error &error) : err(error) {}
+
+    bool isOk() const { return err.code() == ErrorCode::None; }
+    explicit operator bool() const { return isOk(); }
+
+    const Error &error() const { return err; }
+
+    void orThrow() const
+    {
+        if (!isOk())
+        {
+            err.raise();
+        }
+    }
+
+private:
+    Error err;
+};
+
+#endif // RESULT_H
@@ -0,0 +1,462 @@
+#include "RoaringBitmap.h"
+#include "MemoryReport.h"
+#include <algorithm>
+#include <iterator>
+
+/**
+ * Costruisce l'insieme di tutti gli identificativi nell'intervallo [begin, end).
+ * I blocchi densi vengono creati come bitmap riempiendo parole intere
+ * (solo le due di bordo sono mascherate), senza lavoro per elemento.
+ * @param begin Primo identificativo incluso
+ * @param end Primo identificativo escluso
+ * @return Insieme contenente l'intervallo richiesto
+ */
+RoaringBitmap RoaringBitmap::range(quint32 begin, quint32 end)
+{
+    RoaringBitmap result;
+    if (begin >= end)
+    {
+        return result;
+    }
+
+    const quint32 lastValue = end - 1;
+    for (quint32 key = begin >> 16; key <= (lastValue >> 16); ++key)
+    {
+        const quint32 chunkStart = key << 16;
+        const quint32 low = std::max(begin, chunkStart) - chunkStart;
+        const quint32 high = std::min(lastValue, chunkStart | 0xFFFFu) - chunkStart;
+
+        Chunk chunk;
+        chunk.key = quint16(key);
+        chunk.cardinality = int(high - low + 1);
+        if (chunk.cardinality <= ArrayMaxSize)
+        {
+            chunk.array.reserve(chunk.cardinality);
+            for (quint32 v = low; v <= high; ++v)
+            {
+                chunk.array.append(quint16(v));
+            }
+        }
+        else
+        {
+            // Parole intere a ~0, poi si mascherano le due parole di bordo
+            chunk.words = QVector<quint64>(BitmapWords, 0);
+            quint64 *words = chunk.words.data();
+            const int firstWord = int(low >> 6);
+            const int lastWord = int(high >> 6);
+            std::fill(words + firstWord, words + lastWord + 1, ~quint64(0));
+            words[firstWord] &= ~quint64(0) << (low & 63);
+            words[lastWord] &= ~quint64(0) >> (63 - (high & 63));
+        }
+        result.chunks.append(chunk);
+    }
+    return result;
+}
+
+/**
+ * Aggiunge un identificativo all'insieme (nessun effetto se già presente).
+ * @param value Identificativo da aggiungere
+ */
+void RoaringBitmap::add(quint32 value)
+{
+    const quint16 key = quint16(value >> 16);
+    int index = findChunk(key);
+    if (index < 0)
+    {
+        index = -index - 1;
+        Chunk chunk;
+        chunk.key = key;
+        chunks.insert(index, chunk);
+    }
+    chunks[index].add(quint16(value & 0xFFFF));
+}
+
+bool RoaringBitmap::contains(quint32 value) const
+{
+    const int index = findChunk(quint16(value >> 16));
+    return index >= 0 && chunks.at(index).contains(quint16(value & 0xFFFF));
+}
+
+void RoaringBitmap::clear()
+{
+    chunks.clear();
+}
+
+int RoaringBitmap::cardinality() const
+{
+    int total = 0;
+    for (const Chunk &chunk : chunks)
+    {
+        total += chunk.cardinality;
+    }
+    return total;
+}
+
+bool RoaringBitmap::isEmpty() const
+{
+    return chunks.isEmpty();
+}
+
+/**
+ * Intersezione di due insiemi.
+ * Solo i blocchi con la stessa chiave in entrambi gli operandi vengono combinati.
+ */
+RoaringBitmap RoaringBitmap::operator&(const RoaringBitmap &other) const
+{
+    RoaringBitmap result;
+    int i = 0;
+    int j = 0;
+    while (i < chunks.size() && j < other.chunks.size())
+    {
+        const Chunk &a = chunks.at(i);
+        const Chunk &b = other.chunks.at(j);
+        if (a.key < b.key)
+        {
+            ++i;
+        }
+        else if (b.key < a.key)
+        {
+            ++j;
+        }
+        else
+        {
+            Chunk merged = andChunks(a, b);
+            if (merged.cardinality > 0)
+            {
+                result.chunks.append(merged);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+/**
+ * Unione di due insiemi.
+ */
+RoaringBitmap RoaringBitmap::operator|(const RoaringBitmap &other) const
+{
+    RoaringBitmap result;
+    result.chunks.reserve(chunks.size() + other.chunks.size());
+    int i = 0;
+    int j = 0;
+    while (i < chunks.size() || j < other.chunks.size())
+    {
+        if (j >= other.chunks.size() || (i < chunks.size() && chunks.at(i).key < other.chunks.at(j).key))
+        {
+            result.chunks.append(chunks.at(i++));
+        }
+        else if (i >= chunks.size() || other.chunks.at(j).key < chunks.at(i).key)
+        {
+            result.chunks.append(other.chunks.at(j++));
+        }
+        else
+        {
+            result.chunks.append(orChunks(chunks.at(i++), other.chunks.at(j++)));
+        }
+    }
+    return result;
+}
+
+/**
+ * Differenza insiemistica: identificativi presenti in questo insieme ma non in other.
+ * Combinata con range() permette di esprimere la negazione (NOT) di un filtro.
+ */
+RoaringBitmap RoaringBitmap::andNot(const RoaringBitmap &other) const
+{
+    RoaringBitmap result;
+    int j = 0;
+    for (const Chunk &a : chunks)
+    {
+        while (j < other.chunks.size() && other.chunks.at(j).key < a.key)
+        {
+            ++j;
+        }
+        if (j < other.chunks.size() && other.chunks.at(j).key == a.key)
+        {
+            Chunk diff = andNotChunks(a, other.chunks.at(j));
+            if (diff.cardinality > 0)
+            {
+                result.chunks.append(diff);
+            }
+        }
+        else
+        {
+            result.chunks.append(a);
+        }
+    }
+    return result;
+}
+
+RoaringBitmap &RoaringBitmap::operator&=(const RoaringBitmap &other)
+{
+    *this = *this & other;
+    return *this;
+}
+
+RoaringBitmap &RoaringBitmap::operator|=(const RoaringBitmap &other)
+{
+    *this = *this | other;
+    return *this;
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap &other) const
+{
+    return cardinality() == other.cardinality() && toVector() == other.toVector();
+}
+
+QVector<quint32> RoaringBitmap::toVector() const
+{
+    QVector<quint32> result;
+    result.reserve(cardinality());
+    forEach([&result](quint32 value)
+            {
+                result.append(value);
+                return true;
+            });
+    return result;
+}
+
+/**
+ * Ricerca binaria del blocco con la chiave indicata.
+ * @return Indice del blocco, oppure -(posizione di inserimento + 1) se assente
+ */
+int RoaringBitmap::findChunk(quint16 key) const
+{
+    int low = 0;
+    int high = chunks.size() - 1;
+    while (low <= high)
+    {
+        const int mid = (low + high) / 2;
+        const quint16 midKey = chunks.at(mid).key;
+        if (midKey < key)
+        {
+            low = mid + 1;
+        }
+        else if (key < midKey)
+        {
+            high = mid - 1;
+        }
+        else
+        {
+            return mid;
+        }
+    }
+    return -(low + 1);
+}
+
+bool RoaringBitmap::Chunk::contains(quint16 low) const
+{
+    if (isBitmap())
+    {
+        return (words.at(low >> 6) >> (low & 63)) & 1;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Chunk::add(quint16 low)
+{
+    if (isBitmap())
+    {
+        quint64 &word = words[low >> 6];
+        const quint64 mask = quint64(1) << (low & 63);
+        if (!(word & mask))
+        {
+            word |= mask;
+            ++cardinality;
+        }
+        return;
+    }
+
+    // Inserimento in coda: caso comune quando gli slot vengono assegnati in ordine
+    if (array.isEmpty() || array.last() < low)
+    {
+        array.append(low);
+    }
+    else
+    {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (*it == low)
+        {
+            return;
+        }
+        array.insert(int(it - array.begin()), low);
+    }
+    ++cardinality;
+
+    if (cardinality > ArrayMaxSize)
+    {
+        toBitmap();
+    }
+}
+
+void RoaringBitmap::Chunk::toBitmap()
+{
+    words = QVector<quint64>(BitmapWords, 0);
+    for (quint16 low : array)
+    {
+        words[low >> 6] |= quint64(1) << (low & 63);
+    }
+    array.clear();
+}
+
+/**
+ * Riporta un blocco bitmap alla rappresentazione ad array se è diventato sparso.
+ */
+void RoaringBitmap::Chunk::optimize()
+{
+    if (!isBitmap() || cardinality > ArrayMaxSize)
+    {
+        return;
+    }
+    array.clear();
+    array.reserve(cardinality);
+    for (int w = 0; w < words.size(); ++w)
+    {
+        quint64 word = words.at(w);
+        while (word)
+        {
+            array.append(quint16((w << 6) | int(qCountTrailingZeroBits(word))));
+            word &= word - 1;
+        }
+    }
+    words.clear();
+}
+
+RoaringBitmap::Chunk RoaringBitmap::andChunks(const Chunk &a, const Chunk &b)
+{
+    Chunk result;
+    result.key = a.key;
+
+    if (a.isBitmap() && b.isBitmap())
+    {
+        result.words = QVector<quint64>(BitmapWords, 0);
+        for (int w = 0; w < BitmapWords; ++w)
+        {
+            const quint64 word = a.words.at(w) & b.words.at(w);
+            result.words[w] = word;
+            result.cardinality += int(qPopulationCount(word));
+        }
+        result.optimize();
+        return result;
+    }
+
+    if (a.isBitmap() || b.isBitmap())
+    {
+        const Chunk &sparse = a.isBitmap() ? b : a;
+        const Chunk &dense = a.isBitmap() ? a : b;
+        for (quint16 low : sparse.array)
+        {
+            if (dense.contains(low))
+            {
+                result.array.append(low);
+            }
+        }
+        result.cardinality = result.array.size();
+        return result;
+    }
+
+    std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                          std::back_inserter(result.array));
+    result.cardinality = result.array.size();
+    return result;
+}
+
+RoaringBitmap::Chunk RoaringBitmap::orChunks(const Chunk &a, const Chunk &b)
+{
+    Chunk result;
+    result.key = a.key;
+
+    if (a.isBitmap() || b.isBitmap())
+    {
+        const Chunk &dense = a.isBitmap() ? a : b;
+        const Chunk &other = a.isBitmap() ? b : a;
+        result.words = dense.words;
+        if (other.isBitmap())
+        {
+            for (int w = 0; w < BitmapWords; ++w)
+            {
+                result.words[w] |= other.words.at(w);
+            }
+        }
+        else
+        {
+            for (quint16 low : other.array)
+            {
+                result.words[low >> 6] |= quint64(1) << (low & 63);
+            }
+        }
+        for (quint64 word : result.words)
+        {
+            result.cardinality += int(qPopulationCount(word));
+        }
+        return result;
+    }
+
+    result.array.reserve(a.array.size() + b.array.size());
+    std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                   std::back_inserter(result.array));
+    result.cardinality = result.array.size();
+    if (result.cardinality > ArrayMaxSize)
+    {
+        result.toBitmap();
+    }
+    return result;
+}
+
+RoaringBitmap::Chunk RoaringBitmap::andNotChunks(const Chunk &a, const Chunk &b)
+{
+    Chunk result;
+    result.key = a.key;
+
+    if (!a.isBitmap())
+    {
+        for (quint16 low : a.array)
+        {
+            if (!b.contains(low))
+            {
+                result.array.append(low);
+            }
+        }
+        result.cardinality = result.array.size();
+        return result;
+    }
+
+    result.words = a.words;
+    if (b.isBitmap())
+    {
+        for (int w = 0; w < BitmapWords; ++w)
+        {
+            result.words[w] &= ~b.words.at(w);
+        }
+    }
+    else
+    {
+        for (quint16 low : b.array)
+        {
+            result.words[low >> 6] &= ~(quint64(1) << (low & 63));
+        }
+    }
+    for (quint64 word : result.words)
+    {
+        result.cardinality += int(qPopulationCount(word));
+    }
+    result.optimize();
+    return result;
+}
+
+/**
+ * Memoria occupata: il vettore dei blocchi più, per ogni blocco, l'array
+ * ordinato o le 1024 parole della bitmap densa.
+ */
+qint64 RoaringBitmap::memoryFootprint() const
+{
+    qint64 byte = MemoryReport::arrayBytes(chunks.capacity(), sizeof(Chunk));
+    for (const Chunk &chunk : chunks)
+    {
+        byte += MemoryReport::arrayBytes(chunk.array.capacity(), sizeof(quint16));
+        byte += MemoryReport::arrayBytes(chunk.words.capacity(), sizeof(quint64));
+    }
+    return byte;
+}
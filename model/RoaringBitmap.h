@@ -0,0 +1,138 @@
+#ifndef ROARINGBITMAP_H
+#define ROARINGBITMAP_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+/**
+ * RoaringBitmap - Insieme compresso di identificativi interi (stile "roaring")
+ *
+ * Gli identificativi a 32 bit sono suddivisi in blocchi da 65536 valori
+ * indicizzati dai 16 bit alti. Ogni blocco usa la rappresentazione più compatta:
+ * - array ordinato di quint16 se contiene al più 4096 valori
+ * - bitmap di 1024 parole a 64 bit altrimenti
+ * Le operazioni AND/OR/ANDNOT lavorano blocco per blocco e, sulle bitmap,
+ * una parola alla volta.
+ */
+class RoaringBitmap
+{
+public:
+    RoaringBitmap() = default;
+
+    // Crea un insieme con tutti gli identificativi in [begin, end)
+    static RoaringBitmap range(quint32 begin, quint32 end);
+
+    void add(quint32 value);
+    bool contains(quint32 value) const;
+    void clear();
+
+    int cardinality() const;
+    bool isEmpty() const;
+
+    // Operazioni insiemistiche
+    RoaringBitmap operator&(const RoaringBitmap &other) const;
+    RoaringBitmap operator|(const RoaringBitmap &other) const;
+    RoaringBitmap andNot(const RoaringBitmap &other) const;
+    RoaringBitmap &operator&=(const RoaringBitmap &other);
+    RoaringBitmap &operator|=(const RoaringBitmap &other);
+
+    bool operator==(const RoaringBitmap &other) const;
+    bool operator!=(const RoaringBitmap &other) const { return !(*this == other); }
+
+    // Elenca gli identificativi in ordine crescente
+    QVector<quint32> toVector() const;
+
+    // Byte stimati nello heap per l'elenco dei blocchi e il loro contenuto
+    qint64 memoryFootprint() const;
+
+    // Visita gli identificativi in ordine crescente; la visita si interrompe
+    // quando il predicato restituisce false
+    template <typename Visitor>
+    void forEach(Visitor visit) const
+    {
+        forEachFrom(0, visit);
+    }
+
+    // Come forEach, ma parte dal primo identificativo >= start senza
+    // scorrere i blocchi precedenti
+    template <typename Visitor>
+    void forEachFrom(quint32 start, Visitor visit) const
+    {
+        const quint16 startKey = quint16(start >> 16);
+        int first = findChunk(startKey);
+        if (first < 0)
+        {
+            first = -first - 1;
+        }
+
+        for (int c = first; c < chunks.size(); ++c)
+        {
+            const Chunk &chunk = chunks.at(c);
+            const quint32 high = quint32(chunk.key) << 16;
+            const quint32 minLow = chunk.key == startKey ? (start & 0xFFFF) : 0;
+            if (chunk.isBitmap())
+            {
+                for (int w = int(minLow >> 6); w < chunk.words.size(); ++w)
+                {
+                    quint64 word = chunk.words.at(w);
+                    if (w == int(minLow >> 6))
+                    {
+                        word &= ~quint64(0) << (minLow & 63);
+                    }
+                    while (word)
+                    {
+                        const quint32 bit = qCountTrailingZeroBits(word);
+                        if (!visit(high | (quint32(w) << 6) | bit))
+                        {
+                            return;
+                        }
+                        word &= word - 1;
+                    }
+                }
+            }
+            else
+            {
+                for (quint16 low : chunk.array)
+                {
+                    if (low < minLow)
+                    {
+                        continue;
+                    }
+                    if (!visit(high | low))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int ArrayMaxSize = 4096;
+    static constexpr int BitmapWords = 1024;
+
+    struct Chunk
+    {
+        quint16 key = 0;
+        int cardinality = 0;
+        QVector<quint16> array; // usato se words è vuoto
+        QVector<quint64> words; // 1024 parole se il blocco è denso
+
+        bool isBitmap() const { return !words.isEmpty(); }
+        bool contains(quint16 low) const;
+        void add(quint16 low);
+        void toBitmap();
+        void optimize();
+    };
+
+    QVector<Chunk> chunks; // ordinati per key
+
+    int findChunk(quint16 key) const;
+
+    static Chunk andChunks(const Chunk &a, const Chunk &b);
+    static Chunk orChunks(const Chunk &a, const Chunk &b);
+    static Chunk andNotChunks(const Chunk &a, const Chunk &b);
+};
+
+#endif // ROARINGBITMAP_H
@@ -0,0 +1,19 @@
+# Collegamento alla libreria statica biblio_model.
+# Da includere nei progetti che usano il modello (app, cli, tests, benchmarks).
+
+INCLUDEPATH += $$BIBLIO_ROOT
+DEPENDPATH += $$BIBLIO_ROOT
+
+BIBLIO_MODEL_DIR = $$BIBLIO_BUILD_ROOT/model
+win32:CONFIG(release, debug|release): BIBLIO_MODEL_DIR = $$BIBLIO_MODEL_DIR/release
+else:win32:CONFIG(debug, debug|release): BIBLIO_MODEL_DIR = $$BIBLIO_MODEL_DIR/debug
+
+LIBS += -L$$BIBLIO_MODEL_DIR -lbiblio_model
+
+win32-msvc*: PRE_TARGETDEPS += $$BIBLIO_MODEL_DIR/biblio_model.lib
+else: PRE_TARGETDEPS += $$BIBLIO_MODEL_DIR/libbiblio_model.a
+
+QT *= core concurrent
+
+# Le macro di tracing si espandono nei sorgenti di chi include il modello
+tracing: DEFINES += BIBLIO_TRACING
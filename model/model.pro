@@ -0,0 +1,71 @@
+QT = core concurrent
+
+CONFIG += c++17 staticlib
+
+# qmake CONFIG+=tracing abilita la strumentazione (diagnostics/Tracing.h)
+tracing: DEFINES += BIBLIO_TRACING
+
+TARGET = biblio_model
+TEMPLATE = lib
+
+SOURCES += \
+    Media.cpp \
+    Book.cpp \
+    Film.cpp \
+    MagazineArticle.cpp \
+    Biblioteca.cpp \
+    User.cpp \
+    UserAuthenticator.cpp \
+    MediaFactory.cpp \
+    MediaTypeRegistry.cpp \
+    MediaStore.cpp \
+    MediaCollectorVisitor.cpp \
+    RoaringBitmap.cpp \
+    DuplicateDetector.cpp \
+    MemoryReport.cpp \
+    MemoryFootprintVisitor.cpp \
+    ../persistence/JsonSerializer.cpp \
+    ../persistence/AsyncSaver.cpp \
+    ../persistence/Journal.cpp \
+    ../persistence/SnapshotRotation.cpp \
+    ../persistence/ShardedCatalog.cpp \
+    ../persistence/BlockCompression.cpp \
+    ../persistence/BatchImporter.cpp \
+    ../persistence/StreamExporter.cpp \
+    ../diagnostics/Tracing.cpp \
+    ../diagnostics/Metrics.cpp
+
+HEADERS += \
+    Media.h \
+    Book.h \
+    Film.h \
+    MagazineArticle.h \
+    MediaVisitor.h \
+    MediaVisitorT.h \
+    MediaCollectorVisitor.h \
+    Biblioteca.h \
+    User.h \
+    UserAuthenticator.h \
+    Container.h \
+    Exceptions.h \
+    Result.h \
+    MediaFactory.h \
+    MediaTypeRegistry.h \
+    MediaKeys.h \
+    MediaSchema.h \
+    MediaStore.h \
+    RoaringBitmap.h \
+    DuplicateDetector.h \
+    MemoryReport.h \
+    MemoryFootprintVisitor.h \
+    ../persistence/JsonSerializer.h \
+    ../persistence/AsyncSaver.h \
+    ../persistence/Journal.h \
+    ../persistence/SnapshotRotation.h \
+    ../persistence/ShardedCatalog.h \
+    ../persistence/BlockCompression.h \
+    ../persistence/BatchImporter.h \
+    ../persistence/StreamExporter.h \
+    ../persistence/BoundedQueue.h \
+    ../diagnostics/Tracing.h \
+    ../diagnostics/Metrics.h
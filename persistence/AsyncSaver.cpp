@@ -0,0 +1,154 @@
+#include "AsyncSaver.h"
+#include "JsonSerializer.h"
+#include "SnapshotRotation.h"
+#include "ShardedCatalog.h"
+#include "BlockCompression.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QtConcurrent>
+#include <memory>
+
+namespace
+{
+    // Eseguita nel pool: non tocca la biblioteca, solo la sua istantanea
+    QString scriviIstantanea(const QString &filePath, const MediaStore &valori, qint64 generazioneJournal,
+                             int copieRotazione)
+    {
+        BIBLIO_TRACE_SCOPE("persistenza", "AsyncSaver::scrivi");
+        Metrics::ScopedLatency misura(Metrics::histogram("salvataggio.durata_us"));
+        try
+        {
+            if (ShardedCatalog::isManifestPath(filePath))
+            {
+                // Catalogo a shard: riscrive solo gli shard cambiati
+                ShardedCatalog::salvaThrows(valori, filePath);
+                return QString();
+            }
+            QByteArray data = JsonSerializer::serializzaIstantanea(valori, generazioneJournal);
+            if (BlockCompression::isCompressoPath(filePath))
+            {
+                data = BlockCompression::comprimi(data);
+            }
+            if (copieRotazione > 0)
+            {
+                SnapshotRotation(filePath, copieRotazione).scrivi(data, generazioneJournal);
+            }
+            else
+            {
+                JsonSerializer::scriviFileAtomico(filePath, data);
+            }
+        }
+        catch (const BibliotecaException &e)
+        {
+            return QString::fromStdString(e.what());
+        }
+        return QString();
+    }
+}
+
+AsyncSaver::AsyncSaver(QObject *parent)
+    : QObject(parent)
+{
+    connect(&watcher, &QFutureWatcher<QString>::finished, this, &AsyncSaver::onScritturaTerminata);
+}
+
+AsyncSaver::~AsyncSaver()
+{
+    attendi();
+}
+
+/**
+ * Prende l'istantanea subito, così le modifiche successive alla biblioteca
+ * non finiscono nel file; se una scrittura è già in corso la richiesta
+ * sostituisce quella in attesa per lo stesso file.
+ */
+void AsyncSaver::salva(const Biblioteca &biblioteca, const QString &filePath, qint64 generazioneJournal,
+                       int copieRotazione)
+{
+    salva(biblioteca.istantanea(), filePath, generazioneJournal, copieRotazione);
+}
+
+void AsyncSaver::salva(MediaStore valori, const QString &filePath, qint64 generazioneJournal, int copieRotazione)
+{
+    Richiesta richiesta{filePath, std::move(valori), generazioneJournal, copieRotazione};
+    if (!inCorso)
+    {
+        avvia(std::move(richiesta));
+        return;
+    }
+
+    for (Richiesta &attesa : inAttesa)
+    {
+        if (attesa.filePath == filePath)
+        {
+            attesa.valori = std::move(richiesta.valori);
+            attesa.generazioneJournal = generazioneJournal;
+            attesa.copieRotazione = copieRotazione;
+            Metrics::counter("salvataggio.uniti").add();
+            return;
+        }
+    }
+    inAttesa.append(std::move(richiesta));
+}
+
+void AsyncSaver::avvia(Richiesta richiesta)
+{
+    inCorso = true;
+    fileInCorso = richiesta.filePath;
+    elementiInCorso = richiesta.valori.size();
+    generazioneInCorso = richiesta.generazioneJournal;
+    const QString filePath = richiesta.filePath;
+    const qint64 generazione = richiesta.generazioneJournal;
+    const int copie = richiesta.copieRotazione;
+    // Condivisa: QtConcurrent::run copia il funtore, l'istantanea no
+    const auto valori = std::make_shared<const MediaStore>(std::move(richiesta.valori));
+    watcher.setFuture(QtConcurrent::run([filePath, valori, generazione, copie]()
+                                        { return scriviIstantanea(filePath, *valori, generazione, copie); }));
+}
+
+/**
+ * Segnala l'esito della scrittura corrente e avvia la prima in attesa.
+ * Il segnale finished di una scrittura già conclusa da attendi() arriva
+ * quando non c'è niente in corso, oppure quando il watcher segue già
+ * un'altra scrittura non ancora finita: in entrambi i casi va ignorato.
+ */
+void AsyncSaver::onScritturaTerminata()
+{
+    if (inCorso && watcher.isFinished())
+    {
+        concludi();
+    }
+}
+
+void AsyncSaver::concludi()
+{
+    const QString filePath = fileInCorso;
+    const int elementi = elementiInCorso;
+    const qint64 generazione = generazioneInCorso;
+    const QString errore = watcher.result();
+
+    inCorso = false;
+    if (!inAttesa.isEmpty())
+    {
+        avvia(inAttesa.takeFirst());
+    }
+
+    if (errore.isEmpty())
+    {
+        emit salvato(filePath, elementi, generazione);
+    }
+    else
+    {
+        Metrics::counter("salvataggio.errori").add();
+        emit fallito(filePath, errore);
+    }
+}
+
+void AsyncSaver::attendi()
+{
+    while (inCorso)
+    {
+        watcher.waitForFinished();
+        concludi();
+    }
+}
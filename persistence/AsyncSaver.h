@@ -0,0 +1,73 @@
+#ifndef ASYNCSAVER_H
+#define ASYNCSAVER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QFutureWatcher>
+#include "../model/Biblioteca.h"
+#include "../model/MediaStore.h"
+
+/**
+ * AsyncSaver - Salvataggio della biblioteca in background
+ *
+ * salva() copia i Media per valore (Biblioteca::istantanea()) nel thread
+ * chiamante, oppure riceve un'istantanea già presa altrove, e affida
+ * serializzazione e scrittura a un thread del pool.
+ * Il file viene scritto con JsonSerializer::scriviFileAtomico(): in caso di
+ * interruzione resta la versione precedente, mai un file troncato.
+ *
+ * È in corso al massimo una scrittura. Le richieste che arrivano nel frattempo
+ * restano in attesa e si uniscono: per ogni file viene scritta solo
+ * l'istantanea più recente.
+ */
+class AsyncSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AsyncSaver(QObject *parent = nullptr);
+    // Attende le scritture in corso e in attesa
+    ~AsyncSaver() override;
+
+    // generazioneJournal viene scritta nel file (vedi JsonSerializer::serializzaIstantanea);
+    // con copieRotazione > 0 il file è uno snapshot a rotazione con checksum (SnapshotRotation)
+    void salva(const Biblioteca &biblioteca, const QString &filePath, qint64 generazioneJournal = -1,
+               int copieRotazione = 0);
+    // Come sopra, con un'istantanea già presa (per esempio dal thread che ha caricato la biblioteca)
+    void salva(MediaStore valori, const QString &filePath, qint64 generazioneJournal = -1,
+               int copieRotazione = 0);
+
+    // true finché c'è una scrittura in corso o in attesa
+    bool occupato() const { return inCorso; }
+    // Blocca finché tutte le richieste sono state scritte su disco
+    void attendi();
+
+signals:
+    void salvato(const QString &filePath, int elementi, qint64 generazioneJournal);
+    void fallito(const QString &filePath, const QString &messaggio);
+
+private slots:
+    void onScritturaTerminata();
+
+private:
+    struct Richiesta
+    {
+        QString filePath;
+        MediaStore valori;
+        qint64 generazioneJournal;
+        int copieRotazione;
+    };
+
+    void avvia(Richiesta richiesta);
+    void concludi();
+
+    QFutureWatcher<QString> watcher; // risultato: messaggio di errore, vuoto se riuscito
+    bool inCorso = false;
+    QString fileInCorso;
+    int elementiInCorso = 0;
+    qint64 generazioneInCorso = -1;
+    QList<Richiesta> inAttesa; // al massimo una per file
+};
+
+#endif // ASYNCSAVER_H
@@ -0,0 +1,687 @@
+#include "BatchImporter.h"
+#include "BoundedQueue.h"
+#include "../model/MediaFactory.h"
+#include "../model/MediaKeys.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <array>
+#include <exception>
+
+namespace
+{
+    // Campi riconosciuti, nello stesso ordine di Chiavi
+    enum Campo
+    {
+        Tipo,
+        Titolo,
+        Anno,
+        Autore,
+        Isbn,
+        Editore,
+        Regista,
+        Durata,
+        Genere,
+        Rivista,
+        Doi,
+        Copertina,
+        NumeroCampi
+    };
+
+    const std::array<QLatin1String, NumeroCampi> Chiavi = {
+        MediaKeys::Type, MediaKeys::Title, MediaKeys::Year, MediaKeys::Author,
+        MediaKeys::Isbn, MediaKeys::Publisher, MediaKeys::Director, MediaKeys::Duration,
+        MediaKeys::Genre, MediaKeys::Magazine, MediaKeys::Doi, MediaKeys::CoverImagePath};
+
+    using Campi = std::array<QString, NumeroCampi>;
+    // Colonna CSV di ogni campo, -1 se assente
+    using Colonne = std::array<int, NumeroCampi>;
+
+    struct Record
+    {
+        qint64 riga = 0;
+        QByteArray testo;
+    };
+
+    struct Blocco
+    {
+        int indice = -1;
+        QVector<Record> record;
+    };
+
+    struct BloccoAnalizzato
+    {
+        int indice = -1;
+        int record = 0;
+        QList<Media *> media;
+        int scartati = 0;
+        QVector<BatchImporter::ErroreRiga> errori;
+    };
+
+    /**
+     * Divide il flusso in record: una riga per JSON-lines, una riga per CSV
+     * salvo campi tra virgolette che contengono a capo, un gruppo di righe
+     * separato da una riga vuota per MARC. Le righe vuote isolate sono ignorate.
+     */
+    class LettoreRecord
+    {
+    public:
+        LettoreRecord(QIODevice &sorgente, BatchImporter::Formato formato)
+            : sorgente(sorgente), formato(formato) {}
+
+        bool prossimo(Record &record)
+        {
+            record.testo.clear();
+            bool virgolette = false;
+            while (!sorgente.atEnd())
+            {
+                const QByteArray linea = sorgente.readLine();
+                ++riga;
+                const bool vuota = linea.trimmed().isEmpty();
+                if (vuota && !virgolette)
+                {
+                    if (formato == BatchImporter::Formato::Marc && !record.testo.isEmpty())
+                    {
+                        return true;
+                    }
+                    continue;
+                }
+                if (record.testo.isEmpty())
+                {
+                    record.riga = riga;
+                }
+                record.testo += linea;
+                if (formato == BatchImporter::Formato::Csv)
+                {
+                    // Un numero dispari di virgolette apre o chiude un campo su più righe
+                    if (linea.count('"') % 2 != 0)
+                    {
+                        virgolette = !virgolette;
+                    }
+                    if (!virgolette)
+                    {
+                        return true;
+                    }
+                }
+                else if (formato == BatchImporter::Formato::JsonLines)
+                {
+                    return true;
+                }
+            }
+            return !record.testo.isEmpty();
+        }
+
+    private:
+        QIODevice &sorgente;
+        BatchImporter::Formato formato;
+        qint64 riga = 0;
+    };
+
+    // Campi di un record CSV; "" dentro le virgolette è una virgoletta letterale
+    QStringList campiCsv(const QByteArray &testo, char separatore)
+    {
+        QStringList campi;
+        QByteArray campo;
+        bool virgolette = false;
+        for (int i = 0; i < testo.size(); ++i)
+        {
+            const char c = testo.at(i);
+            if (virgolette)
+            {
+                if (c != '"')
+                {
+                    campo += c;
+                }
+                else if (i + 1 < testo.size() && testo.at(i + 1) == '"')
+                {
+                    campo += '"';
+                    ++i;
+                }
+                else
+                {
+                    virgolette = false;
+                }
+            }
+            else if (c == '"')
+            {
+                virgolette = true;
+            }
+            else if (c == separatore)
+            {
+                campi.append(QString::fromUtf8(campo));
+                campo.clear();
+            }
+            else if (c != '\r' && c != '\n')
+            {
+                campo += c;
+            }
+        }
+        campi.append(QString::fromUtf8(campo));
+        return campi;
+    }
+
+    Colonne colonneCsv(const QStringList &intestazione)
+    {
+        Colonne colonne;
+        colonne.fill(-1);
+        for (int colonna = 0; colonna < intestazione.size(); ++colonna)
+        {
+            const QString nome = intestazione.at(colonna).trimmed();
+            for (int campo = 0; campo < NumeroCampi; ++campo)
+            {
+                if (nome == Chiavi[std::size_t(campo)])
+                {
+                    colonne[std::size_t(campo)] = colonna;
+                }
+            }
+        }
+        if (colonne[Tipo] < 0 || colonne[Titolo] < 0 || colonne[Anno] < 0)
+        {
+            throw InvalidDataException("intestazione CSV senza le colonne type, title e year");
+        }
+        return colonne;
+    }
+
+    // Tutti i formati passano di qui: creazione e validazione di MediaFactory
+    Result<Media *> crea(const Campi &campi)
+    {
+        bool ok = false;
+        const int anno = campi[Anno].trimmed().toInt(&ok);
+        if (!ok)
+        {
+            return Error(ErrorCode::InvalidData, "Anno non numerico: ", campi[Anno]);
+        }
+        const QString &tipo = campi[Tipo];
+        if (tipo == QLatin1String("Book"))
+        {
+            return MediaFactory::tryCreateBook(campi[Titolo], anno, campi[Autore], campi[Isbn],
+                                               campi[Editore], campi[Copertina]);
+        }
+        if (tipo == QLatin1String("Film"))
+        {
+            const int durata = campi[Durata].trimmed().toInt(&ok);
+            if (!ok)
+            {
+                return Error(ErrorCode::InvalidData, "Durata non numerica: ", campi[Durata]);
+            }
+            return MediaFactory::tryCreateFilm(campi[Titolo], anno, campi[Regista], durata,
+                                               campi[Genere], campi[Copertina]);
+        }
+        if (tipo == QLatin1String("MagazineArticle"))
+        {
+            return MediaFactory::tryCreateMagazineArticle(campi[Titolo], anno, campi[Autore], campi[Rivista],
+                                                          campi[Doi], campi[Copertina]);
+        }
+        return Error(ErrorCode::InvalidData, "Tipo media non supportato: ", tipo);
+    }
+
+    Result<Media *> daCsv(const QByteArray &testo, char separatore, const Colonne &colonne)
+    {
+        const QStringList valori = campiCsv(testo, separatore);
+        Campi campi;
+        for (int campo = 0; campo < NumeroCampi; ++campo)
+        {
+            const int colonna = colonne[std::size_t(campo)];
+            if (colonna >= 0 && colonna < valori.size())
+            {
+                campi[std::size_t(campo)] = valori.at(colonna);
+            }
+        }
+        return crea(campi);
+    }
+
+    Result<Media *> daJson(const QByteArray &testo)
+    {
+        QJsonParseError parseError;
+        const QJsonDocument documento = QJsonDocument::fromJson(testo, &parseError);
+        if (parseError.error != QJsonParseError::NoError)
+        {
+            return Error(ErrorCode::JsonParse, "Riga JSON non valida: ", parseError.errorString());
+        }
+        if (!documento.isObject())
+        {
+            return Error(ErrorCode::JsonParse, "La riga non contiene un oggetto JSON");
+        }
+        const QJsonObject oggetto = documento.object();
+        Campi campi;
+        for (int campo = 0; campo < NumeroCampi; ++campo)
+        {
+            const QJsonValue valore = oggetto.value(Chiavi[std::size_t(campo)]);
+            campi[std::size_t(campo)] = valore.isDouble() ? QString::number(valore.toInt()) : valore.toString();
+        }
+        return crea(campi);
+    }
+
+    // Primo valore del sottocampo indicato ("10$aTitolo /$cAutore" -> 'a': "Titolo /")
+    QString sottocampo(const QString &dati, QChar codice)
+    {
+        const QStringList parti = dati.split('$');
+        for (int i = 1; i < parti.size(); ++i)
+        {
+            if (!parti.at(i).isEmpty() && parti.at(i).at(0) == codice)
+            {
+                return parti.at(i).mid(1);
+            }
+        }
+        return QString();
+    }
+
+    // Toglie la punteggiatura ISBD finale (" /", " :", ",", ".")
+    QString pulisci(const QString &valore)
+    {
+        QString risultato = valore.trimmed();
+        while (!risultato.isEmpty() && QStringLiteral("/:;,.").contains(risultato.at(risultato.size() - 1)))
+        {
+            risultato.chop(1);
+            risultato = risultato.trimmed();
+        }
+        return risultato;
+    }
+
+    // Prime quattro cifre consecutive ("c1980", "[1980?]" -> "1980")
+    QString annoDa(const QString &testo)
+    {
+        int cifre = 0;
+        for (int i = 0; i < testo.size(); ++i)
+        {
+            cifre = testo.at(i).isDigit() ? cifre + 1 : 0;
+            if (cifre == 4)
+            {
+                return testo.mid(i - 3, 4);
+            }
+        }
+        return QString();
+    }
+
+    Result<Media *> daMarc(const QByteArray &testo)
+    {
+        Campi campi;
+        QString leader;
+        QString anno008;
+        for (const QByteArray &grezza : testo.split('\n'))
+        {
+            const QString linea = QString::fromUtf8(grezza).trimmed();
+            if (linea.size() < 6 || linea.at(0) != '=')
+            {
+                continue;
+            }
+            const QString tag = linea.mid(1, 3);
+            const QString dati = linea.mid(6);
+            if (tag == QLatin1String("LDR"))
+            {
+                leader = dati;
+            }
+            else if (tag == QLatin1String("008"))
+            {
+                anno008 = dati.mid(7, 4);
+            }
+            else if (tag == QLatin1String("020") && campi[Isbn].isEmpty())
+            {
+                // "8845292614 (pbk.)": solo il numero
+                campi[Isbn] = sottocampo(dati, 'a').section(' ', 0, 0);
+            }
+            else if (tag == QLatin1String("024") && campi[Doi].isEmpty())
+            {
+                campi[Doi] = sottocampo(dati, 'a').trimmed();
+            }
+            else if (tag == QLatin1String("100") || (tag == QLatin1String("700") && campi[Autore].isEmpty()))
+            {
+                campi[Autore] = pulisci(sottocampo(dati, 'a'));
+            }
+            else if (tag == QLatin1String("245"))
+            {
+                campi[Titolo] = pulisci(sottocampo(dati, 'a'));
+            }
+            else if (tag == QLatin1String("260") || tag == QLatin1String("264"))
+            {
+                campi[Editore] = pulisci(sottocampo(dati, 'b'));
+                campi[Anno] = annoDa(sottocampo(dati, 'c'));
+            }
+            else if (tag == QLatin1String("306"))
+            {
+                // Durata hhmmss
+                const QString durata = sottocampo(dati, 'a').trimmed();
+                campi[Durata] = QString::number(durata.left(2).toInt() * 60 + durata.mid(2, 2).toInt());
+            }
+            else if (tag == QLatin1String("508"))
+            {
+                campi[Regista] = pulisci(sottocampo(dati, 'a'));
+            }
+            else if (tag == QLatin1String("655") && campi[Genere].isEmpty())
+            {
+                campi[Genere] = pulisci(sottocampo(dati, 'a'));
+            }
+            else if (tag == QLatin1String("773"))
+            {
+                campi[Rivista] = pulisci(sottocampo(dati, 't'));
+            }
+        }
+
+        if (leader.size() < 8)
+        {
+            return Error(ErrorCode::InvalidData, "Leader MARC mancante");
+        }
+        if (campi[Anno].isEmpty())
+        {
+            campi[Anno] = anno008;
+        }
+        const QChar tipo = leader.at(6);
+        const QChar livello = leader.at(7);
+        if (tipo == 'g')
+        {
+            campi[Tipo] = QStringLiteral("Film");
+            // Nei record dei film l'autore principale è il regista
+            if (campi[Regista].isEmpty())
+            {
+                campi[Regista] = campi[Autore];
+            }
+        }
+        else if (livello == 'a' || livello == 'b')
+        {
+            campi[Tipo] = QStringLiteral("MagazineArticle");
+        }
+        else
+        {
+            campi[Tipo] = QStringLiteral("Book");
+        }
+        return crea(campi);
+    }
+
+    BloccoAnalizzato analizza(const Blocco &blocco, BatchImporter::Formato formato, const Colonne &colonne,
+                              char separatore)
+    {
+        BloccoAnalizzato risultato;
+        risultato.indice = blocco.indice;
+        risultato.record = blocco.record.size();
+        try
+        {
+            risultato.media.reserve(blocco.record.size());
+            for (const Record &record : blocco.record)
+            {
+                Result<Media *> media = formato == BatchImporter::Formato::Csv
+                                            ? daCsv(record.testo, separatore, colonne)
+                                        : formato == BatchImporter::Formato::JsonLines ? daJson(record.testo)
+                                                                                        : daMarc(record.testo);
+                if (media)
+                {
+                    risultato.media.append(media.value());
+                }
+                else
+                {
+                    ++risultato.scartati;
+                    risultato.errori.append({record.riga, QString::fromStdString(media.error().message())});
+                }
+            }
+        }
+        catch (...)
+        {
+            // I Media già costruiti non arriverebbero mai all'inserimento
+            qDeleteAll(risultato.media);
+            throw;
+        }
+        return risultato;
+    }
+}
+
+bool BatchImporter::formatoDaPath(const QString &filePath, Formato *formato)
+{
+    const QString estensione = QFileInfo(filePath).suffix().toLower();
+    if (estensione == QLatin1String("csv"))
+    {
+        *formato = Formato::Csv;
+    }
+    else if (estensione == QLatin1String("jsonl") || estensione == QLatin1String("ndjson"))
+    {
+        *formato = Formato::JsonLines;
+    }
+    else if (estensione == QLatin1String("mrk"))
+    {
+        *formato = Formato::Marc;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+BatchImporter::Report BatchImporter::importaThrows(Biblioteca &biblioteca, const QString &filePath,
+                                                   const Opzioni &opzioni)
+{
+    Formato formato = Formato::JsonLines;
+    if (!formatoDaPath(filePath, &formato))
+    {
+        throw InvalidDataException("formato di importazione non riconosciuto: " + filePath.toStdString());
+    }
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        throw FileNotFoundException(filePath.toStdString());
+    }
+    return importaThrows(biblioteca, file, formato, opzioni);
+}
+
+/**
+ * Lettura e analisi girano in un pool dedicato (un thread di lettura più gli
+ * analizzatori), così l'importazione non occupa il pool globale; l'inserimento
+ * avviene nel thread chiamante, l'unico che tocca la biblioteca.
+ */
+BatchImporter::Report BatchImporter::importaThrows(Biblioteca &biblioteca, QIODevice &sorgente, Formato formato,
+                                                   const Opzioni &opzioni)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "BatchImporter::importa");
+    QElapsedTimer timer;
+    timer.start();
+
+    LettoreRecord lettore(sorgente, formato);
+    Colonne colonne;
+    colonne.fill(-1);
+    if (formato == Formato::Csv)
+    {
+        Record intestazione;
+        if (!lettore.prossimo(intestazione))
+        {
+            return Report();
+        }
+        colonne = colonneCsv(campiCsv(intestazione.testo, opzioni.separatore));
+    }
+
+    const int analizzatori = opzioni.analizzatori > 0 ? opzioni.analizzatori : qMax(1, QThread::idealThreadCount());
+    const int capacita = analizzatori * qMax(1, opzioni.blocchiPerAnalizzatore);
+    const int recordPerBlocco = qMax(1, opzioni.recordPerBlocco);
+    BoundedQueue<Blocco> daAnalizzare(capacita);
+    BoundedQueue<BloccoAnalizzato> analizzati(capacita);
+    // Blocchi letti e non ancora inseriti: limita anche quelli in attesa di riordino
+    const int dimensioneFinestra = 2 * capacita + analizzatori;
+    QSemaphore finestra(dimensioneFinestra);
+    std::atomic<bool> interrotto{false};
+    std::atomic<int> attivi{analizzatori};
+    QMutex mutexErrore;
+    std::exception_ptr erroreThread;
+    const auto annullato = [&opzioni]()
+    {
+        return opzioni.annullato && opzioni.annullato->load(std::memory_order_relaxed);
+    };
+    const auto segnalaErrore = [&]()
+    {
+        QMutexLocker locker(&mutexErrore);
+        if (!erroreThread)
+        {
+            erroreThread = std::current_exception();
+        }
+        interrotto = true;
+        daAnalizzare.chiudi();
+        // Il blocco perso non verrà mai inserito né rilascerà il suo posto: senza
+        // questi permessi il lettore potrebbe restare fermo su una finestra piena
+        finestra.release(dimensioneFinestra);
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(analizzatori + 1);
+    QtConcurrent::run(&pool, [&]()
+                      {
+        BIBLIO_TRACE_SCOPE("persistenza", "BatchImporter::lettura");
+        try
+        {
+            int indice = 0;
+            Blocco blocco;
+            Record record;
+            const auto invia = [&]()
+            {
+                finestra.acquire();
+                blocco.indice = indice++;
+                if (interrotto || !daAnalizzare.inserisci(std::move(blocco)))
+                {
+                    return false;
+                }
+                blocco = Blocco();
+                blocco.record.reserve(recordPerBlocco);
+                return true;
+            };
+            while (!interrotto && !annullato() && lettore.prossimo(record))
+            {
+                blocco.record.append(record);
+                if (blocco.record.size() >= recordPerBlocco && !invia())
+                {
+                    break;
+                }
+            }
+            if (!interrotto && !annullato() && !blocco.record.isEmpty())
+            {
+                invia();
+            }
+        }
+        catch (...)
+        {
+            segnalaErrore();
+        }
+        daAnalizzare.chiudi(); });
+
+    for (int i = 0; i < analizzatori; ++i)
+    {
+        QtConcurrent::run(&pool, [&]()
+                          {
+            BloccoAnalizzato risultato;
+            try
+            {
+                Blocco blocco;
+                while (!interrotto && daAnalizzare.preleva(blocco))
+                {
+                    risultato = analizza(blocco, formato, colonne, opzioni.separatore);
+                    if (!analizzati.inserisci(std::move(risultato)))
+                    {
+                        break;
+                    }
+                    risultato = BloccoAnalizzato();
+                }
+            }
+            catch (...)
+            {
+                segnalaErrore();
+            }
+            // Risultato non consegnato (coda chiusa o errore durante l'inserimento)
+            qDeleteAll(risultato.media);
+            if (--attivi == 0)
+            {
+                analizzati.chiudi();
+            } });
+    }
+
+    // Inserimento nell'ordine del file: i blocchi arrivati in anticipo aspettano in inAttesa
+    Report report;
+    QMap<int, BloccoAnalizzato> inAttesa;
+    int prossimo = 0;
+    std::exception_ptr errore;
+    BloccoAnalizzato analizzato;
+    try
+    {
+        BIBLIO_TRACE_SCOPE("persistenza", "BatchImporter::inserimento");
+        DuplicateDetector detector;
+        detector.indicizza(biblioteca);
+        while (analizzati.preleva(analizzato))
+        {
+            inAttesa.insert(analizzato.indice, analizzato);
+            analizzato = BloccoAnalizzato();
+            while (!inAttesa.isEmpty() && inAttesa.firstKey() == prossimo)
+            {
+                if (annullato())
+                {
+                    throw OperazioneAnnullataException();
+                }
+                const BloccoAnalizzato blocco = inAttesa.take(prossimo++);
+                finestra.release();
+
+                report.record += blocco.record;
+                report.scartati += blocco.scartati;
+                for (const ErroreRiga &erroreRiga : blocco.errori)
+                {
+                    if (report.errori.size() >= opzioni.maxErrori)
+                    {
+                        break;
+                    }
+                    report.errori.append(erroreRiga);
+                }
+
+                // DuplicateDetector::importa() diventa proprietario dei Media
+                const Deduplicazione::Report parziale = detector.importa(biblioteca, blocco.media, opzioni.politica);
+                Deduplicazione::Report &totale = report.deduplicazione;
+                totale.esaminati += parziale.esaminati;
+                totale.aggiunti += parziale.aggiunti;
+                totale.rifiutati += parziale.rifiutati;
+                totale.uniti += parziale.uniti;
+                totale.segnalati += parziale.segnalati;
+                totale.duplicati.append(parziale.duplicati);
+            }
+        }
+        if (annullato())
+        {
+            throw OperazioneAnnullataException();
+        }
+    }
+    catch (...)
+    {
+        errore = std::current_exception();
+        interrotto = true;
+        daAnalizzare.chiudi();
+        analizzati.chiudi();
+        finestra.release(dimensioneFinestra);
+    }
+
+    pool.waitForDone();
+    // Blocchi analizzati ma non inseriti (interruzione o errore in un altro
+    // stadio): i Media restano a carico dell'importatore
+    while (analizzati.preleva(analizzato))
+    {
+        qDeleteAll(analizzato.media);
+    }
+    for (const BloccoAnalizzato &blocco : inAttesa)
+    {
+        qDeleteAll(blocco.media);
+    }
+    if (errore)
+    {
+        std::rethrow_exception(errore);
+    }
+    if (erroreThread)
+    {
+        std::rethrow_exception(erroreThread);
+    }
+
+    const qint64 ns = qMax(qint64(1), timer.nsecsElapsed());
+    Metrics::counter("importazione.record").add(report.record);
+    Metrics::counter("importazione.scartati").add(report.scartati);
+    Metrics::gauge("importazione.record_al_secondo").set(report.record * 1000000000 / ns);
+    return report;
+}
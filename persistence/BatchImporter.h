@@ -0,0 +1,88 @@
+#ifndef BATCHIMPORTER_H
+#define BATCHIMPORTER_H
+
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include "../model/Biblioteca.h"
+#include "../model/DuplicateDetector.h"
+#include "../model/Exceptions.h"
+
+class QIODevice;
+
+/**
+ * BatchImporter - Importazione a pipeline di flussi CSV, JSON-lines e MARC
+ *
+ * Tre stadi collegati da code limitate (BoundedQueue):
+ *   - un thread di lettura divide l'ingresso in record e li raggruppa in blocchi;
+ *   - più thread di analisi costruiscono i Media con MediaFactory::tryCreateBook,
+ *     tryCreateFilm e tryCreateMagazineArticle (stessa validazione delle versioni
+ *     che lanciano), registrando gli errori per riga;
+ *   - il thread chiamante inserisce i blocchi nella biblioteca, nell'ordine del
+ *     file, tramite DuplicateDetector::importa() (inserimento in blocco).
+ * Se i consumatori rallentano, le code piene fermano la lettura; il numero di
+ * blocchi letti e non ancora inseriti è limitato anche quando un blocco resta
+ * indietro, quindi la memoria usata non dipende dalla dimensione del file.
+ *
+ * Formati (record per riga salvo dove indicato):
+ *   - CSV: prima riga con i nomi delle colonne, uguali alle chiavi JSON dei Media
+ *     (type, title, year, author, isbn, publisher, director, duration, genre,
+ *     magazine, doi, coverImagePath); campi tra virgolette anche su più righe.
+ *   - JSON-lines: un oggetto per riga nel formato di JsonSerializer.
+ *   - MARC: forma testuale "mnemonica" (.mrk), record separati da una riga vuota,
+ *     campi "=TAG  indicatori$asottocampo". Il tipo viene dal leader
+ *     (posizione 6 'g' = Film; livello 'a'/'b' in posizione 7 = articolo).
+ *
+ * Gli osservatori non sono previsti: l'importazione è pensata per job senza
+ * interfaccia. I blocchi già inseriti restano nella biblioteca se l'importazione
+ * viene annullata o fallisce.
+ */
+class BatchImporter
+{
+public:
+    enum class Formato
+    {
+        Csv,
+        JsonLines,
+        Marc
+    };
+
+    struct Opzioni
+    {
+        // Thread di analisi; 0 = QThread::idealThreadCount()
+        int analizzatori = 0;
+        int recordPerBlocco = 2048;
+        // Blocchi in ogni coda per ogni thread di analisi
+        int blocchiPerAnalizzatore = 2;
+        char separatore = ',';
+        Deduplicazione::Politica politica = Deduplicazione::Politica::RIFIUTA;
+        // Errori conservati nel report (il conteggio resta completo)
+        int maxErrori = 1000;
+        const std::atomic<bool> *annullato = nullptr;
+    };
+
+    struct ErroreRiga
+    {
+        qint64 riga; // prima riga del record nel file, da 1
+        QString messaggio;
+    };
+
+    struct Report
+    {
+        qint64 record = 0;
+        int scartati = 0;
+        Deduplicazione::Report deduplicazione;
+        QVector<ErroreRiga> errori;
+    };
+
+    // Formato dall'estensione (.csv, .jsonl/.ndjson, .mrk); false se non riconosciuta
+    static bool formatoDaPath(const QString &filePath, Formato *formato);
+
+    // @throws FileNotFoundException, InvalidDataException (intestazione CSV),
+    //         OperazioneAnnullataException
+    static Report importaThrows(Biblioteca &biblioteca, const QString &filePath, const Opzioni &opzioni);
+    static Report importaThrows(Biblioteca &biblioteca, QIODevice &sorgente, Formato formato,
+                                const Opzioni &opzioni);
+};
+
+#endif // BATCHIMPORTER_H
@@ -0,0 +1,146 @@
+#include "BlockCompression.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QVector>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+const QByteArray BlockCompression::Magic = QByteArrayLiteral("BVZ1");
+const QString BlockCompression::Estensione = QStringLiteral(".bvz");
+
+namespace
+{
+    void scriviIntero(QByteArray &out, quint32 valore)
+    {
+        uchar byte[4];
+        qToBigEndian<quint32>(valore, byte);
+        out.append(reinterpret_cast<const char *>(byte), 4);
+    }
+
+    quint32 leggiIntero(const QByteArray &data, int posizione)
+    {
+        return qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(data.constData()) + posizione);
+    }
+
+    struct Blocco
+    {
+        int inizio;
+        int byte;
+        int originali;
+    };
+}
+
+bool BlockCompression::isCompresso(const QByteArray &data)
+{
+    return data.startsWith(Magic);
+}
+
+bool BlockCompression::isCompressoPath(const QString &filePath)
+{
+    return filePath.endsWith(Estensione, Qt::CaseInsensitive);
+}
+
+/**
+ * Comprime i blocchi in parallelo e li concatena nell'ordine originale.
+ */
+QByteArray BlockCompression::comprimi(const QByteArray &data, int livello, int dimensioneBlocco)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "BlockCompression::comprimi");
+    dimensioneBlocco = qMax(1, dimensioneBlocco);
+    QVector<QFuture<QByteArray>> blocchi;
+    for (int inizio = 0; inizio < data.size(); inizio += dimensioneBlocco)
+    {
+        const int byte = qMin(dimensioneBlocco, data.size() - inizio);
+        blocchi.append(QtConcurrent::run([&data, inizio, byte, livello]()
+                                         { return qCompress(reinterpret_cast<const uchar *>(data.constData()) + inizio,
+                                                            byte, livello); }));
+    }
+
+    QByteArray out = Magic;
+    scriviIntero(out, quint32(blocchi.size()));
+    for (QFuture<QByteArray> &blocco : blocchi)
+    {
+        const QByteArray compresso = blocco.result();
+        scriviIntero(out, quint32(compresso.size()));
+        out.append(compresso);
+    }
+    Metrics::counter("compressione.byte_risparmiati").add(qMax(0, data.size() - out.size()));
+    return out;
+}
+
+/**
+ * Legge l'indice dei blocchi dall'intestazione, poi li decomprime in parallelo
+ * copiando ognuno nella sua posizione del risultato, allocato una volta sola.
+ */
+QByteArray BlockCompression::decomprimi(const QByteArray &data)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "BlockCompression::decomprimi");
+    Metrics::ScopedLatency misura(Metrics::histogram("decompressione.durata_us"));
+    if (!isCompresso(data) || data.size() < Magic.size() + 4)
+    {
+        throw InvalidDataException("intestazione del file compresso");
+    }
+
+    const quint32 numeroBlocchi = leggiIntero(data, Magic.size());
+    QVector<Blocco> blocchi;
+    qint64 totale = 0;
+    int posizione = Magic.size() + 4;
+    for (quint32 i = 0; i < numeroBlocchi; ++i)
+    {
+        // Ogni blocco qCompress inizia con la sua lunghezza originale (4 byte)
+        if (data.size() - posizione < 4)
+        {
+            throw InvalidDataException("file compresso troncato");
+        }
+        const quint32 byte = leggiIntero(data, posizione);
+        posizione += 4;
+        if (byte < 4 || quint32(data.size() - posizione) < byte)
+        {
+            throw InvalidDataException("file compresso troncato");
+        }
+        const int originali = int(leggiIntero(data, posizione));
+        if (originali < 0)
+        {
+            throw InvalidDataException("dimensione del file compresso");
+        }
+        blocchi.append(Blocco{posizione, int(byte), originali});
+        totale += originali;
+        posizione += int(byte);
+    }
+    if (posizione != data.size() || totale > std::numeric_limits<int>::max())
+    {
+        throw InvalidDataException("dimensione del file compresso");
+    }
+
+    QByteArray out(int(totale), Qt::Uninitialized);
+    char *destinazione = out.data();
+    QVector<QFuture<bool>> lavori;
+    qint64 offset = 0;
+    for (const Blocco &blocco : blocchi)
+    {
+        lavori.append(QtConcurrent::run([&data, blocco, destinazione, offset]()
+                                        {
+            const QByteArray chiaro = qUncompress(reinterpret_cast<const uchar *>(data.constData()) + blocco.inizio,
+                                                  blocco.byte);
+            if (chiaro.size() != blocco.originali)
+            {
+                return false;
+            }
+            std::memcpy(destinazione + offset, chiaro.constData(), std::size_t(chiaro.size()));
+            return true; }));
+        offset += blocco.originali;
+    }
+
+    bool integro = true;
+    for (QFuture<bool> &lavoro : lavori)
+    {
+        integro = lavoro.result() && integro;
+    }
+    if (!integro)
+    {
+        throw InvalidDataException("blocco compresso danneggiato");
+    }
+    return out;
+}
@@ -0,0 +1,46 @@
+#ifndef BLOCKCOMPRESSION_H
+#define BLOCKCOMPRESSION_H
+
+#include <QByteArray>
+#include <QString>
+#include "../model/Exceptions.h"
+
+/**
+ * BlockCompression - Compressione a blocchi indipendenti dei file di biblioteca
+ *
+ * Il documento è diviso in blocchi da dimensioneBlocco byte, compressi ognuno
+ * con qCompress() (zlib). Formato, interi a 32 bit big-endian:
+ *
+ *   "BVZ1" | numero blocchi | per ogni blocco: byte compressi | dati qCompress
+ *
+ * I blocchi non dipendono l'uno dall'altro, quindi compressione e
+ * decompressione procedono in parallelo sul pool globale; l'intestazione
+ * permette di riconoscere il formato dai primi byte, indipendentemente
+ * dall'estensione del file.
+ *
+ * Limite: non è una compressione in streaming. decomprimi() riceve l'intero
+ * file compresso e produce il documento in un solo QByteArray, quindi durante
+ * il caricamento entrambi stanno in memoria e il documento decompresso non può
+ * superare 2 GiB (INT_MAX byte); oltre viene rifiutato con InvalidDataException.
+ * Il parser JSON di Qt richiede comunque il documento intero. I cataloghi più
+ * grandi vanno divisi in shard (ShardedCatalog), ognuno letto da solo.
+ */
+class BlockCompression
+{
+public:
+    static const QByteArray Magic;
+    // Estensione con cui l'interfaccia sceglie il salvataggio compresso
+    static const QString Estensione;
+    static const int DimensioneBlocco = 1 << 20;
+
+    static bool isCompresso(const QByteArray &data);
+    static bool isCompressoPath(const QString &filePath);
+
+    // livello come per qCompress(): -1 predefinito di zlib, 0-9 altrimenti
+    static QByteArray comprimi(const QByteArray &data, int livello = -1, int dimensioneBlocco = DimensioneBlocco);
+    // @throws InvalidDataException se l'intestazione o un blocco sono danneggiati,
+    //         o se il documento decompresso supera INT_MAX byte
+    static QByteArray decomprimi(const QByteArray &data);
+};
+
+#endif // BLOCKCOMPRESSION_H
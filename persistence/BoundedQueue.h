@@ -0,0 +1,77 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <deque>
+#include <utility>
+
+/**
+ * BoundedQueue - Coda a capacità limitata tra thread produttori e consumatori
+ *
+ * inserisci() attende finché c'è spazio, quindi un produttore più veloce dei
+ * consumatori viene rallentato invece di accumulare dati in memoria.
+ * Dopo chiudi() gli inserimenti falliscono e i prelievi restituiscono gli
+ * elementi rimasti, poi false.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(int capacita) : capacita(std::size_t(qMax(1, capacita))) {}
+
+    // false se la coda è stata chiusa: il valore non viene spostato e resta al chiamante
+    bool inserisci(T &&valore)
+    {
+        QMutexLocker locker(&mutex);
+        while (elementi.size() >= capacita && !chiusa)
+        {
+            nonPiena.wait(&mutex);
+        }
+        if (chiusa)
+        {
+            return false;
+        }
+        elementi.push_back(std::move(valore));
+        nonVuota.wakeOne();
+        return true;
+    }
+
+    // false quando la coda è chiusa e vuota
+    bool preleva(T &valore)
+    {
+        QMutexLocker locker(&mutex);
+        while (elementi.empty() && !chiusa)
+        {
+            nonVuota.wait(&mutex);
+        }
+        if (elementi.empty())
+        {
+            return false;
+        }
+        valore = std::move(elementi.front());
+        elementi.pop_front();
+        nonPiena.wakeOne();
+        return true;
+    }
+
+    void chiudi()
+    {
+        QMutexLocker locker(&mutex);
+        chiusa = true;
+        nonVuota.wakeAll();
+        nonPiena.wakeAll();
+    }
+
+private:
+    const std::size_t capacita;
+    std::deque<T> elementi;
+    bool chiusa = false;
+    QMutex mutex;
+    QWaitCondition nonVuota;
+    QWaitCondition nonPiena;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,352 @@
+#include "Journal.h"
+#include "JsonSerializer.h"
+#include "../model/MediaFactory.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const QString ChiaveOperazione = QStringLiteral("op");
+    const QString ChiaveIndice = QStringLiteral("indice");
+    const QString ChiaveMedia = QStringLiteral("media");
+    const QString OpAggiungi = QStringLiteral("aggiungi");
+    const QString OpModifica = QStringLiteral("modifica");
+    const QString OpRimuovi = QStringLiteral("rimuovi");
+
+    // QFile::flush() svuota solo il buffer di Qt: serve anche quello del sistema operativo
+    bool sincronizza(QFile &file)
+    {
+        if (!file.flush())
+        {
+            return false;
+        }
+#ifdef Q_OS_WIN
+        return _commit(file.handle()) == 0;
+#else
+        return ::fsync(file.handle()) == 0;
+#endif
+    }
+
+    struct Riapplicazione
+    {
+        int record = 0;
+        qint64 byteValidi = 0; // fine dell'ultimo record applicato
+        bool completa = true;
+    };
+
+    // Applica un record; false se il record non è valido per lo stato corrente
+    bool applica(Biblioteca &biblioteca, const QJsonObject &record)
+    {
+        const QString op = record[ChiaveOperazione].toString();
+        const int indice = record[ChiaveIndice].toInt(-1);
+        if (op == OpRimuovi)
+        {
+            if (indice < 0 || indice >= biblioteca.dimensione())
+            {
+                return false;
+            }
+            biblioteca.rimuoviMediaAt(indice);
+            return true;
+        }
+
+        if (op != OpAggiungi && op != OpModifica)
+        {
+            return false;
+        }
+        Result<Media *> media = MediaFactory::tryCreateFromJson(record[ChiaveMedia].toObject());
+        if (!media || !media.value())
+        {
+            return false;
+        }
+        if (op == OpAggiungi)
+        {
+            biblioteca.aggiungiMedia(media.value());
+            return true;
+        }
+        if (indice < 0 || indice >= biblioteca.dimensione())
+        {
+            delete media.value();
+            return false;
+        }
+        biblioteca.sostituisciMediaAt(indice, media.value());
+        return true;
+    }
+
+    /**
+     * Riapplica le righe di un file. Solo una riga senza a capo in fondo è il
+     * segno di una scrittura interrotta: il record non era stato confermato e
+     * viene scartato. Una riga completa non valida indica un journal danneggiato
+     * o non coerente con lo snapshot, e il ripristino si ferma.
+     * @throws JsonParseException se una riga completa non può essere riapplicata
+     */
+    Riapplicazione riapplicaFile(Biblioteca &biblioteca, const QString &filePath)
+    {
+        Riapplicazione esito;
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            throw FileNotFoundException(filePath.toStdString());
+        }
+        const QByteArray data = file.readAll();
+
+        int inizio = 0;
+        while (inizio < data.size())
+        {
+            const int fine = data.indexOf('\n', inizio);
+            if (fine < 0)
+            {
+                esito.completa = false;
+                break;
+            }
+            QJsonParseError errore;
+            const QJsonDocument riga = QJsonDocument::fromJson(data.mid(inizio, fine - inizio), &errore);
+            if (errore.error != QJsonParseError::NoError || !riga.isObject() || !applica(biblioteca, riga.object()))
+            {
+                throw JsonParseException("Record " + std::to_string(esito.record + 1) + " non valido nel journal: " +
+                                         filePath.toStdString());
+            }
+            ++esito.record;
+            inizio = fine + 1;
+            esito.byteValidi = inizio;
+        }
+        return esito;
+    }
+}
+
+/**
+ * La generazione iniziale è la più alta già presente su disco (journal o copie
+ * dello snapshot): una sessione nuova che compatta senza ripristinare scrive
+ * così sopra tutte le generazioni precedenti, che vengono poi eliminate invece
+ * di essere riapplicate a una biblioteca diversa.
+ */
+Journal::Journal(const QString &snapshotPath, int copieSnapshot)
+    : snapshot(snapshotPath), rotazione(snapshotPath, copieSnapshot)
+{
+    const QList<qint64> generazioni = generazioniSuDisco();
+    if (!generazioni.isEmpty())
+    {
+        generazioneCorrente = generazioni.last();
+    }
+    for (int indice = 0; indice < rotazione.copie(); ++indice)
+    {
+        if (QFileInfo::exists(rotazione.filePath(indice)))
+        {
+            generazioneCorrente = qMax(generazioneCorrente, rotazione.generazioneJournal(indice));
+        }
+    }
+}
+
+Journal::~Journal()
+{
+    try
+    {
+        commit();
+    }
+    catch (const BibliotecaException &e)
+    {
+        qDebug() << "Journal non salvato:" << e.what();
+    }
+}
+
+QString Journal::filePath(qint64 generazione) const
+{
+    return snapshot + ".journal." + QString::number(generazione);
+}
+
+QList<qint64> Journal::generazioniSuDisco() const
+{
+    const QFileInfo info(snapshot);
+    const QString prefisso = info.fileName() + ".journal.";
+    QList<qint64> generazioni;
+    const QStringList nomi = info.dir().entryList(QStringList{prefisso + "*"}, QDir::Files);
+    for (const QString &nome : nomi)
+    {
+        bool ok = false;
+        const qint64 generazione = nome.mid(prefisso.size()).toLongLong(&ok);
+        if (ok)
+        {
+            generazioni.append(generazione);
+        }
+    }
+    std::sort(generazioni.begin(), generazioni.end());
+    return generazioni;
+}
+
+int Journal::ripristina(Biblioteca &biblioteca)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "Journal::ripristina");
+    commit();
+    file.close();
+
+    Biblioteca ripristinata;
+    qint64 generazioneSnapshot = 0;
+    const int copia = rotazione.piuRecenteValida();
+    if (copia >= 0)
+    {
+        if (copia > 0)
+        {
+            qDebug() << "Snapshot più recente non valido, ripristino dalla copia" << rotazione.filePath(copia);
+        }
+        JsonSerializer::Avanzamento opzioni;
+        opzioni.campiDifferiti = caricamentoDifferito;
+        JsonSerializer::caricaBibliotecaThrows(ripristinata, rotazione.filePath(copia), opzioni, &generazioneSnapshot);
+    }
+
+    // Stato del journal aggiornato solo a ripristino riuscito
+    qint64 ultimaGenerazione = generazioneSnapshot;
+    int recordUltima = 0;
+    int applicati = 0;
+    for (qint64 generazione : generazioniSuDisco())
+    {
+        if (generazione < generazioneSnapshot)
+        {
+            // Già contenuta nello snapshot (compattazione interrotta prima di eliminarla,
+            // oppure conservata per le copie precedenti)
+            continue;
+        }
+        // Un record non valido interrompe qui il ripristino: file e biblioteca restano intatti
+        const Riapplicazione esito = riapplicaFile(ripristinata, filePath(generazione));
+        if (!esito.completa)
+        {
+            // Si riparte dall'ultimo record valido, così le nuove righe non seguono un frammento
+            qDebug() << "Journal troncato dopo" << esito.record << "record:" << filePath(generazione);
+            QFile::resize(filePath(generazione), esito.byteValidi);
+        }
+        applicati += esito.record;
+        ultimaGenerazione = generazione;
+        recordUltima = esito.record;
+    }
+
+    generazioneCorrente = ultimaGenerazione;
+    recordCorrenti = recordUltima;
+
+    eliminaGenerazioniPrecedenti(generazioneSnapshot);
+    biblioteca.swap(ripristinata);
+    Metrics::counter("journal.record_riapplicati").add(applicati);
+    return applicati;
+}
+
+void Journal::registraAggiunta(const Media &media)
+{
+    QJsonObject record;
+    record[ChiaveOperazione] = OpAggiungi;
+    record[ChiaveMedia] = media.serializza();
+    accoda(record);
+}
+
+void Journal::registraModifica(int indice, const Media &media)
+{
+    QJsonObject record;
+    record[ChiaveOperazione] = OpModifica;
+    record[ChiaveIndice] = indice;
+    record[ChiaveMedia] = media.serializza();
+    accoda(record);
+}
+
+void Journal::registraRimozione(int indice)
+{
+    QJsonObject record;
+    record[ChiaveOperazione] = OpRimuovi;
+    record[ChiaveIndice] = indice;
+    accoda(record);
+}
+
+void Journal::accoda(const QJsonObject &record)
+{
+    buffer.append(QJsonDocument(record).toJson(QJsonDocument::Compact));
+    buffer.append('\n');
+    ++inSospeso;
+    ++recordCorrenti;
+}
+
+/**
+ * Group commit: tutti i record accodati dall'ultimo commit vengono scritti
+ * insieme e sincronizzati con un solo fsync.
+ * @throws BibliotecaException se la scrittura o la sincronizzazione fallisce;
+ *         i record restano in sospeso per il commit successivo
+ */
+void Journal::commit()
+{
+    if (buffer.isEmpty())
+    {
+        return;
+    }
+    BIBLIO_TRACE_SCOPE("persistenza", "Journal::commit");
+    Metrics::ScopedLatency misura(Metrics::histogram("journal.commit_us"));
+
+    if (!file.isOpen())
+    {
+        QDir().mkpath(QFileInfo(snapshot).path());
+        file.setFileName(filePath(generazioneCorrente));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+        {
+            throw FileNotFoundException("Impossibile aprire il journal: " + file.fileName().toStdString());
+        }
+    }
+    const qint64 inizio = file.size();
+    if (file.write(buffer) != buffer.size() || !sincronizza(file))
+    {
+        // Nessun record parziale resta nel file: il prossimo commit riscrive l'intero buffer
+        const std::string errore = file.errorString().toStdString();
+        file.close();
+        QFile::resize(filePath(generazioneCorrente), inizio);
+        throw BibliotecaException("Errore durante la scrittura del journal: " + errore);
+    }
+
+    Metrics::counter("journal.record").add(inSospeso);
+    Metrics::counter("journal.byte").add(buffer.size());
+    buffer.clear();
+    inSospeso = 0;
+}
+
+qint64 Journal::nuovaGenerazione()
+{
+    commit();
+    file.close();
+    ++generazioneCorrente;
+    recordCorrenti = 0;
+    return generazioneCorrente;
+}
+
+void Journal::snapshotCompletato(qint64 generazione)
+{
+    eliminaGenerazioniPrecedenti(generazione);
+}
+
+/**
+ * Elimina le generazioni precedenti a generazione, tranne quelle che servono
+ * a ripartire da una copia più vecchia dello snapshot.
+ */
+void Journal::eliminaGenerazioniPrecedenti(qint64 generazione)
+{
+    const qint64 minimaCopie = rotazione.generazioneMinima();
+    const qint64 limite = minimaCopie < 0 ? generazione : qMin(generazione, minimaCopie);
+    for (qint64 vecchia : generazioniSuDisco())
+    {
+        if (vecchia < limite)
+        {
+            QFile::remove(filePath(vecchia));
+        }
+    }
+}
+
+void Journal::compatta(const Biblioteca &biblioteca)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "Journal::compatta");
+    const qint64 generazione = nuovaGenerazione();
+    rotazione.scrivi(JsonSerializer::serializzaIstantanea(biblioteca.istantanea(), generazione), generazione);
+    snapshotCompletato(generazione);
+    Metrics::counter("journal.compattazioni").add();
+}
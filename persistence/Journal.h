@@ -0,0 +1,106 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include "../model/Biblioteca.h"
+#include "../model/Exceptions.h"
+#include "SnapshotRotation.h"
+
+/**
+ * Journal - Registro append-only delle modifiche alla biblioteca
+ *
+ * Accanto a uno snapshot completo (il file JSON di JsonSerializer) registra le
+ * operazioni successive come righe JSON compatte, una per record:
+ *
+ *   {"op":"aggiungi","media":{...}}
+ *   {"op":"modifica","indice":12,"media":{...}}
+ *   {"op":"rimuovi","indice":12}
+ *
+ * Gli indici sono le posizioni nella biblioteca al momento dell'operazione,
+ * quindi la riapplicazione in ordine ricostruisce esattamente gli stessi slot.
+ *
+ * I record restano in memoria finché commit() non li scrive con una sola
+ * write seguita da fsync (group commit): salvare una modifica costa i byte
+ * del suo record, non quelli della biblioteca.
+ *
+ * Il registro è diviso in generazioni, ognuna in un file <snapshot>.journal.<n>.
+ * Lo snapshot registra la generazione che lo segue; per compattare si passa a
+ * una nuova generazione (nuovaGenerazione()), si scrive lo snapshot con quel
+ * numero, anche in background, e solo a scrittura completata si eliminano le
+ * generazioni non più necessarie (snapshotCompletato()). Il ripristino applica
+ * tutte le generazioni a partire da quella dello snapshot: un'interruzione in
+ * qualunque momento della compattazione non perde né duplica record.
+ *
+ * Lo snapshot è tenuto in più copie a rotazione (SnapshotRotation): il
+ * ripristino parte dalla più recente che supera la verifica del checksum, e
+ * le generazioni vengono eliminate solo quando nessuna copia conservata ne ha
+ * più bisogno.
+ */
+class Journal
+{
+public:
+    explicit Journal(const QString &snapshotPath, int copieSnapshot = 1);
+    // Esegue commit() dei record in sospeso
+    ~Journal();
+
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+
+    /**
+     * Carica la copia valida più recente dello snapshot (se esiste) e
+     * riapplica i journal successivi.
+     * Le nuove operazioni vengono registrate nell'ultima generazione trovata.
+     * @return Numero di record riapplicati
+     * @throws JsonParseException se lo snapshot non è valido o se una riga completa
+     *         del journal non può essere riapplicata (biblioteca e file non modificati)
+     */
+    int ripristina(Biblioteca &biblioteca);
+    // Snapshot caricato in modalità differita (JsonSerializer::Avanzamento::campiDifferiti)
+    void setCaricamentoDifferito(bool attivo) { caricamentoDifferito = attivo; }
+
+    // indice è la posizione del Media nella biblioteca quando l'operazione avviene;
+    // la modifica registra il Media con i valori nuovi
+    void registraAggiunta(const Media &media);
+    void registraModifica(int indice, const Media &media);
+    void registraRimozione(int indice);
+
+    // Scrive e sincronizza su disco i record in sospeso
+    void commit();
+
+    // Passa a una nuova generazione (vuota) e ne restituisce il numero:
+    // lo snapshot da scrivere deve riportarlo in "generazioneJournal"
+    qint64 nuovaGenerazione();
+    // Elimina le generazioni che non servono più né allo snapshot appena scritto
+    // né alle copie precedenti conservate
+    void snapshotCompletato(qint64 generazione);
+    // Compattazione sincrona: nuovaGenerazione(), rotazione dello snapshot, snapshotCompletato()
+    void compatta(const Biblioteca &biblioteca);
+
+    qint64 generazione() const { return generazioneCorrente; }
+    // Record registrati nella generazione corrente, commit o no
+    int recordGenerazione() const { return recordCorrenti; }
+    int recordInSospeso() const { return inSospeso; }
+    QString snapshotPath() const { return snapshot; }
+    int copieSnapshot() const { return rotazione.copie(); }
+    QString filePath(qint64 generazione) const;
+
+private:
+    void accoda(const QJsonObject &record);
+    QList<qint64> generazioniSuDisco() const;
+    void eliminaGenerazioniPrecedenti(qint64 generazione);
+
+    QString snapshot;
+    SnapshotRotation rotazione;
+    qint64 generazioneCorrente = 0;
+    int recordCorrenti = 0;
+    int inSospeso = 0;
+    bool caricamentoDifferito = false;
+    QByteArray buffer;
+    QFile file;
+};
+
+#endif // JOURNAL_H
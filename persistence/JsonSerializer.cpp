@@ -1,8 +1,19 @@
 #include "JsonSerializer.h"
+#include "ShardedCatalog.h"
+#include "BlockCompression.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QElapsedTimer>
 #include <QFile>
+#include <QSaveFile>
 #include <QJsonParseError>
 #include <QDebug>
 
+namespace
+{
+    const QString ChiaveGenerazioneJournal = QStringLiteral("generazioneJournal");
+}
+
 bool JsonSerializer::salvaBiblioteca(const Biblioteca &biblioteca, const QString &filePath)
 {
     try
@@ -31,38 +42,178 @@ bool JsonSerializer::caricaBiblioteca(Biblioteca &biblioteca, const QString &fil
 
 void JsonSerializer::salvaBibliotecaThrows(const Biblioteca &biblioteca, const QString &filePath)
 {
+    BIBLIO_TRACE_SCOPE("persistenza", "JsonSerializer::salva");
     QJsonObject jsonObject;
-    jsonObject["biblioteca"] = serializeMediaList(biblioteca.getTuttiMedia());
+    {
+        BIBLIO_TRACE_SCOPE("persistenza", "salva/serializza");
+        jsonObject["biblioteca"] = biblioteca.serializzaMedia();
+    }
+
+    QByteArray data;
+    {
+        BIBLIO_TRACE_SCOPE("persistenza", "salva/toJson");
+        data = QJsonDocument(jsonObject).toJson();
+    }
+    if (BlockCompression::isCompressoPath(filePath))
+    {
+        data = BlockCompression::comprimi(data);
+    }
+
+    scriviFileAtomico(filePath, data);
+}
 
-    QJsonDocument jsonDoc(jsonObject);
+/**
+ * Serializza un'istantanea per valore (vedi Biblioteca::istantanea()).
+ * Non accede alla biblioteca, quindi può essere eseguita in un altro thread.
+ * @return Documento JSON nello stesso formato di salvaBibliotecaThrows()
+ */
+QByteArray JsonSerializer::serializzaIstantanea(const MediaStore &valori, qint64 generazioneJournal)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "salva/serializzaIstantanea");
+    QJsonObject jsonObject;
+    jsonObject["biblioteca"] = valori.toJson();
+    if (generazioneJournal >= 0)
+    {
+        jsonObject[ChiaveGenerazioneJournal] = generazioneJournal;
+    }
+    return QJsonDocument(jsonObject).toJson();
+}
 
-    QFile file(filePath);
+/**
+ * Scrive il file in modo atomico: i dati vanno in un file temporaneo nella
+ * stessa cartella e QSaveFile::commit() lo sincronizza su disco prima di
+ * rinominarlo sul file di destinazione. Un'interruzione durante la scrittura
+ * lascia intatta la versione precedente.
+ */
+void JsonSerializer::scriviFileAtomico(const QString &filePath, const QByteArray &data)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "salva/scrittura");
+    QSaveFile file(filePath);
     if (!file.open(QIODevice::WriteOnly))
     {
         throw FileNotFoundException("Impossibile aprire file per scrittura: " + filePath.toStdString());
     }
 
-    qint64 bytesWritten = file.write(jsonDoc.toJson());
-    if (bytesWritten == -1)
+    if (file.write(data) != data.size() || !file.commit())
     {
-        throw BibliotecaException("Errore durante la scrittura del file: " + filePath.toStdString());
+        file.cancelWriting();
+        throw BibliotecaException("Errore durante la scrittura del file: " + filePath.toStdString() +
+                                  " (" + file.errorString().toStdString() + ")");
     }
-    file.close();
 }
 
 void JsonSerializer::caricaBibliotecaThrows(Biblioteca &biblioteca, const QString &filePath)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly))
+    caricaBibliotecaThrows(biblioteca, filePath, Avanzamento());
+}
+
+/**
+ * Caricamento con avanzamento e annullamento, pensato per un thread di lavoro.
+ * L'avanzamento è riportato in byte durante la lettura e in record durante la
+ * deserializzazione; l'annullamento è controllato tra un blocco e l'altro.
+ */
+void JsonSerializer::caricaBibliotecaThrows(Biblioteca &biblioteca, const QString &filePath,
+                                            const Avanzamento &avanzamento, qint64 *generazioneJournal)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "JsonSerializer::carica");
+    QElapsedTimer timer;
+    timer.start();
+    QList<Media *> mediaList = leggiMediaDaFile(filePath, &avanzamento, generazioneJournal);
+    try
+    {
+        avanzamento.verifica();
+    }
+    catch (...)
     {
-        throw FileNotFoundException(filePath.toStdString());
+        qDeleteAll(mediaList);
+        throw;
     }
 
-    QByteArray data = file.readAll();
-    file.close();
+    // Inserimento in blocco: una sola validazione e indici ricostruiti una volta.
+    // Avviene in una biblioteca locale, scambiata con la destinazione solo a
+    // inserimento riuscito: in caso di errore la destinazione resta invariata
+    BIBLIO_TRACE_SCOPE("persistenza", "carica/inserimento");
+    Biblioteca caricata;
+    try
+    {
+        caricata.aggiungiMediaBulkTransazionale(mediaList);
+    }
+    catch (...)
+    {
+        qDeleteAll(mediaList);
+        throw;
+    }
+    biblioteca.swap(caricata);
+
+    // Throughput dell'ultimo caricamento, lettura e parsing compresi
+    const qint64 ns = qMax(qint64(1), timer.nsecsElapsed());
+    Metrics::counter("caricamento.elementi").add(mediaList.size());
+    Metrics::gauge("caricamento.elementi_al_secondo").set(qint64(mediaList.size()) * 1000000000 / ns);
+    Metrics::histogram("caricamento.durata_us").record(ns / 1000);
+}
+
+Deduplicazione::Report JsonSerializer::importaBibliotecaThrows(Biblioteca &biblioteca, const QString &filePath,
+                                                               Deduplicazione::Politica politica)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "JsonSerializer::importa");
+    QList<Media *> mediaList = leggiMediaDaFile(filePath);
+
+    DuplicateDetector detector;
+    detector.indicizza(biblioteca);
+    return detector.importa(biblioteca, mediaList, politica);
+}
+
+QList<Media *> JsonSerializer::leggiMediaDaFile(const QString &filePath, const Avanzamento *avanzamento,
+                                                qint64 *generazioneJournal)
+{
+    QByteArray data;
+    {
+        BIBLIO_TRACE_SCOPE("persistenza", "carica/lettura");
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            throw FileNotFoundException(filePath.toStdString());
+        }
+        if (!avanzamento)
+        {
+            data = file.readAll();
+        }
+        else
+        {
+            // Lettura a blocchi per riportare i byte letti e controllare l'annullamento
+            const qint64 totale = file.size();
+            const qint64 Blocco = 1 << 20;
+            data.reserve(int(totale));
+            while (!file.atEnd())
+            {
+                avanzamento->verifica();
+                const QByteArray parte = file.read(Blocco);
+                if (parte.isEmpty())
+                {
+                    break;
+                }
+                data.append(parte);
+                if (avanzamento->lettura)
+                {
+                    avanzamento->lettura(data.size(), totale);
+                }
+            }
+            avanzamento->verifica();
+        }
+    }
+
+    // Il formato compresso si riconosce dai primi byte, non dall'estensione
+    if (BlockCompression::isCompresso(data))
+    {
+        data = BlockCompression::decomprimi(data);
+    }
 
     QJsonParseError parseError;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &parseError);
+    QJsonDocument jsonDoc;
+    {
+        BIBLIO_TRACE_SCOPE("persistenza", "carica/parsing");
+        jsonDoc = QJsonDocument::fromJson(data, &parseError);
+    }
 
     if (parseError.error != QJsonParseError::NoError)
     {
@@ -70,56 +221,109 @@ void JsonSerializer::caricaBibliotecaThrows(Biblioteca &biblioteca, const QStrin
     }
 
     QJsonObject jsonObject = jsonDoc.object();
+    if (ShardedCatalog::isManifest(jsonObject))
+    {
+        // Catalogo a shard: il file letto è solo il manifest
+        if (generazioneJournal)
+        {
+            *generazioneJournal = 0;
+        }
+        return ShardedCatalog::leggiMedia(filePath, jsonObject, avanzamento);
+    }
     if (!jsonObject.contains("biblioteca"))
     {
         throw JsonParseException("Campo 'biblioteca' mancante nel JSON");
     }
 
-    QJsonArray mediaArray = jsonObject["biblioteca"].toArray();
-
-    biblioteca.svuota(); // Pulisce la biblioteca esistente
-
-    QList<Media *> mediaList = deserializeMediaList(mediaArray);
-    for (Media *media : mediaList)
+    if (generazioneJournal)
     {
-        biblioteca.aggiungiMedia(media);
+        *generazioneJournal = qint64(jsonObject[ChiaveGenerazioneJournal].toDouble(0));
     }
-}
 
-QJsonArray JsonSerializer::serializeMediaList(const QList<Media *> &mediaList)
-{
-    QJsonArray jsonArray;
-    for (const Media *media : mediaList)
-    {
-        if (media)
-        {
-            jsonArray.append(media->serializza());
-        }
-    }
-    return jsonArray;
+    QJsonArray mediaArray = jsonObject["biblioteca"].toArray();
+    return deserializeMediaList(mediaArray, avanzamento);
 }
 
-QList<Media *> JsonSerializer::deserializeMediaList(const QJsonArray &jsonArray)
+QList<Media *> JsonSerializer::deserializeMediaList(const QJsonArray &jsonArray, const Avanzamento *avanzamento)
 {
+    BIBLIO_TRACE_SCOPE("persistenza", "carica/deserializza");
+    // Ogni quanti record riportare l'avanzamento e controllare l'annullamento
+    const int PassoAvanzamento = 1024;
     QList<Media *> mediaList;
+    int scartati = 0;
+    Error primoErrore;
+    bool anteprimaInviata = !avanzamento || !avanzamento->anteprima || avanzamento->dimensioneAnteprima <= 0;
+    const bool differiti = avanzamento && avanzamento->campiDifferiti;
+    int esaminati = 0;
     for (const QJsonValue &value : jsonArray)
     {
-        if (value.isObject())
+        if (avanzamento && esaminati++ % PassoAvanzamento == 0)
         {
             try
             {
-                Media *media = MediaFactory::createFromJson(value.toObject());
-                if (media)
+                avanzamento->verifica();
+                if (avanzamento->record)
                 {
-                    mediaList.append(media);
+                    avanzamento->record(esaminati - 1, jsonArray.size());
                 }
             }
-            catch (const BibliotecaException &e)
+            catch (...)
+            {
+                qDeleteAll(mediaList);
+                throw;
+            }
+        }
+        if (!anteprimaInviata && mediaList.size() == avanzamento->dimensioneAnteprima)
+        {
+            QList<Media *> primi;
+            try
+            {
+                for (const Media *media : mediaList)
+                {
+                    primi.append(media->clone());
+                }
+                avanzamento->anteprima(primi);
+            }
+            catch (...)
+            {
+                // L'osservatore non ha preso in carico le copie
+                qDeleteAll(primi);
+                qDeleteAll(mediaList);
+                throw;
+            }
+            anteprimaInviata = true;
+        }
+        if (value.isObject())
+        {
+            // Nessuna eccezione per i record non validi: su importazioni "sporche"
+            // lo srotolamento dello stack dominerebbe il tempo di caricamento
+            Result<Media *> media = differiti ? MediaFactory::tryCreateDeferredFromJson(value.toObject())
+                                              : MediaFactory::tryCreateFromJson(value.toObject());
+            if (media && media.value())
+            {
+                mediaList.append(media.value());
+            }
+            else if (!media)
             {
-                qDebug() << "Errore nella deserializzazione di un media:" << e.what();
                 // Continua con il prossimo media invece di fallire completamente
+                if (scartati++ == 0)
+                {
+                    primoErrore = media.error();
+                }
             }
         }
     }
+
+    if (avanzamento && avanzamento->record)
+    {
+        avanzamento->record(jsonArray.size(), jsonArray.size());
+    }
+
+    // Il messaggio viene composto una sola volta, non per ogni record scartato
+    if (scartati > 0)
+    {
+        qDebug() << "Media non deserializzati:" << scartati
+                 << "- primo errore:" << primoErrore.message().c_str();
+    }
     return mediaList;
 }
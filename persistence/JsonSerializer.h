@@ -5,23 +5,72 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <atomic>
+#include <functional>
 #include "../model/Biblioteca.h"
 #include "../model/Exceptions.h"
 #include "../model/MediaFactory.h"
+#include "../model/DuplicateDetector.h"
 
 class JsonSerializer
 {
 public:
+    /**
+     * Osservatori e opzioni di un caricamento; gli osservatori sono invocati
+     * dal thread che carica. Tutti i campi sono facoltativi.
+     * Se annullato diventa true il caricamento si interrompe al primo controllo
+     * con OperazioneAnnullataException; come per ogni altro errore, la
+     * biblioteca di destinazione resta invariata.
+     */
+    struct Avanzamento
+    {
+        std::function<void(qint64 byteLetti, qint64 byteTotali)> lettura;
+        std::function<void(int record, int recordTotali)> record;
+        // Riceve copie dei primi dimensioneAnteprima Media, di cui diventa proprietario
+        std::function<void(const QList<Media *> &primi)> anteprima;
+        int dimensioneAnteprima = 0;
+        const std::atomic<bool> *annullato = nullptr;
+        // Modalità differita: i Media decodificano subito solo tipo, titolo e anno
+        // (vedi Media::differisci()); il resto alla prima lettura
+        bool campiDifferiti = false;
+
+        void verifica() const
+        {
+            if (annullato && annullato->load(std::memory_order_relaxed))
+            {
+                throw OperazioneAnnullataException();
+            }
+        }
+    };
+
     static bool salvaBiblioteca(const Biblioteca &biblioteca, const QString &filePath);
     static bool caricaBiblioteca(Biblioteca &biblioteca, const QString &filePath);
 
     // Versioni con gestione eccezioni
     static void salvaBibliotecaThrows(const Biblioteca &biblioteca, const QString &filePath);
+
+    // Serializzazione di un'istantanea per valore, eseguibile fuori dal thread della GUI.
+    // Con generazioneJournal >= 0 il file registra la generazione di Journal che lo segue.
+    static QByteArray serializzaIstantanea(const MediaStore &valori, qint64 generazioneJournal = -1);
+    // Scrittura con file temporaneo, sincronizzazione e rinomina atomica (QSaveFile)
+    static void scriviFileAtomico(const QString &filePath, const QByteArray &data);
     static void caricaBibliotecaThrows(Biblioteca &biblioteca, const QString &filePath);
+    // generazioneJournal, se indicato, riceve la generazione registrata nel file (0 se assente)
+    static void caricaBibliotecaThrows(Biblioteca &biblioteca, const QString &filePath,
+                                       const Avanzamento &avanzamento, qint64 *generazioneJournal = nullptr);
+
+    // Aggiunge il contenuto di un file alla biblioteca senza svuotarla,
+    // gestendo i duplicati secondo la politica indicata
+    static Deduplicazione::Report importaBibliotecaThrows(Biblioteca &biblioteca, const QString &filePath,
+                                                          Deduplicazione::Politica politica);
 
 private:
-    static QJsonArray serializeMediaList(const QList<Media *> &mediaList);
-    static QList<Media *> deserializeMediaList(const QJsonArray &jsonArray);
+    // Gli shard sono normali file di biblioteca deserializzati in parallelo
+    friend class ShardedCatalog;
+
+    static QList<Media *> leggiMediaDaFile(const QString &filePath, const Avanzamento *avanzamento = nullptr,
+                                           qint64 *generazioneJournal = nullptr);
+    static QList<Media *> deserializeMediaList(const QJsonArray &jsonArray, const Avanzamento *avanzamento = nullptr);
 };
 
 #endif // JSONSERIALIZER_H
@@ -0,0 +1,361 @@
+#include "ShardedCatalog.h"
+#include "BlockCompression.h"
+#include "../model/MediaSchema.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonParseError>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QVector>
+#include <QtConcurrent>
+#include <exception>
+
+const QString ShardedCatalog::EstensioneManifest = QStringLiteral(".manifest.json");
+
+namespace
+{
+    const QString ChiaveFormato = QStringLiteral("formato");
+    const QString ChiaveVersione = QStringLiteral("versione");
+    const QString ChiavePartizione = QStringLiteral("partizione");
+    const QString ChiaveShard = QStringLiteral("shard");
+    const QString ChiaveFile = QStringLiteral("file");
+    const QString ChiaveElementi = QStringLiteral("elementi");
+    const QString ChiaveByte = QStringLiteral("byte");
+    const QString ChiaveSha = QStringLiteral("sha256");
+    const QString Formato = QStringLiteral("biblio-shard");
+    const int Versione = 1;
+    // Caratteri dell'hash usati nel nome dello shard
+    const int PrefissoSha = 8;
+
+    // Nome del manifest senza estensione: prefisso comune dei suoi shard
+    QString nomeBase(const QString &manifestPath)
+    {
+        QString nome = QFileInfo(manifestPath).fileName();
+        if (nome.endsWith(ShardedCatalog::EstensioneManifest, Qt::CaseInsensitive))
+        {
+            nome.chop(ShardedCatalog::EstensioneManifest.size());
+        }
+        else if (nome.endsWith(QStringLiteral(".json"), Qt::CaseInsensitive))
+        {
+            nome.chop(5);
+        }
+        return nome;
+    }
+
+    QString percorsoShard(const QString &manifestPath, const QString &fileShard)
+    {
+        return QDir(QFileInfo(manifestPath).absolutePath()).filePath(fileShard);
+    }
+
+    int numeroShard(const ShardedCatalog::Opzioni &opzioni)
+    {
+        if (opzioni.partizione == ShardedCatalog::Partizione::Tipo)
+        {
+            return int(MediaKind::MagazineArticle) + 1;
+        }
+        return qMax(1, opzioni.numeroShard);
+    }
+
+    // Shard di destinazione: deve dipendere solo dai dati, non dall'ordine o dal processo.
+    // totaleShard è il numero già normalizzato da numeroShard()
+    int shardDi(const Media &media, ShardedCatalog::Partizione partizione, int totaleShard)
+    {
+        if (partizione == ShardedCatalog::Partizione::Tipo)
+        {
+            return int(media.tipo());
+        }
+        const uint hash = qHash(media.getTitleRef(), 0) ^ uint(media.getYear());
+        return int(hash % uint(totaleShard));
+    }
+
+    struct ShardScritto
+    {
+        QJsonObject voce;
+        bool scritto = false;
+        std::exception_ptr errore;
+    };
+}
+
+bool ShardedCatalog::isManifest(const QJsonObject &jsonObject)
+{
+    return jsonObject.value(ChiaveFormato).toString() == Formato && jsonObject.value(ChiaveShard).isArray();
+}
+
+bool ShardedCatalog::isManifestPath(const QString &filePath)
+{
+    return filePath.endsWith(EstensioneManifest, Qt::CaseInsensitive);
+}
+
+ShardedCatalog::Report ShardedCatalog::salvaThrows(const MediaStore &valori, const QString &manifestPath)
+{
+    return salvaThrows(valori, manifestPath, Opzioni());
+}
+
+ShardedCatalog::Report ShardedCatalog::salvaThrows(const Biblioteca &biblioteca, const QString &manifestPath,
+                                                   const Opzioni &opzioni)
+{
+    return salvaThrows(biblioteca.istantanea(), manifestPath, opzioni);
+}
+
+/**
+ * Ripartisce l'istantanea, serializza e scrive gli shard in parallelo (uno per
+ * task del pool globale), poi scrive il manifest e rimuove gli shard non più citati.
+ * Uno shard con lo stesso SHA-256 di quello nel manifest esistente non viene riscritto.
+ * @throws FileNotFoundException o BibliotecaException se una scrittura fallisce;
+ *         in quel caso il manifest precedente resta valido
+ */
+ShardedCatalog::Report ShardedCatalog::salvaThrows(const MediaStore &valori, const QString &manifestPath,
+                                                   const Opzioni &opzioni)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "ShardedCatalog::salva");
+    const int totaleShard = numeroShard(opzioni);
+    QVector<QVector<int>> slotPerShard(totaleShard);
+    for (int slot = 0; slot < valori.size(); ++slot)
+    {
+        slotPerShard[shardDi(MediaStore::asMedia(valori.at(slot)), opzioni.partizione, totaleShard)].append(slot);
+    }
+
+    // Shard già su disco, per riconoscere quelli invariati
+    QJsonArray precedenti;
+    {
+        QFile file(manifestPath);
+        if (file.open(QIODevice::ReadOnly))
+        {
+            const QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+            if (isManifest(manifest))
+            {
+                precedenti = manifest.value(ChiaveShard).toArray();
+            }
+        }
+    }
+
+    const QString base = nomeBase(manifestPath);
+    QVector<QFuture<ShardScritto>> scritture;
+    scritture.reserve(totaleShard);
+    for (int indice = 0; indice < totaleShard; ++indice)
+    {
+        const QJsonObject precedente = indice < precedenti.size() ? precedenti.at(indice).toObject() : QJsonObject();
+        scritture.append(QtConcurrent::run([&valori, &slotPerShard, &manifestPath, &base, indice, precedente]()
+                                           {
+            ShardScritto risultato;
+            try
+            {
+                QJsonArray array;
+                for (int slot : slotPerShard[indice])
+                {
+                    std::visit([&array](const auto &concrete)
+                               { array.append(Schema::toJson(concrete)); },
+                               valori.at(slot));
+                }
+                QJsonObject documento;
+                documento["biblioteca"] = array;
+                const QByteArray data = QJsonDocument(documento).toJson(QJsonDocument::Compact);
+                const QString sha = QString::fromLatin1(
+                    QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+
+                risultato.voce[ChiaveElementi] = array.size();
+                risultato.voce[ChiaveByte] = qint64(data.size());
+                risultato.voce[ChiaveSha] = sha;
+
+                const QString fileShard = precedente.value(ChiaveFile).toString();
+                if (precedente.value(ChiaveSha).toString() == sha &&
+                    QFileInfo(percorsoShard(manifestPath, fileShard)).size() == qint64(data.size()))
+                {
+                    risultato.voce[ChiaveFile] = fileShard;
+                    return risultato;
+                }
+
+                const QString nuovo = base + ".shard-" + QString::number(indice) + "." + sha.left(PrefissoSha) + ".json";
+                JsonSerializer::scriviFileAtomico(percorsoShard(manifestPath, nuovo), data);
+                risultato.voce[ChiaveFile] = nuovo;
+                risultato.scritto = true;
+            }
+            catch (...)
+            {
+                risultato.errore = std::current_exception();
+            }
+            return risultato; }));
+    }
+
+    Report report;
+    report.shardTotali = totaleShard;
+    QJsonArray shard;
+    std::exception_ptr errore;
+    for (QFuture<ShardScritto> &scrittura : scritture)
+    {
+        const ShardScritto risultato = scrittura.result();
+        if (risultato.errore && !errore)
+        {
+            errore = risultato.errore;
+        }
+        if (risultato.scritto)
+        {
+            report.shardScritti++;
+            report.byteScritti += qint64(risultato.voce.value(ChiaveByte).toDouble());
+        }
+        shard.append(risultato.voce);
+    }
+    if (errore)
+    {
+        // Gli shard già scritti hanno nomi nuovi: il manifest precedente non li vede
+        std::rethrow_exception(errore);
+    }
+
+    QJsonObject manifest;
+    manifest[ChiaveFormato] = Formato;
+    manifest[ChiaveVersione] = Versione;
+    manifest[ChiavePartizione] = opzioni.partizione == Partizione::Tipo ? QStringLiteral("tipo") : QStringLiteral("hash");
+    manifest[ChiaveShard] = shard;
+    JsonSerializer::scriviFileAtomico(manifestPath, QJsonDocument(manifest).toJson());
+
+    // Shard non più citati, compresi quelli lasciati da salvataggi interrotti
+    QSet<QString> citati;
+    for (const QJsonValue &voce : shard)
+    {
+        citati.insert(voce.toObject().value(ChiaveFile).toString());
+    }
+    QDir cartella(QFileInfo(manifestPath).absolutePath());
+    for (const QString &file : cartella.entryList(QStringList{base + ".shard-*.json"}, QDir::Files))
+    {
+        if (!citati.contains(file))
+        {
+            cartella.remove(file);
+        }
+    }
+
+    Metrics::counter("shard.scritti").add(report.shardScritti);
+    Metrics::counter("shard.invariati").add(report.shardTotali - report.shardScritti);
+    return report;
+}
+
+/**
+ * Ogni shard è letto, analizzato e deserializzato in un task del pool globale.
+ * Gli osservatori di avanzamento ricevono i totali di tutti gli shard e sono
+ * chiamati uno alla volta; l'anteprima viene dal primo shard.
+ * Se uno shard manca, è troncato o non è JSON valido non viene caricato nulla.
+ * @throws FileNotFoundException, JsonParseException, OperazioneAnnullataException
+ */
+QList<Media *> ShardedCatalog::leggiMedia(const QString &manifestPath, const QJsonObject &manifest,
+                                          const JsonSerializer::Avanzamento *avanzamento)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "ShardedCatalog::carica");
+    Metrics::ScopedLatency misura(Metrics::histogram("shard.caricamento_us"));
+    const QJsonArray shard = manifest.value(ChiaveShard).toArray();
+
+    qint64 byteTotali = 0;
+    int recordTotali = 0;
+    for (const QJsonValue &voce : shard)
+    {
+        byteTotali += qint64(voce.toObject().value(ChiaveByte).toDouble());
+        recordTotali += voce.toObject().value(ChiaveElementi).toInt();
+    }
+
+    // Stato condiviso degli osservatori, aggiornato sotto mutex
+    QMutex mutex;
+    qint64 byteLetti = 0;
+    QVector<int> recordLetti(shard.size(), 0);
+
+    struct ShardLetto
+    {
+        QList<Media *> media;
+        std::exception_ptr errore;
+    };
+
+    QVector<QFuture<ShardLetto>> letture;
+    letture.reserve(shard.size());
+    for (int indice = 0; indice < shard.size(); ++indice)
+    {
+        const QJsonObject voce = shard.at(indice).toObject();
+        letture.append(QtConcurrent::run([&, indice, voce]()
+                                         {
+            ShardLetto risultato;
+            try
+            {
+                JsonSerializer::Avanzamento locale;
+                if (avanzamento)
+                {
+                    locale.annullato = avanzamento->annullato;
+                    locale.campiDifferiti = avanzamento->campiDifferiti;
+                    if (indice == 0)
+                    {
+                        locale.anteprima = avanzamento->anteprima;
+                        locale.dimensioneAnteprima = avanzamento->dimensioneAnteprima;
+                    }
+                    if (avanzamento->record)
+                    {
+                        locale.record = [&, indice](int record, int)
+                        {
+                            QMutexLocker locker(&mutex);
+                            recordLetti[indice] = record;
+                            int somma = 0;
+                            for (int letti : recordLetti)
+                            {
+                                somma += letti;
+                            }
+                            avanzamento->record(somma, recordTotali);
+                        };
+                    }
+                    locale.verifica();
+                }
+
+                const QString filePath = percorsoShard(manifestPath, voce.value(ChiaveFile).toString());
+                QFile file(filePath);
+                if (!file.open(QIODevice::ReadOnly))
+                {
+                    throw FileNotFoundException(filePath.toStdString());
+                }
+                QByteArray data = file.readAll();
+                if (qint64(data.size()) != qint64(voce.value(ChiaveByte).toDouble()))
+                {
+                    throw JsonParseException("Shard incompleto: " + filePath.toStdString());
+                }
+                if (avanzamento && avanzamento->lettura)
+                {
+                    QMutexLocker locker(&mutex);
+                    byteLetti += data.size();
+                    avanzamento->lettura(byteLetti, byteTotali);
+                }
+                if (BlockCompression::isCompresso(data))
+                {
+                    data = BlockCompression::decomprimi(data);
+                }
+
+                QJsonParseError parseError;
+                const QJsonDocument documento = QJsonDocument::fromJson(data, &parseError);
+                if (parseError.error != QJsonParseError::NoError)
+                {
+                    throw JsonParseException(filePath.toStdString() + ": " + parseError.errorString().toStdString());
+                }
+                risultato.media = JsonSerializer::deserializeMediaList(documento.object().value("biblioteca").toArray(),
+                                                                       avanzamento ? &locale : nullptr);
+            }
+            catch (...)
+            {
+                risultato.errore = std::current_exception();
+            }
+            return risultato; }));
+    }
+
+    QList<Media *> mediaList;
+    std::exception_ptr errore;
+    for (QFuture<ShardLetto> &lettura : letture)
+    {
+        const ShardLetto risultato = lettura.result();
+        if (risultato.errore && !errore)
+        {
+            errore = risultato.errore;
+        }
+        mediaList.append(risultato.media);
+    }
+    if (errore)
+    {
+        qDeleteAll(mediaList);
+        std::rethrow_exception(errore);
+    }
+    return mediaList;
+}
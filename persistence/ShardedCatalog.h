@@ -0,0 +1,73 @@
+#ifndef SHARDEDCATALOG_H
+#define SHARDEDCATALOG_H
+
+#include <QString>
+#include <QJsonObject>
+#include "JsonSerializer.h"
+
+/**
+ * ShardedCatalog - Catalogo suddiviso in più file (shard) descritti da un manifest
+ *
+ * Il manifest è un piccolo documento JSON che elenca gli shard:
+ *
+ *   {"formato":"biblio-shard","versione":1,"partizione":"hash",
+ *    "shard":[{"file":"cat.shard-0.1a2b3c4d.json","elementi":812,"byte":90210,"sha256":"..."}, ...]}
+ *
+ * Ogni shard è un normale file di biblioteca ({"biblioteca":[...]}), leggibile
+ * anche da solo. I Media sono ripartiti per tipo concreto (uno shard per tipo)
+ * oppure per hash di titolo e anno (numero di shard a scelta).
+ *
+ * Il salvataggio serializza gli shard in parallelo e riscrive solo quelli il cui
+ * contenuto (SHA-256) è cambiato rispetto al manifest esistente. Il nome di ogni
+ * shard contiene l'inizio del suo hash, quindi un file nuovo non sovrascrive mai
+ * uno shard ancora citato dal manifest: il manifest è scritto per ultimo in modo
+ * atomico e solo dopo i file non più citati vengono eliminati. Un'interruzione
+ * lascia sempre un manifest coerente con i suoi shard.
+ *
+ * Il caricamento legge e deserializza gli shard in parallelo e li concatena
+ * nell'ordine del manifest; JsonSerializer riconosce il manifest e vi delega,
+ * quindi caricaBibliotecaThrows() e importaBibliotecaThrows() aprono un catalogo
+ * a shard in modo trasparente. Con la partizione per hash l'ordine dei Media
+ * dopo il caricamento segue gli shard, non quello di inserimento.
+ */
+class ShardedCatalog
+{
+public:
+    enum class Partizione
+    {
+        Tipo,
+        Hash
+    };
+
+    struct Opzioni
+    {
+        Partizione partizione = Partizione::Hash;
+        // Usato solo con la partizione per hash
+        int numeroShard = 8;
+    };
+
+    struct Report
+    {
+        int shardTotali = 0;
+        int shardScritti = 0;
+        qint64 byteScritti = 0;
+    };
+
+    // Suffisso con cui l'interfaccia sceglie il formato a shard in salvataggio
+    static const QString EstensioneManifest;
+
+    static bool isManifest(const QJsonObject &jsonObject);
+    static bool isManifestPath(const QString &filePath);
+
+    // Salva l'istantanea come manifest più shard, riscrivendo solo gli shard cambiati
+    // (senza opzioni: partizione per hash con le impostazioni predefinite)
+    static Report salvaThrows(const MediaStore &valori, const QString &manifestPath, const Opzioni &opzioni);
+    static Report salvaThrows(const MediaStore &valori, const QString &manifestPath);
+    static Report salvaThrows(const Biblioteca &biblioteca, const QString &manifestPath, const Opzioni &opzioni);
+
+    // Legge in parallelo gli shard del manifest già decodificato
+    static QList<Media *> leggiMedia(const QString &manifestPath, const QJsonObject &manifest,
+                                     const JsonSerializer::Avanzamento *avanzamento = nullptr);
+};
+
+#endif // SHARDEDCATALOG_H
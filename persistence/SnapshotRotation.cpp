@@ -0,0 +1,156 @@
+#include "SnapshotRotation.h"
+#include "JsonSerializer.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace
+{
+    const QString ChiaveSha = QStringLiteral("sha256");
+    const QString ChiaveByte = QStringLiteral("byte");
+    const QString ChiaveGenerazione = QStringLiteral("generazioneJournal");
+
+    // Checksum della copia, oggetto vuoto se mancante o illeggibile
+    QJsonObject leggiChecksum(const QString &filePath)
+    {
+        QFile file(SnapshotRotation::checksumPath(filePath));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return QJsonObject();
+        }
+        return QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    // Sposta un file sostituendo l'eventuale destinazione (QFile::rename non sovrascrive)
+    void sposta(const QString &da, const QString &a)
+    {
+        if (QFile::exists(da))
+        {
+            QFile::remove(a);
+            if (!QFile::rename(da, a))
+            {
+                throw BibliotecaException("Impossibile ruotare lo snapshot: " + da.toStdString());
+            }
+        }
+        else
+        {
+            QFile::remove(a);
+        }
+    }
+}
+
+SnapshotRotation::SnapshotRotation(const QString &filePath, int copie)
+    : base(filePath), numeroCopie(qMax(1, copie)) {}
+
+QString SnapshotRotation::filePath(int indice) const
+{
+    return indice == 0 ? base : base + "." + QString::number(indice);
+}
+
+QString SnapshotRotation::checksumPath(const QString &filePath)
+{
+    return filePath + ".checksum";
+}
+
+/**
+ * Le copie scorrono dalla più vecchia alla più recente, poi la nuova viene
+ * scritta con JsonSerializer::scriviFileAtomico(); il checksum è scritto per
+ * ultimo, quindi una copia senza checksum corrispondente non è mai considerata
+ * valida se ne esiste una verificata.
+ * @throws BibliotecaException se una rinomina o una scrittura fallisce
+ */
+void SnapshotRotation::scrivi(const QByteArray &data, qint64 generazioneJournal) const
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "SnapshotRotation::scrivi");
+    for (int indice = numeroCopie - 1; indice > 0; --indice)
+    {
+        sposta(filePath(indice - 1), filePath(indice));
+        sposta(checksumPath(filePath(indice - 1)), checksumPath(filePath(indice)));
+    }
+
+    JsonSerializer::scriviFileAtomico(base, data);
+
+    QJsonObject checksum;
+    checksum[ChiaveSha] = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+    checksum[ChiaveByte] = qint64(data.size());
+    checksum[ChiaveGenerazione] = generazioneJournal;
+    JsonSerializer::scriviFileAtomico(checksumPath(base), QJsonDocument(checksum).toJson(QJsonDocument::Compact));
+}
+
+bool SnapshotRotation::verifica(int indice) const
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "SnapshotRotation::verifica");
+    const QJsonObject checksum = leggiChecksum(filePath(indice));
+    if (checksum.isEmpty())
+    {
+        return false;
+    }
+
+    QFile file(filePath(indice));
+    // La dimensione si confronta subito: un file troncato non viene nemmeno letto
+    if (!file.open(QIODevice::ReadOnly) || file.size() != qint64(checksum[ChiaveByte].toDouble(-1)))
+    {
+        return false;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) // lettura a blocchi
+    {
+        return false;
+    }
+    const bool valida = QString::fromLatin1(hash.result().toHex()) == checksum[ChiaveSha].toString();
+    if (!valida)
+    {
+        Metrics::counter("snapshot.copie_corrotte").add();
+    }
+    return valida;
+}
+
+int SnapshotRotation::piuRecenteValida() const
+{
+    int senzaChecksum = -1;
+    for (int indice = 0; indice < numeroCopie; ++indice)
+    {
+        if (!QFileInfo::exists(filePath(indice)))
+        {
+            continue;
+        }
+        if (verifica(indice))
+        {
+            return indice;
+        }
+        if (senzaChecksum < 0 && !QFileInfo::exists(checksumPath(filePath(indice))))
+        {
+            senzaChecksum = indice;
+        }
+    }
+    return senzaChecksum;
+}
+
+qint64 SnapshotRotation::generazioneJournal(int indice) const
+{
+    const QJsonObject checksum = leggiChecksum(filePath(indice));
+    return checksum.contains(ChiaveGenerazione) ? qint64(checksum[ChiaveGenerazione].toDouble()) : -1;
+}
+
+/**
+ * Una copia senza checksum può risalire a prima del journal: in quel caso
+ * vanno conservate tutte le generazioni (minimo 0).
+ */
+qint64 SnapshotRotation::generazioneMinima() const
+{
+    qint64 minima = -1;
+    for (int indice = 0; indice < numeroCopie; ++indice)
+    {
+        if (!QFileInfo::exists(filePath(indice)))
+        {
+            continue;
+        }
+        const qint64 generazione = qMax(qint64(0), generazioneJournal(indice));
+        minima = minima < 0 ? generazione : qMin(minima, generazione);
+    }
+    return minima;
+}
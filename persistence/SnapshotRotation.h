@@ -0,0 +1,51 @@
+#ifndef SNAPSHOTROTATION_H
+#define SNAPSHOTROTATION_H
+
+#include <QString>
+#include <QByteArray>
+#include "../model/Exceptions.h"
+
+/**
+ * SnapshotRotation - Copie a rotazione di uno snapshot, con checksum
+ *
+ * La copia 0 è il file indicato, le precedenti sono <file>.1 ... <file>.<copie-1>.
+ * Accanto a ogni copia il file <copia>.checksum (JSON) ne registra SHA-256,
+ * dimensione e generazione di Journal:
+ *
+ *   {"sha256":"...","byte":1234,"generazioneJournal":7}
+ *
+ * scrivi() fa scorrere le copie e poi scrive la nuova, ogni file in modo
+ * atomico. Se l'operazione si interrompe a metà, ogni copia rimasta è intera
+ * oppure non supera la verifica, che quindi è sempre sicura: una copia è valida
+ * solo se dimensione e SHA-256 coincidono con quelli registrati.
+ * La verifica legge il file a blocchi, senza caricarlo tutto in memoria.
+ */
+class SnapshotRotation
+{
+public:
+    explicit SnapshotRotation(const QString &filePath, int copie = 3);
+
+    int copie() const { return numeroCopie; }
+    // Percorso della copia (0 = più recente)
+    QString filePath(int indice) const;
+    static QString checksumPath(const QString &filePath);
+
+    // Fa scorrere le copie e scrive data come copia 0 con il suo checksum
+    void scrivi(const QByteArray &data, qint64 generazioneJournal) const;
+
+    // true se la copia esiste e corrisponde al suo checksum
+    bool verifica(int indice) const;
+    // Copia valida più recente; se nessuna ha un checksum valido, la più recente
+    // esistente senza checksum (file scritti prima della rotazione); -1 se nessuna
+    int piuRecenteValida() const;
+    // Generazione registrata nel checksum della copia, -1 se assente
+    qint64 generazioneJournal(int indice) const;
+    // Minima generazione tra le copie esistenti: i journal successivi vanno conservati
+    qint64 generazioneMinima() const;
+
+private:
+    QString base;
+    int numeroCopie;
+};
+
+#endif // SNAPSHOTROTATION_H
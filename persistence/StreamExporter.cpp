@@ -0,0 +1,356 @@
+#include "StreamExporter.h"
+#include "../model/MediaSchema.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+#include <array>
+#include <deque>
+
+namespace
+{
+    // Più colonne di quante ne abbia il CSV: le celle stanno sullo stack
+    constexpr int MaxColonne = 16;
+
+    // type, poi le chiavi di tutti i campi nell'ordine degli schemi, senza ripetizioni
+    const QVector<QLatin1String> &colonne()
+    {
+        static const QVector<QLatin1String> chiavi = []()
+        {
+            QVector<QLatin1String> risultato{MediaKeys::Type};
+            const auto aggiungi = [&risultato](const auto &field)
+            {
+                if (!risultato.contains(field.key))
+                {
+                    risultato.append(field.key);
+                }
+            };
+            Schema::forEach(Schema::commonFields, aggiungi);
+            Schema::forEach(Schema::MediaSchema<Book>::fields, aggiungi);
+            Schema::forEach(Schema::MediaSchema<Film>::fields, aggiungi);
+            Schema::forEach(Schema::MediaSchema<MagazineArticle>::fields, aggiungi);
+            Q_ASSERT(risultato.size() <= MaxColonne);
+            return risultato;
+        }();
+        return chiavi;
+    }
+
+    // Colonna di ogni campo di T, nell'ordine di Schema::forEachField<T>()
+    template <typename T>
+    const QVector<int> &colonneDi()
+    {
+        static const QVector<int> indici = []()
+        {
+            QVector<int> risultato;
+            Schema::forEachField<T>([&risultato](const auto &field)
+                                    { risultato.append(colonne().indexOf(field.key)); });
+            return risultato;
+        }();
+        return indici;
+    }
+
+    void appendJsonString(QByteArray &out, const QByteArray &utf8)
+    {
+        out += '"';
+        for (const char c : utf8)
+        {
+            switch (c)
+            {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    static const char cifre[] = "0123456789abcdef";
+                    out += "\\u00";
+                    out += cifre[(c >> 4) & 0xF];
+                    out += cifre[c & 0xF];
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+        }
+        out += '"';
+    }
+
+    void appendCsvCell(QByteArray &out, const QByteArray &utf8, char separatore)
+    {
+        bool virgolette = false;
+        for (const char c : utf8)
+        {
+            if (c == separatore || c == '"' || c == '\n' || c == '\r')
+            {
+                virgolette = true;
+                break;
+            }
+        }
+        if (!virgolette)
+        {
+            out += utf8;
+            return;
+        }
+        out += '"';
+        for (const char c : utf8)
+        {
+            if (c == '"')
+            {
+                out += '"';
+            }
+            out += c;
+        }
+        out += '"';
+    }
+
+    // Valore del campo come testo UTF-8 (gli interi senza virgolette)
+    template <typename FieldT, typename T>
+    QByteArray testoCampo(const FieldT &field, const T &media)
+    {
+        if constexpr (FieldT::kind == Schema::FieldKind::Integer)
+        {
+            return QByteArray::number(field.read(media));
+        }
+        else
+        {
+            return field.read(media).toUtf8();
+        }
+    }
+
+    template <typename T>
+    void formattaJson(const T &media, QByteArray &out)
+    {
+        out += "{\"";
+        out.append(MediaKeys::Type.data(), MediaKeys::Type.size());
+        out += "\":\"";
+        out += T::TypeTag;
+        out += '"';
+        Schema::forEachField<T>([&](const auto &field)
+                                {
+                                    out += ",\"";
+                                    out.append(field.key.data(), field.key.size());
+                                    out += "\":";
+                                    if constexpr (std::decay_t<decltype(field)>::kind == Schema::FieldKind::Integer)
+                                    {
+                                        out += QByteArray::number(field.read(media));
+                                    }
+                                    else
+                                    {
+                                        appendJsonString(out, field.read(media).toUtf8());
+                                    } });
+        out += "}\n";
+    }
+
+    template <typename T>
+    void formattaCsv(const T &media, char separatore, QByteArray &out)
+    {
+        std::array<QByteArray, MaxColonne> celle;
+        celle[0] = T::TypeTag;
+        const QVector<int> &indici = colonneDi<T>();
+        int campo = 0;
+        Schema::forEachField<T>([&](const auto &field)
+                                { celle[std::size_t(indici.at(campo++))] = testoCampo(field, media); });
+        const int numero = colonne().size();
+        for (int colonna = 0; colonna < numero; ++colonna)
+        {
+            if (colonna > 0)
+            {
+                out += separatore;
+            }
+            appendCsvCell(out, celle[std::size_t(colonna)], separatore);
+        }
+        out += '\n';
+    }
+
+    template <typename T>
+    void formattaConcreto(const T &media, StreamExporter::Formato formato, char separatore, QByteArray &out)
+    {
+        if (formato == StreamExporter::Formato::Csv)
+        {
+            formattaCsv(media, separatore, out);
+        }
+        else
+        {
+            formattaJson(media, out);
+        }
+    }
+
+    struct Blocco
+    {
+        QByteArray data;
+        int record = 0;
+    };
+}
+
+bool StreamExporter::formatoDaPath(const QString &filePath, Formato *formato)
+{
+    const QString estensione = QFileInfo(filePath).suffix().toLower();
+    if (estensione == QLatin1String("csv"))
+    {
+        *formato = Formato::Csv;
+        return true;
+    }
+    if (estensione == QLatin1String("jsonl") || estensione == QLatin1String("ndjson"))
+    {
+        *formato = Formato::JsonLines;
+        return true;
+    }
+    return false;
+}
+
+QByteArray StreamExporter::intestazioneCsv(char separatore)
+{
+    QByteArray riga;
+    for (const QLatin1String &chiave : colonne())
+    {
+        if (!riga.isEmpty())
+        {
+            riga += separatore;
+        }
+        riga.append(chiave.data(), chiave.size());
+    }
+    riga += '\n';
+    return riga;
+}
+
+/**
+ * Smistamento statico sul tipo concreto: i campi da scrivere sono quelli dello
+ * schema, espansi a tempo di compilazione.
+ */
+void StreamExporter::formatta(const Media &media, Formato formato, char separatore, QByteArray &out)
+{
+    // Media::materializza() non è sincronizzata: i getter non devono decodificare qui
+    Q_ASSERT(!media.campiDifferiti());
+    switch (media.tipo())
+    {
+    case MediaKind::Book:
+        formattaConcreto(static_cast<const Book &>(media), formato, separatore, out);
+        break;
+    case MediaKind::Film:
+        formattaConcreto(static_cast<const Film &>(media), formato, separatore, out);
+        break;
+    case MediaKind::MagazineArticle:
+        formattaConcreto(static_cast<const MagazineArticle &>(media), formato, separatore, out);
+        break;
+    }
+}
+
+StreamExporter::Report StreamExporter::esportaThrows(const Biblioteca &biblioteca, const RoaringBitmap &selezione,
+                                                     const QString &filePath, const Opzioni &opzioni)
+{
+    BIBLIO_TRACE_SCOPE("persistenza", "StreamExporter::esporta");
+    Metrics::ScopedLatency misura(Metrics::histogram("esportazione.durata_us"));
+    const QList<Media *> media = biblioteca.materializza(selezione);
+    // I campi differiti si decodificano qui, prima che i blocchi passino al pool
+    for (const Media *corrente : media)
+    {
+        corrente->materializza();
+    }
+    const int passo = qMax(1, opzioni.recordPerBlocco);
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        throw FileNotFoundException("Impossibile aprire file per scrittura: " + filePath.toStdString());
+    }
+
+    Report report;
+    const auto scrivi = [&](const QByteArray &data)
+    {
+        if (file.write(data) != data.size())
+        {
+            throw BibliotecaException("Errore durante la scrittura del file: " + filePath.toStdString() +
+                                      " (" + file.errorString().toStdString() + ")");
+        }
+        report.byte += data.size();
+    };
+    const auto formattaBlocco = [&media, &opzioni, passo](int inizio)
+    {
+        BIBLIO_TRACE_SCOPE("persistenza", "esporta/formatta");
+        Blocco blocco;
+        const int fine = qMin(media.size(), inizio + passo);
+        for (int i = inizio; i < fine; ++i)
+        {
+            const Media &corrente = *media.at(i);
+            if (!opzioni.filtro || opzioni.filtro(corrente))
+            {
+                formatta(corrente, opzioni.formato, opzioni.separatore, blocco.data);
+                ++blocco.record;
+            }
+        }
+        return blocco;
+    };
+
+    // Blocchi formattati in attesa di essere scritti, nell'ordine della selezione
+    std::deque<QFuture<Blocco>> inVolo;
+    try
+    {
+        if (opzioni.formato == Formato::Csv)
+        {
+            scrivi(intestazioneCsv(opzioni.separatore));
+        }
+
+        if (!opzioni.parallelo)
+        {
+            for (int inizio = 0; inizio < media.size(); inizio += passo)
+            {
+                const Blocco blocco = formattaBlocco(inizio);
+                scrivi(blocco.data);
+                report.esportati += blocco.record;
+            }
+        }
+        else
+        {
+            const std::size_t massimo = std::size_t(qMax(2, 2 * QThread::idealThreadCount()));
+            int prossimo = 0;
+            while (prossimo < media.size() || !inVolo.empty())
+            {
+                while (prossimo < media.size() && inVolo.size() < massimo)
+                {
+                    inVolo.push_back(QtConcurrent::run([&formattaBlocco, prossimo]()
+                                                       { return formattaBlocco(prossimo); }));
+                    prossimo += passo;
+                }
+                const Blocco blocco = inVolo.front().result();
+                inVolo.pop_front();
+                scrivi(blocco.data);
+                report.esportati += blocco.record;
+            }
+        }
+
+        if (!file.commit())
+        {
+            throw BibliotecaException("Errore durante la scrittura del file: " + filePath.toStdString() +
+                                      " (" + file.errorString().toStdString() + ")");
+        }
+    }
+    catch (...)
+    {
+        // I blocchi ancora in formattazione leggono variabili locali
+        for (QFuture<Blocco> &blocco : inVolo)
+        {
+            blocco.waitForFinished();
+        }
+        file.cancelWriting();
+        throw;
+    }
+
+    Metrics::counter("esportazione.record").add(report.esportati);
+    return report;
+}
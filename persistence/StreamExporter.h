@@ -0,0 +1,65 @@
+#ifndef STREAMEXPORTER_H
+#define STREAMEXPORTER_H
+
+#include <QString>
+#include <QByteArray>
+#include <functional>
+#include "../model/Biblioteca.h"
+#include "../model/Exceptions.h"
+
+/**
+ * StreamExporter - Esportazione in streaming dei risultati di una query
+ *
+ * Scrive i Media selezionati (una bitmap di Biblioteca::eseguiQuery(), eventualmente
+ * combinata con altre) in CSV o JSON-lines, nello stesso formato letto da
+ * BatchImporter. Ogni record è formattato direttamente in UTF-8 a partire dallo
+ * schema del tipo concreto (MediaSchema.h), senza costruire un QJsonObject; i
+ * record vengono accumulati in blocchi e scritti in un file temporaneo reso
+ * definitivo solo a fine esportazione (QSaveFile).
+ *
+ * Con parallelo i blocchi sono formattati nel pool globale e scritti nell'ordine
+ * della selezione; i blocchi in volo sono limitati, quindi la memoria non cresce
+ * con il numero di risultati. I Media in modalità differita vengono materializzati
+ * nel thread chiamante prima della formattazione, perché Media::materializza() non
+ * è sincronizzata; la biblioteca non deve essere modificata durante l'esportazione.
+ */
+class StreamExporter
+{
+public:
+    enum class Formato
+    {
+        Csv,
+        JsonLines
+    };
+
+    struct Opzioni
+    {
+        Formato formato = Formato::JsonLines;
+        bool parallelo = true;
+        int recordPerBlocco = 4096;
+        char separatore = ',';
+        // Filtro aggiuntivo sui campi non indicizzati (genere, rivista...); vuoto = tutti
+        std::function<bool(const Media &)> filtro;
+    };
+
+    struct Report
+    {
+        int esportati = 0;
+        qint64 byte = 0;
+    };
+
+    // Formato dall'estensione (.csv, .jsonl/.ndjson); false se non riconosciuta
+    static bool formatoDaPath(const QString &filePath, Formato *formato);
+
+    // Riga di intestazione CSV: type e le chiavi JSON di tutti i campi
+    static QByteArray intestazioneCsv(char separatore = ',');
+    // Aggiunge a out il record del Media nel formato indicato, a capo compreso.
+    // Il Media deve essere già materializzato (vedi Media::materializza())
+    static void formatta(const Media &media, Formato formato, char separatore, QByteArray &out);
+
+    // @throws FileNotFoundException, BibliotecaException se la scrittura fallisce
+    static Report esportaThrows(const Biblioteca &biblioteca, const RoaringBitmap &selezione,
+                                const QString &filePath, const Opzioni &opzioni);
+};
+
+#endif // STREAMEXPORTER_H
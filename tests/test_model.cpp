@@ -4,7 +4,31 @@
 #include "../model/Film.h"
 #include "../model/MagazineArticle.h"
 #include "../model/Biblioteca.h"
+#include "../model/RoaringBitmap.h"
+#include "../model/DuplicateDetector.h"
+#include "../model/MediaTypeRegistry.h"
+#include "../model/MediaKeys.h"
+#include "../model/MediaSchema.h"
+#include "../model/MediaStore.h"
+#include "../model/MediaVisitorT.h"
+#include <QDataStream>
+#include <algorithm>
 #include "../persistence/JsonSerializer.h"
+#include "../persistence/AsyncSaver.h"
+#include "../persistence/Journal.h"
+#include "../persistence/SnapshotRotation.h"
+#include "../persistence/ShardedCatalog.h"
+#include "../persistence/BlockCompression.h"
+#include "../persistence/BatchImporter.h"
+#include "../persistence/StreamExporter.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
+#include <QTemporaryDir>
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QDir>
 
 void testBookCreation() {
     Book book("Test Book", 2023, "Test Author", "123-456-789", "Test Publisher");
@@ -46,8 +70,8 @@ void testBibliotecaOperations() {
     biblioteca.aggiungiMedia(film);
     
     assert(biblioteca.dimensione() == 2);
-    assert(biblioteca.getLibri().size() == 1);
-    assert(biblioteca.getFilm().size() == 1);
+    assert(biblioteca.collectMediaByType(MediaFilter::FilterType::BOOKS_ONLY).size() == 1);
+    assert(biblioteca.collectMediaByType(MediaFilter::FilterType::FILMS_ONLY).size() == 1);
     
     auto risultatiRicerca = biblioteca.cercaPerTitolo("Test");
     assert(risultatiRicerca.size() == 2);
@@ -72,6 +96,1247 @@ void testSerialization() {
     std::cout << "✓ Test Serialization passed" << std::endl;
 }
 
+void testRoaringBitmap() {
+    RoaringBitmap pari;
+    RoaringBitmap tutti = RoaringBitmap::range(0, 100000);
+    for (quint32 i = 0; i < 100000; i += 2) {
+        pari.add(i);
+    }
+
+    assert(tutti.cardinality() == 100000);
+    assert(pari.cardinality() == 50000);
+    assert((pari & tutti) == pari);
+    assert((pari | tutti) == tutti);
+    assert(tutti.andNot(pari).cardinality() == 50000);
+    assert(!tutti.andNot(pari).contains(42));
+    assert(tutti.andNot(pari).contains(43));
+
+    // Intervallo denso con bordi non allineati alle parole: confronto con gli inserimenti singoli
+    const RoaringBitmap intervallo = RoaringBitmap::range(70, 65536 + 5000 + 3);
+    RoaringBitmap atteso;
+    for (quint32 i = 70; i < 65536 + 5000 + 3; ++i) {
+        atteso.add(i);
+    }
+    assert(intervallo == atteso);
+    assert(!intervallo.contains(69) && intervallo.contains(70) && intervallo.contains(65536 + 5002));
+    assert(!intervallo.contains(65536 + 5003));
+    assert(RoaringBitmap::range(5000, 5064).cardinality() == 64);
+    std::cout << "✓ Test Roaring Bitmap passed" << std::endl;
+}
+
+void testBibliotecaQuery() {
+    Biblioteca biblioteca;
+    biblioteca.aggiungiMedia(new Book("Il Nome della Rosa", 1980, "Eco", "978-88-452-0000-0", "Bompiani"));
+    biblioteca.aggiungiMedia(new Film("Il Nome della Rosa", 1986, "Annaud", 130, "Drammatico"));
+    biblioteca.aggiungiMedia(new Book("Baudolino", 2000, "Eco", "978-88-452-0001-7", "Bompiani"));
+
+    MediaFilter::Query query;
+    query.tipo = MediaFilter::FilterType::BOOKS_ONLY;
+    query.titolo = "rosa";
+    RoaringBitmap risultato = biblioteca.eseguiQuery(query);
+    assert(risultato.cardinality() == 1);
+    assert(biblioteca.materializza(risultato).first()->getYear() == 1980);
+
+    assert(biblioteca.cercaPerAnno(2000).size() == 1);
+    assert(biblioteca.collectMediaByType(MediaFilter::FilterType::FILMS_ONLY).size() == 1);
+    assert(biblioteca.materializza(biblioteca.bitmapTutti(), 1, 1).size() == 1);
+    std::cout << "✓ Test Biblioteca Query passed" << std::endl;
+}
+
+void testQueryPaginata() {
+    Biblioteca biblioteca;
+    for (int i = 0; i < 100; ++i) {
+        biblioteca.aggiungiMedia(new Film(QString("Film %1").arg(i), 2000 + i % 10, "Regista", 90, "Genere"));
+    }
+
+    MediaFilter::Page prima = biblioteca.collectMediaByTypePaginato(MediaFilter::FilterType::FILMS_ONLY, 0, 40);
+    assert(prima.items.size() == 40);
+    assert(prima.totaleEsatto && prima.totaleStimato == 100);
+    assert(prima.altriRisultati);
+
+    MediaFilter::Query query;
+    query.titolo = "Film 9";
+    MediaFilter::Page pagina = biblioteca.eseguiQueryDaCursore(query, 0, 5);
+    assert(pagina.items.size() == 5);
+    MediaFilter::Page seguente = biblioteca.eseguiQueryDaCursore(query, pagina.cursore, 5);
+    assert(seguente.items.size() == 5);
+    assert(seguente.items.first() != pagina.items.last());
+    assert(seguente.altriRisultati);
+    MediaFilter::Page ultima = biblioteca.eseguiQueryDaCursore(query, seguente.cursore, 5);
+    assert(ultima.items.size() == 1 && !ultima.altriRisultati);
+
+    // Candidati oltre la pagina piena che non passano il filtro sul titolo:
+    // nessuna pagina successiva, cursore sull'ultimo elemento della pagina
+    query.titolo = "Film 0";
+    MediaFilter::Page unica = biblioteca.eseguiQueryDaCursore(query, 0, 1);
+    assert(unica.items.size() == 1 && !unica.altriRisultati);
+    assert(unica.cursore == 1);
+    assert(unica.totaleEsatto && unica.totaleStimato == 1);
+    assert(biblioteca.cercaPerAnnoPaginato(2003, 8, 5).items.size() == 2);
+    std::cout << "✓ Test Query Paginata passed" << std::endl;
+}
+
+void testDuplicateDetection() {
+    assert(DuplicateDetector::normalizzaIsbn("88-452-0000-X") == "9788845200007");
+    assert(DuplicateDetector::normalizzaIsbn("978-88-452-0000-7") == "9788845200007");
+    assert(DuplicateDetector::normalizzaDoi("https://doi.org/10.1000/ABC") == "10.1000/abc");
+
+    Biblioteca biblioteca;
+    biblioteca.aggiungiMedia(new Book("Il Nome della Rosa", 1980, "Umberto Eco", "88-452-0000-X", "Bompiani"));
+    biblioteca.aggiungiMedia(new Film("Blade Runner", 1982, "Ridley Scott", 117, "Fantascienza"));
+
+    QList<Media *> importati;
+    importati << new Book("Il nome della rosa", 1980, "Umberto Eco", "978-88-452-0000-7", "Bompiani")
+              << new Film("Blade Runner!", 1982, "Ridley Scott", 117, "Fantascienza", "cover.png")
+              << new Film("Alien", 1979, "Ridley Scott", 117, "Fantascienza");
+
+    DuplicateDetector detector;
+    detector.indicizza(biblioteca);
+    Deduplicazione::Report report = detector.importa(biblioteca, importati, Deduplicazione::Politica::UNISCI);
+    assert(report.uniti == 2);
+    assert(report.aggiunti == 1);
+    assert(biblioteca.dimensione() == 3);
+    assert(biblioteca.getMediaAt(1)->getCoverImagePath() == "cover.png");
+
+    // Dopo l'unione l'esistente ha l'ISBN del primo record: il secondo, con un ISBN
+    // diverso, è un'altra edizione; il terzo ripete l'ISBN unito ed è un duplicato
+    Biblioteca edizioni;
+    edizioni.aggiungiMedia(new Book("Il Gattopardo", 1958, "Tomasi di Lampedusa", "", "Feltrinelli"));
+    DuplicateDetector rilevatore;
+    rilevatore.indicizza(edizioni);
+    QList<Media *> nuoveEdizioni;
+    nuoveEdizioni << new Book("Il Gattopardo", 1958, "Tomasi di Lampedusa", "978-88-07-88100-0", "Feltrinelli")
+                  << new Book("Il Gattopardo", 1958, "Tomasi di Lampedusa", "978-88-07-90000-8", "Feltrinelli")
+                  << new Book("Gattopardo", 1959, "", "9788807881000", "");
+    report = rilevatore.importa(edizioni, nuoveEdizioni, Deduplicazione::Politica::UNISCI);
+    assert(report.uniti == 2 && report.aggiunti == 1);
+    assert(edizioni.dimensione() == 2);
+    assert(static_cast<Book *>(edizioni.getMediaAt(0))->getIsbn() == "978-88-07-88100-0");
+    assert(static_cast<Book *>(edizioni.getMediaAt(1))->getIsbn() == "978-88-07-90000-8");
+    assert(report.duplicati.last().motivo == Deduplicazione::Motivo::ISBN);
+    std::cout << "✓ Test Duplicate Detection passed" << std::endl;
+}
+
+void testInserimentoBulk() {
+    Biblioteca biblioteca;
+    biblioteca.aggiungiMedia(new Book("Primo", 2000, "Autore", "111", "Editore"));
+    assert(biblioteca.bitmapPerAnno(2000).cardinality() == 1); // indici costruiti
+
+    Book *ripetuto = new Book("Secondo", 2001, "Autore", "222", "Editore");
+    QList<Media *> lotto;
+    lotto << ripetuto << nullptr << ripetuto
+          << new Film("Terzo", 2001, "Regista", 90, "Dramma");
+    const int aggiunti = biblioteca.aggiungiMediaBulk(lotto);
+    assert(aggiunti == 2);
+    Q_UNUSED(aggiunti);
+    assert(biblioteca.dimensione() == 3);
+    assert(biblioteca.bitmapPerAnno(2001).cardinality() == 2);
+    assert(biblioteca.collectMediaByType(MediaFilter::FilterType::FILMS_ONLY).size() == 1);
+
+    // Tutto-o-niente: un duplicato annulla l'intero lotto
+    Book *nuovo = new Book("Quarto", 2002, "Autore", "333", "Editore");
+    QList<Media *> lottoInvalido;
+    lottoInvalido << nuovo << ripetuto;
+    bool eccezione = false;
+    try {
+        biblioteca.aggiungiMediaBulkTransazionale(lottoInvalido);
+    } catch (const DuplicateMediaException &) {
+        eccezione = true;
+    }
+    assert(eccezione);
+    assert(biblioteca.dimensione() == 3);
+    assert(biblioteca.cercaPerAnno(2002).isEmpty());
+
+    biblioteca.aggiungiMediaBulkTransazionale(QList<Media *>() << nuovo);
+    assert(biblioteca.cercaPerAnno(2002).size() == 1);
+    std::cout << "✓ Test Inserimento Bulk passed" << std::endl;
+}
+
+void testRisultatiSenzaEccezioni() {
+    Result<void> valido = MediaFactory::tryValidateBookData("Titolo", 2000, "Autore", "123", "Editore");
+    assert(valido.isOk());
+    Result<void> invalido = MediaFactory::tryValidateFilmData("Titolo", 2000, "Regista", 0, "Genere");
+    assert(!invalido && invalido.error().code() == ErrorCode::InvalidData);
+    assert(invalido.error().message() == "Dato non valido: Durata deve essere maggiore di 0");
+
+    QJsonObject senzaTipo;
+    senzaTipo["title"] = "Orfano";
+    assert(MediaFactory::tryCreateFromJson(senzaTipo).error().code() == ErrorCode::JsonParse);
+    Result<Media *> creato = MediaFactory::tryCreateFromJson(Book("Valido", 2001, "Autore", "123", "Editore").serializza());
+    assert(creato.isOk() && creato.value()->getTitle() == "Valido");
+    delete creato.value();
+
+    Biblioteca biblioteca;
+    Book *libro = new Book("Unico", 2002, "Autore", "456", "Editore");
+    biblioteca.aggiungiMedia(libro);
+    assert(biblioteca.dimensione() == 1);
+    Book estraneo("Estraneo", 2002, "Autore", "789", "Editore");
+    const bool rimossoEstraneo = biblioteca.rimuoviMedia(&estraneo);
+    assert(!rimossoEstraneo);
+    Q_UNUSED(rimossoEstraneo);
+    const bool rimosso = biblioteca.rimuoviMedia(libro);
+    assert(rimosso);
+    Q_UNUSED(rimosso);
+
+    bool eccezione = false;
+    try {
+        biblioteca.getMediaAt(3);
+    } catch (const MediaNotFoundException &e) {
+        eccezione = std::string(e.what()) == "Media non trovato: Indice non valido: 3";
+    }
+    assert(eccezione);
+    std::cout << "✓ Test Risultati Senza Eccezioni passed" << std::endl;
+}
+
+void testMediaTypeRegistry() {
+    static_assert(MediaTypeRegistry::hashTag("Book") != MediaTypeRegistry::hashTag("Film"),
+                  "hash dei tag calcolato a tempo di compilazione");
+    MediaTypeRegistry &registry = MediaTypeRegistry::instance();
+    assert(MediaTypeRegistry::hashTag(QString("Book")) == MediaTypeRegistry::hashTag(Book::TypeTag));
+    assert(registry.contains("Book") && registry.contains("Film") && registry.contains("MagazineArticle"));
+    assert(!registry.contains("Libro"));
+    assert(!registry.registerType(Book::TypeTag, nullptr, nullptr));
+    assert(MediaFactory::getSupportedTypes() == (QStringList() << "Book" << "Film" << "MagazineArticle"));
+
+    Film film("Metropolis", 1927, "Fritz Lang", 153, "Fantascienza");
+    QJsonObject json = film.serializza();
+    assert(json[MediaKeys::Type].toString() == "Film");
+    Media *copia = Media::deserializza(json);
+    assert(dynamic_cast<Film *>(copia) && copia->getTitle() == "Metropolis");
+    delete copia;
+
+    Media *vuoto = MediaFactory::createMedia("MagazineArticle", "Bozza", 2020);
+    assert(dynamic_cast<MagazineArticle *>(vuoto));
+    delete vuoto;
+    std::cout << "✓ Test Media Type Registry passed" << std::endl;
+}
+
+void testMediaSchema() {
+    Book book("Il Gattopardo", 1958, "Tomasi di Lampedusa", "978-88-07-88100-0", "Feltrinelli", "gattopardo.png");
+    assert(book.visualizzaDettagli() ==
+           "Libro: Il Gattopardo (1958)\nAutore: Tomasi di Lampedusa\nISBN: 978-88-07-88100-0\n"
+           "Editore: Feltrinelli\nCopertina: gattopardo.png");
+    Film film("Otto e mezzo", 1963, "Federico Fellini", 138, "Drammatico");
+    assert(film.visualizzaDettagli().contains("Durata: 138 min"));
+
+    Book *copia = Book::deserializza(book.serializza());
+    assert(copia->serializza() == book.serializza());
+    delete copia;
+
+    QByteArray buffer;
+    QDataStream out(&buffer, QIODevice::WriteOnly);
+    Schema::writeBinary(out, film);
+    QDataStream in(buffer);
+    Film *letto = Schema::readBinary<Film>(in);
+    assert(letto->getDuration() == 138 && letto->getDirector() == "Federico Fellini");
+    assert(Schema::compare(film, *letto, MediaKeys::Duration) == 0);
+    letto->setDuration(90);
+    assert(Schema::compare(*letto, film, MediaKeys::Duration) < 0);
+
+    QList<Film *> films;
+    films << &film << letto;
+    std::sort(films.begin(), films.end(), Schema::FieldLess<Film, 1>());
+    assert(films.first() == letto);
+    delete letto;
+
+    assert(Schema::valueWithRole(book, Schema::CreatorRole) == "Tomasi di Lampedusa");
+    QList<Schema::FieldInfo> campi = Schema::fieldInfosFor(book);
+    assert(campi.size() == 3 && campi.at(1).key == MediaKeys::Isbn);
+    campi.at(2).write(&book, QVariant(QString("Mondadori")));
+    assert(book.getPublisher() == "Mondadori");
+    std::cout << "✓ Test Media Schema passed" << std::endl;
+}
+
+void testIstantaneaPerValore() {
+    Biblioteca biblioteca;
+    biblioteca.aggiungiMedia(new Book("La Coscienza di Zeno", 1923, "Italo Svevo", "111", "Cappelli"));
+    biblioteca.aggiungiMedia(new Film("La Dolce Vita", 1960, "Federico Fellini", 174, "Drammatico"));
+    assert(biblioteca.istantanea().toJson() == biblioteca.serializzaMedia());
+
+    // L'istantanea è costruita dai Media a ogni richiesta: riflette anche le
+    // modifiche fatte tramite i puntatori, senza notificaModifica()
+    biblioteca.getMediaAt(0)->setTitle("Senilità");
+    const MediaStore istantanea = biblioteca.istantanea();
+    assert(MediaStore::asMedia(istantanea.at(0)).getTitle() == "Senilità");
+    assert(istantanea.toJson() == biblioteca.serializzaMedia());
+
+    biblioteca.aggiungiMedia(new MagazineArticle("Vita dei campi", 1880, "Giovanni Verga", "Rivista", "10.1/abc"));
+    assert(biblioteca.cercaPerTitolo("vita").size() == 2);
+
+    Biblioteca copia(biblioteca);
+    assert(copia.dimensione() == 3);
+    assert(copia.getMediaAt(0) != biblioteca.getMediaAt(0));
+    assert(dynamic_cast<Film *>(copia.getMediaAt(1)));
+    assert(copia.serializzaMedia() == biblioteca.serializzaMedia());
+
+    const MediaStore archivio = MediaStore::fromMedia(biblioteca.getTuttiMedia());
+    assert(archivio.size() == 3);
+    int somma = 0;
+    archivio.forEach(Overloaded{[&](const Film &film) { somma += film.getDuration(); },
+                                [&](const auto &media) { somma += media.getYear(); }});
+    assert(somma == 1923 + 174 + 1880);
+    assert(MediaStore::asMedia(archivio.at(2)).getTitle() == "Vita dei campi");
+    std::cout << "✓ Test Istantanea Per Valore passed" << std::endl;
+}
+
+namespace {
+    // Visitor polimorfo: restituisce la durata in minuti (0 per i media non audiovisivi)
+    class DurataVisitor : public MediaVisitorT<int> {
+    public:
+        int visit(Book &) override { return 0; }
+        int visit(Film &film) override { return film.getDuration(); }
+        int visit(MagazineArticle &) override { return 0; }
+    };
+
+    // Visitor a smistamento statico su media const
+    class EtichettaVisitor : public StaticMediaVisitor<EtichettaVisitor, QString> {
+    public:
+        QString visit(const Book &book) const { return "L:" + book.getIsbn(); }
+        QString visit(const Film &film) const { return "F:" + film.getDirector(); }
+        QString visit(const MagazineArticle &article) const { return "A:" + article.getDoi(); }
+    };
+}
+
+void testVisitorGenerici() {
+    Book libro("Il Gattopardo", 1958, "Tomasi di Lampedusa", "222", "Feltrinelli");
+    Film film("Il Gattopardo", 1963, "Luchino Visconti", 187, "Storico");
+    MagazineArticle articolo("Saggio", 1990, "Autore", "Rivista", "10.2/xyz");
+    assert(libro.tipo() == MediaKind::Book && film.tipo() == MediaKind::Film);
+    assert(articolo.tipo() == MediaKind::MagazineArticle);
+
+    DurataVisitor durata;
+    Media *media = &film;
+    assert(media->accept(durata) == 187);
+    assert(libro.accept(durata) == 0);
+
+    EtichettaVisitor etichetta;
+    const Media &costante = articolo;
+    assert(etichetta.apply(costante) == "A:10.2/xyz");
+    assert(etichetta.apply(libro) == "L:222");
+    assert(visitMedia(etichetta, film) == "F:Luchino Visconti");
+
+    // La clonazione conserva il tipo concreto usato per lo smistamento
+    Media *copia = film.clone();
+    assert(copia->tipo() == MediaKind::Film && copia->accept(durata) == 187);
+    delete copia;
+    std::cout << "✓ Test Visitor Generici passed" << std::endl;
+}
+
+void testTracing() {
+    Tracing::setEnabled(true);
+    {
+        Tracing::ScopedTimer timer("test", "testTracing/blocco");
+    }
+    Tracing::setEnabled(false);
+    {
+        Tracing::ScopedTimer ignorato("test", "testTracing/disattivato");
+    }
+
+    QTemporaryDir cartella;
+    assert(cartella.isValid());
+    const QString percorso = cartella.filePath("traccia.json");
+    const bool scritto = Tracing::writeChromeTrace(percorso);
+    assert(scritto);
+    Q_UNUSED(scritto);
+
+    QFile file(percorso);
+    const bool aperto = file.open(QIODevice::ReadOnly);
+    assert(aperto);
+    Q_UNUSED(aperto);
+    const QJsonArray eventi = QJsonDocument::fromJson(file.readAll()).object()["traceEvents"].toArray();
+    int trovati = 0;
+    for (const QJsonValue &evento : eventi) {
+        const QString nome = evento.toObject()["name"].toString();
+        assert(nome != "testTracing/disattivato");
+        if (nome == "testTracing/blocco") {
+            assert(evento.toObject()["ph"].toString() == "X");
+            assert(evento.toObject()["dur"].toDouble() >= 0.0);
+            ++trovati;
+        }
+    }
+    assert(trovati == 1);
+    std::cout << "✓ Test Tracing passed" << std::endl;
+}
+
+void testMetriche() {
+    // Bucket dell'istogramma: esatti sotto 32, poi errore relativo al più 1/16
+    for (qint64 valore : {0LL, 1LL, 31LL, 32LL, 33LL, 1000LL, 123456LL, Metrics::Histogram::MaxValue}) {
+        const int indice = Metrics::Histogram::bucketIndex(valore);
+        assert(indice >= 0 && indice < Metrics::Histogram::BucketCount);
+        const qint64 limite = Metrics::Histogram::bucketUpperBound(indice);
+        assert(limite >= valore);
+        assert(limite - valore <= valore / 16);
+    }
+
+    Metrics::Histogram istogramma;
+    for (int i = 1; i <= 1000; ++i) {
+        istogramma.record(i);
+    }
+    assert(istogramma.count() == 1000);
+    assert(istogramma.min() == 1 && istogramma.max() == 1000);
+    assert(qAbs(istogramma.mean() - 500.5) < 0.001);
+    assert(qAbs(istogramma.percentile(50) - 500) <= 500 / 16);
+    assert(qAbs(istogramma.percentile(99) - 990) <= 990 / 16);
+    assert(istogramma.percentile(100) == 1000);
+
+    // Il registro restituisce sempre la stessa istanza per nome
+    Metrics::Counter &contatore = Metrics::counter("test.contatore");
+    assert(&contatore == &Metrics::counter("test.contatore"));
+    contatore.reset();
+    contatore.add(3);
+    contatore.add();
+    assert(contatore.value() == 4);
+
+    Biblioteca biblioteca;
+    biblioteca.aggiungiMedia(new Book("Il Nome della Rosa", 1980, "Umberto Eco", "978-88-452-0734-1", "Bompiani"));
+    biblioteca.aggiungiMedia(new Film("Nuovo Cinema Paradiso", 1988, "Giuseppe Tornatore", 155, "Drammatico"));
+    biblioteca.aggiornaMetriche();
+    assert(Metrics::gauge("biblioteca.libri").value() == 1);
+    assert(Metrics::gauge("biblioteca.film").value() == 1);
+    assert(Metrics::gauge("biblioteca.articoli").value() == 0);
+    assert(Metrics::gauge("biblioteca.byte_stringhe").value() > 0);
+
+    const QJsonObject snapshot = Metrics::Registry::instance().snapshot();
+    assert(snapshot["contatori"].toObject()["test.contatore"].toInt() == 4);
+    assert(snapshot["indicatori"].toObject()["biblioteca.media"].toInt() == 2);
+
+    Metrics::Registry::instance().reset();
+    assert(contatore.value() == 0);
+    std::cout << "✓ Test Metriche passed" << std::endl;
+}
+
+void testMemoryFootprint() {
+    // Stringhe: nessuno heap per null e vuote, intestazione e caratteri per le altre
+    assert(MemoryReport::stringBytes(QString()) == 0);
+    assert(MemoryReport::stringBytes(QString("")) == 0);
+    const QString autore("Umberto Eco");
+    assert(MemoryReport::stringBytes(autore) >= qint64(autore.size()) * 2);
+
+    Book libro("Il Nome della Rosa", 1980, autore, "978-88-452-0734-1", "Bompiani");
+    const qint64 impronta = libro.memoryFootprint();
+    assert(impronta >= MemoryReport::allocationBytes(sizeof(Book)) + MemoryReport::stringBytes(autore));
+
+    Biblioteca biblioteca;
+    biblioteca.aggiungiMedia(libro.clone());
+    biblioteca.aggiungiMedia(new Book("Il Pendolo di Foucault", 1988, autore, "978-88-452-1591-9", "Bompiani"));
+    biblioteca.aggiungiMedia(new Film("Nuovo Cinema Paradiso", 1988, "Giuseppe Tornatore", 155, "Drammatico"));
+
+    MemoryReport report = biblioteca.memoryFootprint();
+    assert(report.entries()["Book"]["oggetto"].count == 2);
+    assert(report.entries()["Film"]["oggetto"].count == 1);
+    assert(report.bytes("Book", "author") > 0);
+    // Il buffer dell'autore è condiviso tra i due libri: contato una volta sola
+    assert(report.bytes("Book", "author") == MemoryReport::stringBytes(autore));
+    assert(report.sharedStringBytes() >= MemoryReport::stringBytes(autore));
+    assert(report.bytes("Indici") == 0);
+
+    qint64 somma = 0;
+    for (const QString &categoria : report.entries().keys()) {
+        somma += report.bytes(categoria);
+    }
+    assert(somma == report.total());
+
+    // Dopo una query gli indici esistono e compaiono nel report
+    biblioteca.cercaPerAnno(1988);
+    report = biblioteca.memoryFootprint();
+    assert(report.bytes("Indici", "anni") > 0);
+    assert(report.toJson()["totale"].toDouble() == double(report.total()));
+    assert(!report.format().isEmpty());
+    std::cout << "✓ Test MemoryFootprint passed" << std::endl;
+}
+
+void testScambioBiblioteca() {
+    Biblioteca prima;
+    prima.aggiungiMedia(new Book("Il Nome della Rosa", 1980, "Umberto Eco", "978-88-452-0734-1", "Bompiani"));
+    prima.aggiungiMedia(new Film("Nuovo Cinema Paradiso", 1988, "Giuseppe Tornatore", 155, "Drammatico"));
+    assert(prima.cercaPerAnno(1988).size() == 1); // indici costruiti prima dello scambio
+    Media *libro = prima.getMediaAt(0);
+
+    Biblioteca seconda;
+    seconda.swap(prima);
+    assert(prima.dimensione() == 0);
+    assert(seconda.dimensione() == 2);
+    assert(seconda.getMediaAt(0) == libro); // nessuna copia
+    assert(seconda.cercaPerAnno(1988).size() == 1);
+    assert(prima.cercaPerAnno(1988).isEmpty());
+
+    Biblioteca spostata(std::move(seconda));
+    assert(spostata.dimensione() == 2 && seconda.dimensione() == 0);
+    assert(spostata.getMediaAt(0) == libro);
+    std::cout << "✓ Test Scambio Biblioteca passed" << std::endl;
+}
+
+void testCaricamentoConAvanzamento() {
+    QTemporaryDir cartella;
+    assert(cartella.isValid());
+    const QString percorso = cartella.filePath("catalogo.json");
+    {
+        Biblioteca origine;
+        for (int i = 0; i < 10; ++i) {
+            origine.aggiungiMedia(new Book(QString("Libro %1").arg(i), 2000 + i, "Autore", QString("isbn-%1").arg(i), "Editore"));
+        }
+        JsonSerializer::salvaBibliotecaThrows(origine, percorso);
+    }
+
+    std::atomic<bool> annullato{false};
+    qint64 byteLetti = 0;
+    int ultimoRecord = -1;
+    int anteprime = 0;
+    JsonSerializer::Avanzamento avanzamento;
+    avanzamento.annullato = &annullato;
+    avanzamento.dimensioneAnteprima = 3;
+    avanzamento.lettura = [&byteLetti](qint64 letti, qint64 totali) {
+        assert(letti <= totali);
+        byteLetti = letti;
+    };
+    avanzamento.record = [&ultimoRecord](int record, int totali) {
+        assert(record <= totali);
+        ultimoRecord = record;
+    };
+    avanzamento.anteprima = [&anteprime](const QList<Media *> &primi) {
+        anteprime += primi.size();
+        qDeleteAll(primi);
+    };
+
+    Biblioteca biblioteca;
+    JsonSerializer::caricaBibliotecaThrows(biblioteca, percorso, avanzamento);
+    assert(biblioteca.dimensione() == 10);
+    assert(byteLetti == QFileInfo(percorso).size());
+    assert(ultimoRecord == 10);
+    assert(anteprime == 3);
+
+    // Annullato: eccezione dedicata e biblioteca di destinazione invariata
+    annullato.store(true);
+    bool eccezione = false;
+    try {
+        JsonSerializer::caricaBibliotecaThrows(biblioteca, percorso, avanzamento);
+    } catch (const OperazioneAnnullataException &) {
+        eccezione = true;
+    }
+    assert(eccezione);
+    assert(biblioteca.dimensione() == 10);
+
+    // Un osservatore che lancia interrompe il caricamento: le copie dell'anteprima
+    // restano all'importatore e la destinazione non cambia
+    annullato.store(false);
+    avanzamento.anteprima = [](const QList<Media *> &) {
+        throw BibliotecaException("anteprima non disponibile");
+    };
+    eccezione = false;
+    try {
+        JsonSerializer::caricaBibliotecaThrows(biblioteca, percorso, avanzamento);
+    } catch (const BibliotecaException &) {
+        eccezione = true;
+    }
+    assert(eccezione);
+    assert(biblioteca.dimensione() == 10);
+    std::cout << "✓ Test Caricamento con Avanzamento passed" << std::endl;
+}
+
+void testSalvataggioAsincrono() {
+    QTemporaryDir cartella;
+    assert(cartella.isValid());
+    const QString percorso = cartella.filePath("sessione.json");
+
+    Biblioteca biblioteca;
+    for (int i = 0; i < 50; ++i) {
+        biblioteca.aggiungiMedia(new Film(QString("Film %1").arg(i), 1990 + i % 30, "Regista", 100, "Drammatico"));
+    }
+
+    QStringList salvati;
+    QList<int> elementi;
+    AsyncSaver salvataggi;
+    QObject::connect(&salvataggi, &AsyncSaver::salvato, [&](const QString &file, int numero) {
+        salvati.append(file);
+        elementi.append(numero);
+    });
+
+    // L'istantanea è presa alla richiesta: le modifiche successive non entrano nel file
+    salvataggi.salva(biblioteca, percorso);
+    biblioteca.aggiungiMedia(new Book("Dopo la prima richiesta", 2020, "Autore", "isbn-x", "Editore"));
+    salvataggi.salva(biblioteca, percorso);
+    biblioteca.aggiungiMedia(new Book("Dopo la seconda richiesta", 2021, "Autore", "isbn-y", "Editore"));
+    salvataggi.salva(biblioteca, percorso);
+    salvataggi.attendi();
+    assert(!salvataggi.occupato());
+
+    // Se la prima scrittura era ancora in corso le due richieste successive
+    // sono state unite; l'ultima istantanea è comunque quella sul disco
+    assert(!salvati.isEmpty() && salvati.size() <= 3);
+    assert(salvati.last() == percorso);
+    assert(elementi.last() == 52);
+
+    Biblioteca caricata;
+    JsonSerializer::caricaBibliotecaThrows(caricata, percorso);
+    assert(caricata.dimensione() == 52);
+
+    // Nessun file temporaneo lasciato accanto a quello salvato
+    assert(QDir(cartella.path()).entryList(QDir::Files) == QStringList{"sessione.json"});
+
+    // Errore di scrittura: segnalato, il file esistente resta intatto
+    QStringList errori;
+    QObject::connect(&salvataggi, &AsyncSaver::fallito, [&errori](const QString &file, const QString &) {
+        errori.append(file);
+    });
+    const QString nonScrivibile = cartella.filePath("mancante/sessione.json");
+    salvataggi.salva(biblioteca, nonScrivibile);
+    salvataggi.attendi();
+    assert(errori == QStringList{nonScrivibile});
+    assert(QFileInfo(percorso).size() > 0);
+
+    // Istantanea presa prima della richiesta (come fa il caricamento della GUI nel
+    // thread di lavoro): le modifiche successive non entrano nel file
+    MediaStore istantanea = biblioteca.istantanea();
+    biblioteca.aggiungiMedia(new Book("Dopo l'istantanea", 2022, "Autore", "isbn-z", "Editore"));
+    salvataggi.salva(std::move(istantanea), percorso);
+    salvataggi.attendi();
+    assert(elementi.last() == 52);
+    JsonSerializer::caricaBibliotecaThrows(caricata, percorso);
+    assert(caricata.dimensione() == 52);
+    std::cout << "✓ Test Salvataggio Asincrono passed" << std::endl;
+}
+
+void testJournal() {
+    QTemporaryDir cartella;
+    assert(cartella.isValid());
+    const QString snapshot = cartella.filePath("sessione.json");
+
+    {
+        Journal journal(snapshot);
+        Biblioteca biblioteca;
+        const int riapplicati = journal.ripristina(biblioteca);
+        assert(riapplicati == 0);
+        Q_UNUSED(riapplicati);
+        assert(biblioteca.isEmpty());
+
+        for (int i = 0; i < 3; ++i) {
+            Book *libro = new Book(QString("Libro %1").arg(i), 2000 + i, "Autore", QString("isbn-%1").arg(i), "Editore");
+            biblioteca.aggiungiMedia(libro);
+            journal.registraAggiunta(*libro);
+        }
+        Film *film = new Film("Film sostitutivo", 1999, "Regista", 120, "Giallo");
+        biblioteca.sostituisciMediaAt(1, film);
+        journal.registraModifica(biblioteca.indiceDi(film), *film);
+        journal.registraRimozione(0);
+        biblioteca.rimuoviMediaAt(0);
+
+        // Group commit: niente su disco finché commit() non scrive i cinque record insieme
+        assert(journal.recordInSospeso() == 5);
+        assert(!QFileInfo::exists(journal.filePath(0)));
+        journal.commit();
+        assert(journal.recordInSospeso() == 0);
+        assert(QFileInfo(journal.filePath(0)).size() < 1024);
+    }
+
+    // Ripristino senza snapshot: solo il journal
+    Biblioteca ripristinata;
+    {
+        Journal journal(snapshot);
+        const int riapplicati = journal.ripristina(ripristinata);
+        assert(riapplicati == 5);
+        Q_UNUSED(riapplicati);
+        assert(ripristinata.dimensione() == 2);
+        assert(ripristinata.getMediaAt(0)->getTitle() == "Film sostitutivo");
+        assert(ripristinata.getMediaAt(1)->getTitle() == "Libro 2");
+
+        // Compattazione: snapshot con la nuova generazione, generazioni precedenti eliminate
+        journal.compatta(ripristinata);
+        assert(journal.generazione() == 1);
+        assert(QFileInfo::exists(snapshot));
+        assert(!QFileInfo::exists(journal.filePath(0)));
+    }
+
+    // Ultimo record interrotto a metà: scartato, e il file riparte dal record valido
+    {
+        Journal journal(snapshot);
+        Biblioteca biblioteca;
+        const int riapplicati = journal.ripristina(biblioteca);
+        assert(riapplicati == 0);
+        Q_UNUSED(riapplicati);
+        Book libro("Dopo lo snapshot", 2024, "Autore", "isbn-n", "Editore");
+        journal.registraAggiunta(libro);
+        journal.commit();
+    }
+    {
+        QFile file(cartella.filePath("sessione.json.journal.1"));
+        const bool aperto = file.open(QIODevice::Append);
+        assert(aperto);
+        Q_UNUSED(aperto);
+        file.write("{\"op\":\"aggi");
+    }
+    {
+        Journal journal(snapshot);
+        Biblioteca biblioteca;
+        const int riapplicati = journal.ripristina(biblioteca);
+        assert(riapplicati == 1);
+        Q_UNUSED(riapplicati);
+        assert(biblioteca.dimensione() == 3);
+        journal.registraRimozione(0);
+        journal.commit();
+    }
+    {
+        Journal journal(snapshot);
+        Biblioteca biblioteca;
+        const int riapplicati = journal.ripristina(biblioteca);
+        assert(riapplicati == 2);
+        Q_UNUSED(riapplicati);
+        assert(biblioteca.dimensione() == 2);
+        assert(biblioteca.getMediaAt(1)->getTitle() == "Dopo lo snapshot");
+    }
+
+    // Compattazione interrotta dopo lo snapshot: la generazione vecchia è ignorata
+    {
+        Journal journal(snapshot);
+        Biblioteca biblioteca;
+        journal.ripristina(biblioteca);
+        const qint64 generazione = journal.nuovaGenerazione();
+        SnapshotRotation(snapshot, 1).scrivi(JsonSerializer::serializzaIstantanea(biblioteca.istantanea(), generazione), generazione);
+        // snapshotCompletato() non chiamato: il journal 1 resta su disco
+    }
+    {
+        Journal journal(snapshot);
+        Biblioteca biblioteca;
+        const int riapplicati = journal.ripristina(biblioteca);
+        assert(riapplicati == 0);
+        Q_UNUSED(riapplicati);
+        assert(biblioteca.dimensione() == 2);
+        assert(journal.generazione() == 2);
+        assert(!QFileInfo::exists(journal.filePath(1)));
+    }
+
+    // Nuova sessione compattata senza ripristino: la generazione riparte sopra quelle
+    // su disco e il journal della sessione precedente non viene più riapplicato
+    {
+        Journal journal(snapshot);
+        Biblioteca biblioteca;
+        journal.ripristina(biblioteca);
+        journal.compatta(biblioteca);
+        journal.compatta(biblioteca);
+        journal.registraRimozione(0);
+        journal.commit();
+        assert(journal.generazione() == 4);
+    }
+    {
+        Journal journal(snapshot);
+        Biblioteca nuova;
+        nuova.aggiungiMedia(new Book("Biblioteca di esempio", 2020, "Autore", "isbn-e", "Editore"));
+        journal.compatta(nuova);
+        assert(journal.generazione() == 5);
+        assert(!QFileInfo::exists(journal.filePath(4)));
+        Book libro("Aggiunto dopo", 2021, "Autore", "isbn-f", "Editore");
+        journal.registraAggiunta(libro);
+        journal.commit();
+    }
+    {
+        Journal journal(snapshot);
+        Biblioteca biblioteca;
+        const int riapplicati = journal.ripristina(biblioteca);
+        assert(riapplicati == 1);
+        Q_UNUSED(riapplicati);
+        assert(biblioteca.dimensione() == 2);
+        assert(biblioteca.getMediaAt(0)->getTitle() == "Biblioteca di esempio");
+        assert(biblioteca.getMediaAt(1)->getTitle() == "Aggiunto dopo");
+    }
+
+    // Riga completa non valida: non è una scrittura interrotta, il ripristino si ferma
+    // senza troncare il file né riapplicare le generazioni successive
+    const QByteArray valido = "{\"op\":\"rimuovi\",\"indice\":0}\n";
+    {
+        QFile file(cartella.filePath("sessione.json.journal.5"));
+        const bool aperto = file.open(QIODevice::Append);
+        assert(aperto);
+        Q_UNUSED(aperto);
+        file.write(QByteArray("{\"op\":\"rimuovi\",\"indice\":99}\n") + valido);
+        QFile successiva(cartella.filePath("sessione.json.journal.6"));
+        const bool apertaSuccessiva = successiva.open(QIODevice::WriteOnly);
+        assert(apertaSuccessiva);
+        Q_UNUSED(apertaSuccessiva);
+        successiva.write(valido);
+    }
+    const qint64 dimensioneDanneggiata = QFileInfo(cartella.filePath("sessione.json.journal.5")).size();
+    {
+        Journal journal(snapshot);
+        Biblioteca biblioteca;
+        biblioteca.aggiungiMedia(new Book("Invariato", 2000, "Autore", "isbn-i", "Editore"));
+        bool interrotto = false;
+        try {
+            journal.ripristina(biblioteca);
+        } catch (const JsonParseException &) {
+            interrotto = true;
+        }
+        assert(interrotto);
+        assert(biblioteca.dimensione() == 1 && biblioteca.getMediaAt(0)->getTitle() == "Invariato");
+        assert(QFileInfo(cartella.filePath("sessione.json.journal.5")).size() == dimensioneDanneggiata);
+        assert(QFileInfo(cartella.filePath("sessione.json.journal.6")).size() == valido.size());
+    }
+    std::cout << "✓ Test Journal passed" << std::endl;
+}
+
+void testSnapshotRotation() {
+    QTemporaryDir cartella;
+    assert(cartella.isValid());
+    const QString snapshot = cartella.filePath("sessione.json");
+
+    // Tre compattazioni con tre copie: ogni copia conserva la sua generazione
+    {
+        Journal journal(snapshot, 3);
+        Biblioteca biblioteca;
+        journal.ripristina(biblioteca);
+        for (int i = 0; i < 3; ++i) {
+            Book *libro = new Book(QString("Libro %1").arg(i), 2000 + i, "Autore", QString("isbn-%1").arg(i), "Editore");
+            biblioteca.aggiungiMedia(libro);
+            journal.registraAggiunta(*libro);
+            journal.compatta(biblioteca);
+        }
+        // Una modifica dopo l'ultimo snapshot, solo nel journal
+        journal.registraRimozione(0);
+        journal.commit();
+    }
+    SnapshotRotation rotazione(snapshot, 3);
+    for (int copia = 0; copia < 3; ++copia) {
+        assert(rotazione.verifica(copia));
+        assert(rotazione.generazioneJournal(copia) == 3 - copia);
+    }
+    assert(rotazione.piuRecenteValida() == 0);
+    assert(rotazione.generazioneMinima() == 1);
+
+    // Copia più recente danneggiata: si riparte dalla precedente e il journal
+    // delle generazioni successive ricostruisce comunque lo stato finale
+    {
+        QFile file(rotazione.filePath(0));
+        const bool aperto = file.open(QIODevice::ReadWrite);
+        assert(aperto);
+        Q_UNUSED(aperto);
+        file.seek(10);
+        file.write("X");
+    }
+    assert(!rotazione.verifica(0));
+    assert(rotazione.piuRecenteValida() == 1);
+    {
+        Journal journal(snapshot, 3);
+        Biblioteca biblioteca;
+        const int riapplicati = journal.ripristina(biblioteca);
+        assert(riapplicati == 2);
+        Q_UNUSED(riapplicati);
+        assert(biblioteca.dimensione() == 2);
+        assert(biblioteca.getMediaAt(0)->getTitle() == "Libro 1");
+    }
+
+    // Troncata: scartata senza leggerla tutta (la dimensione non coincide)
+    {
+        QFile file(rotazione.filePath(1));
+        const bool aperto = file.open(QIODevice::ReadWrite);
+        assert(aperto);
+        Q_UNUSED(aperto);
+        const bool troncato = file.resize(file.size() / 2);
+        assert(troncato);
+        Q_UNUSED(troncato);
+    }
+    assert(rotazione.piuRecenteValida() == 2);
+    {
+        Journal journal(snapshot, 3);
+        Biblioteca biblioteca;
+        const int riapplicati = journal.ripristina(biblioteca);
+        assert(riapplicati == 3);
+        Q_UNUSED(riapplicati);
+        assert(biblioteca.dimensione() == 2);
+    }
+    std::cout << "✓ Test Snapshot Rotation passed" << std::endl;
+}
+
+void testCaricamentoDifferito() {
+    QTemporaryDir cartella;
+    assert(cartella.isValid());
+    const QString percorso = cartella.filePath("catalogo.json");
+    Biblioteca origine;
+    origine.aggiungiMedia(new Book("Il nome della rosa", 1980, "Umberto Eco", "978-88-452-0000-0", "Bompiani", "rosa.png"));
+    origine.aggiungiMedia(new Film("Nuovo Cinema Paradiso", 1988, "Giuseppe Tornatore", 155, "Drammatico"));
+    origine.aggiungiMedia(new MagazineArticle("Reti neurali", 2019, "Rossi", "Le Scienze", "10.1000/xyz"));
+    JsonSerializer::salvaBibliotecaThrows(origine, percorso);
+
+    JsonSerializer::Avanzamento opzioni;
+    opzioni.campiDifferiti = true;
+    Biblioteca biblioteca;
+    JsonSerializer::caricaBibliotecaThrows(biblioteca, percorso, opzioni);
+    assert(biblioteca.dimensione() == 3);
+    for (Media *media : biblioteca.getTuttiMedia()) {
+        assert(media->campiDifferiti());
+    }
+
+    // Indici, ricerca per titolo e stima della memoria non materializzano nulla
+    assert(biblioteca.cercaPerAnno(1988).size() == 1);
+    assert(biblioteca.cercaPerTitolo("rosa").size() == 1);
+    assert(biblioteca.collectMediaByType(MediaFilter::FilterType::FILMS_ONLY).size() == 1);
+    const MemoryReport report = biblioteca.memoryFootprint();
+    assert(report.entries().value("Book").value("differiti").count == 1);
+    for (Media *media : biblioteca.getTuttiMedia()) {
+        assert(media->campiDifferiti());
+    }
+
+    // Primo accesso: decodifica del solo Media letto
+    Book *libro = dynamic_cast<Book *>(biblioteca.getMediaAt(0));
+    assert(libro && libro->getIsbn() == "978-88-452-0000-0");
+    assert(!libro->campiDifferiti());
+    assert(libro->getCoverImagePath() == "rosa.png");
+    assert(biblioteca.getMediaAt(1)->campiDifferiti());
+
+    // Un setter non perde gli altri campi ancora nel record
+    Film *film = dynamic_cast<Film *>(biblioteca.getMediaAt(1));
+    film->setGenre("Commedia");
+    assert(film->getDirector() == "Giuseppe Tornatore" && film->getDuration() == 155);
+
+    // Copie e serializzazione equivalenti a quelle di un Media decodificato
+    Media *copia = biblioteca.getMediaAt(2)->clone();
+    assert(copia->campiDifferiti());
+    assert(copia->serializza() == origine.getMediaAt(2)->serializza());
+    assert(biblioteca.getMediaAt(2)->campiDifferiti());
+    delete copia;
+
+    // L'esportazione parallela materializza la selezione prima di passarla al pool
+    StreamExporter::Opzioni esportazione;
+    esportazione.recordPerBlocco = 1;
+    const StreamExporter::Report esportati = StreamExporter::esportaThrows(
+        biblioteca, biblioteca.eseguiQuery(MediaFilter::Query()), cartella.filePath("catalogo.jsonl"), esportazione);
+    assert(esportati.esportati == 3);
+    assert(!biblioteca.getMediaAt(2)->campiDifferiti());
+    std::cout << "✓ Test Caricamento Differito passed" << std::endl;
+}
+
+void testCatalogoShard() {
+    QTemporaryDir cartella;
+    assert(cartella.isValid());
+    const QString manifest = cartella.filePath("catalogo" + ShardedCatalog::EstensioneManifest);
+    Biblioteca origine;
+    for (int i = 0; i < 200; ++i) {
+        origine.aggiungiMedia(new Book(QString("Libro %1").arg(i), 1800 + i, "Autore", QString("isbn-%1").arg(i), "Editore"));
+    }
+    origine.aggiungiMedia(new Film("Nuovo Cinema Paradiso", 1988, "Giuseppe Tornatore", 155, "Drammatico"));
+
+    ShardedCatalog::Opzioni opzioni;
+    opzioni.numeroShard = 4;
+    ShardedCatalog::Report report = ShardedCatalog::salvaThrows(origine, manifest, opzioni);
+    assert(report.shardTotali == 4 && report.shardScritti == 4);
+    assert(QDir(cartella.path()).entryList(QStringList{"catalogo.shard-*.json"}, QDir::Files).size() == 4);
+
+    // Il manifest si apre come un normale file di biblioteca, anche in modalità differita
+    JsonSerializer::Avanzamento avanzamento;
+    avanzamento.campiDifferiti = true;
+    int ultimoRecord = 0;
+    avanzamento.record = [&ultimoRecord](int record, int totale) {
+        assert(record <= totale);
+        ultimoRecord = record;
+    };
+    Biblioteca caricata;
+    JsonSerializer::caricaBibliotecaThrows(caricata, manifest, avanzamento);
+    assert(caricata.dimensione() == origine.dimensione());
+    assert(ultimoRecord == origine.dimensione());
+    assert(caricata.cercaPerTitolo("Paradiso").size() == 1);
+
+    // Senza modifiche nessuno shard viene riscritto; una modifica riscrive solo il suo
+    report = ShardedCatalog::salvaThrows(origine, manifest, opzioni);
+    assert(report.shardScritti == 0);
+    origine.getMediaAt(0)->setYear(2024);
+    report = ShardedCatalog::salvaThrows(origine, manifest, opzioni);
+    assert(report.shardScritti == 1);
+    assert(QDir(cartella.path()).entryList(QStringList{"catalogo.shard-*.json"}, QDir::Files).size() == 4);
+
+    // Numero di shard non positivo: un solo shard, come indicato da shardTotali
+    ShardedCatalog::Opzioni nonValide;
+    for (const int numero : {0, -3}) {
+        nonValide.numeroShard = numero;
+        const ShardedCatalog::Report unico =
+            ShardedCatalog::salvaThrows(origine, cartella.filePath("unico" + ShardedCatalog::EstensioneManifest), nonValide);
+        assert(unico.shardTotali == 1);
+    }
+
+    // Partizione per tipo: uno shard per tipo concreto, importazione trasparente
+    opzioni.partizione = ShardedCatalog::Partizione::Tipo;
+    report = ShardedCatalog::salvaThrows(origine, manifest, opzioni);
+    assert(report.shardTotali == 3);
+    Biblioteca importata;
+    const Deduplicazione::Report importazione =
+        JsonSerializer::importaBibliotecaThrows(importata, manifest, Deduplicazione::Politica::RIFIUTA);
+    assert(importazione.aggiunti == origine.dimensione());
+    assert(importata.collectMediaByType(MediaFilter::FilterType::FILMS_ONLY).size() == 1);
+
+    // Uno shard troncato invalida il caricamento e lascia intatta la destinazione
+    for (const QString &file : QDir(cartella.path()).entryList(QStringList{"catalogo.shard-0.*.json"}, QDir::Files)) {
+        QFile shard(cartella.filePath(file));
+        const bool aperto = shard.open(QIODevice::ReadWrite);
+        assert(aperto);
+        Q_UNUSED(aperto);
+        const bool troncato = shard.resize(shard.size() / 2);
+        assert(troncato);
+        Q_UNUSED(troncato);
+    }
+    bool rifiutato = false;
+    try {
+        JsonSerializer::caricaBibliotecaThrows(caricata, manifest);
+    } catch (const JsonParseException &) {
+        rifiutato = true;
+    }
+    assert(rifiutato);
+    assert(caricata.dimensione() == origine.dimensione());
+    std::cout << "✓ Test Catalogo Shard passed" << std::endl;
+}
+
+void testCompressione() {
+    // Più blocchi piccoli: l'ordine e i confini dei blocchi vengono ricomposti esattamente
+    QByteArray testo;
+    for (int i = 0; i < 5000; ++i) {
+        testo += QByteArray::number(i) + " ripetuto ";
+    }
+    const QByteArray compresso = BlockCompression::comprimi(testo, -1, 4096);
+    assert(BlockCompression::isCompresso(compresso));
+    assert(compresso.size() < testo.size());
+    assert(BlockCompression::decomprimi(compresso) == testo);
+    assert(BlockCompression::decomprimi(BlockCompression::comprimi(QByteArray())).isEmpty());
+
+    QTemporaryDir cartella;
+    assert(cartella.isValid());
+    Biblioteca origine;
+    for (int i = 0; i < 100; ++i) {
+        origine.aggiungiMedia(new Book(QString("Libro %1").arg(i), 1800 + i, "Autore", QString("isbn-%1").arg(i), "Editore"));
+    }
+    const QString percorso = cartella.filePath("catalogo.json" + BlockCompression::Estensione);
+    JsonSerializer::salvaBibliotecaThrows(origine, percorso);
+    QByteArray suDisco;
+    {
+        QFile file(percorso);
+        const bool aperto = file.open(QIODevice::ReadOnly);
+        assert(aperto);
+        Q_UNUSED(aperto);
+        suDisco = file.readAll();
+    }
+    assert(BlockCompression::isCompresso(suDisco));
+
+    // Il formato si riconosce dai byte iniziali, anche con estensione .json
+    const QString rinominato = cartella.filePath("catalogo.json");
+    assert(QFile::copy(percorso, rinominato));
+    Biblioteca caricata;
+    JsonSerializer::caricaBibliotecaThrows(caricata, rinominato);
+    assert(caricata.dimensione() == origine.dimensione());
+    assert(caricata.getMediaAt(99)->getTitle() == "Libro 99");
+
+    // File troncato: errore esplicito, la biblioteca resta invariata
+    {
+        QFile file(rinominato);
+        const bool aperto = file.open(QIODevice::ReadWrite);
+        assert(aperto);
+        Q_UNUSED(aperto);
+        const bool troncato = file.resize(file.size() - 10);
+        assert(troncato);
+        Q_UNUSED(troncato);
+    }
+    bool rifiutato = false;
+    try {
+        JsonSerializer::caricaBibliotecaThrows(caricata, rinominato);
+    } catch (const InvalidDataException &) {
+        rifiutato = true;
+    }
+    assert(rifiutato);
+    assert(caricata.dimensione() == origine.dimensione());
+    std::cout << "✓ Test Compressione passed" << std::endl;
+}
+
+void testImportazioneBatch() {
+    // Blocchi piccoli e più analizzatori: l'inserimento segue comunque l'ordine del file
+    BatchImporter::Opzioni opzioni;
+    opzioni.analizzatori = 3;
+    opzioni.recordPerBlocco = 2;
+
+    QByteArray csv = "type,title,year,author,isbn,publisher,director,duration,genre\n";
+    for (int i = 0; i < 50; ++i) {
+        csv += QString("Book,Libro %1,%2,Autore,isbn-%1,Editore,,,\n").arg(i).arg(1800 + i).toUtf8();
+    }
+    csv += "Film,\"Ladri di biciclette, restaurato\",1948,,,,De Sica,89,Drammatico\n";
+    csv += "Film,Senza durata,1950,,,,Regista,,Drammatico\n";
+    csv += "Book,\"Titolo su\ndue righe\",1990,Autore,isbn-x,Editore,,,\n";
+    csv += "Book,Anno sbagliato,19x0,Autore,isbn-y,Editore,,,\n";
+    QBuffer sorgenteCsv(&csv);
+    const bool apertoCsv = sorgenteCsv.open(QIODevice::ReadOnly);
+    assert(apertoCsv);
+    Q_UNUSED(apertoCsv);
+    Biblioteca biblioteca;
+    BatchImporter::Report report = BatchImporter::importaThrows(biblioteca, sorgenteCsv, BatchImporter::Formato::Csv, opzioni);
+    assert(report.record == 54);
+    assert(report.scartati == 2);
+    assert(report.deduplicazione.aggiunti == 52);
+    assert(biblioteca.dimensione() == 52);
+    for (int i = 0; i < 50; ++i) {
+        assert(biblioteca.getMediaAt(i)->getTitle() == QString("Libro %1").arg(i));
+    }
+    assert(biblioteca.getMediaAt(50)->getTitle() == "Ladri di biciclette, restaurato");
+    assert(biblioteca.getMediaAt(51)->getTitle() == "Titolo su\ndue righe");
+    // Gli errori indicano la riga del file (intestazione = riga 1)
+    assert(report.errori.size() == 2);
+    assert(report.errori.at(0).riga == 53);
+    assert(report.errori.at(1).riga == 56);
+
+    // JSON-lines: stesso formato dei record di JsonSerializer, righe non valide segnalate
+    QByteArray jsonl;
+    jsonl += QJsonDocument(Book("Il nome della rosa", 1980, "Umberto Eco", "978-88-452-0000-0", "Bompiani").serializza()).toJson(QJsonDocument::Compact) + "\n";
+    jsonl += "{non json}\n\n";
+    jsonl += QJsonDocument(MagazineArticle("Reti neurali", 2019, "Rossi", "Le Scienze", "10.1000/xyz").serializza()).toJson(QJsonDocument::Compact) + "\n";
+    QBuffer sorgenteJsonl(&jsonl);
+    const bool apertoJsonl = sorgenteJsonl.open(QIODevice::ReadOnly);
+    assert(apertoJsonl);
+    Q_UNUSED(apertoJsonl);
+    report = BatchImporter::importaThrows(biblioteca, sorgenteJsonl, BatchImporter::Formato::JsonLines, opzioni);
+    assert(report.record == 3 && report.scartati == 1 && report.errori.at(0).riga == 2);
+    assert(report.deduplicazione.aggiunti == 2);
+
+    // MARC testuale: tipo dal leader, duplicati gestiti come nelle altre importazioni
+    QByteArray marc =
+        "=LDR  00000nam a2200000 a 4500\n"
+        "=020  \\\\$a9788845292613 (pbk.)\n"
+        "=100  1\\$aCalvino, Italo.\n"
+        "=245  10$aLe citta invisibili /$cItalo Calvino.\n"
+        "=260  \\\\$aTorino :$bEinaudi,$cc1972.\n"
+        "\n"
+        "=LDR  00000ngm a2200000 a 4500\n"
+        "=245  00$aNuovo Cinema Paradiso$h[videorecording].\n"
+        "=260  \\\\$bTitanus,$c1988.\n"
+        "=306  \\\\$a025500\n"
+        "=508  \\\\$aGiuseppe Tornatore.\n"
+        "=655  \\7$aDrammatico.\n"
+        "\n"
+        "=LDR  00000nab a2200000 a 4500\n"
+        "=100  1\\$aRossi, Mario.\n"
+        "=245  10$aReti neurali.\n"
+        "=260  \\\\$c2019.\n"
+        "=773  0\\$tLe Scienze\n"
+        "=024  7\\$a10.1000/xyz$2doi\n";
+    QBuffer sorgenteMarc(&marc);
+    const bool apertoMarc = sorgenteMarc.open(QIODevice::ReadOnly);
+    assert(apertoMarc);
+    Q_UNUSED(apertoMarc);
+    report = BatchImporter::importaThrows(biblioteca, sorgenteMarc, BatchImporter::Formato::Marc, opzioni);
+    assert(report.record == 3 && report.scartati == 0);
+    assert(report.deduplicazione.aggiunti == 2 && report.deduplicazione.rifiutati == 1);
+    Book *libro = dynamic_cast<Book *>(biblioteca.getMediaAt(biblioteca.dimensione() - 2));
+    assert(libro && libro->getTitle() == "Le citta invisibili" && libro->getYear() == 1972);
+    assert(libro->getIsbn() == "9788845292613" && libro->getPublisher() == "Einaudi");
+    Film *film = dynamic_cast<Film *>(biblioteca.getMediaAt(biblioteca.dimensione() - 1));
+    assert(film && film->getDuration() == 175 && film->getDirector() == "Giuseppe Tornatore");
+
+    // Intestazione CSV senza le colonne obbligatorie
+    QByteArray senzaTipo = "title,year\nTitolo,2000\n";
+    QBuffer sorgenteErrata(&senzaTipo);
+    const bool apertoErrata = sorgenteErrata.open(QIODevice::ReadOnly);
+    assert(apertoErrata);
+    Q_UNUSED(apertoErrata);
+    bool rifiutata = false;
+    try {
+        BatchImporter::importaThrows(biblioteca, sorgenteErrata, BatchImporter::Formato::Csv, opzioni);
+    } catch (const InvalidDataException &) {
+        rifiutata = true;
+    }
+    assert(rifiutata);
+    std::cout << "✓ Test Importazione Batch passed" << std::endl;
+}
+
+void testEsportazioneStreaming() {
+    Biblioteca biblioteca;
+    for (int i = 0; i < 40; ++i) {
+        biblioteca.aggiungiMedia(new Book(QString("Libro %1").arg(i), 1900 + i, "Autore", QString("isbn-%1").arg(i), "Editore"));
+    }
+    biblioteca.aggiungiMedia(new Film("Titolo, con \"virgolette\"\ne a capo", 1960, "Fellini", 174, "Drammatico"));
+    biblioteca.aggiungiMedia(new Film("Commedia", 1961, "Monicelli", 100, "Commedia"));
+    biblioteca.aggiungiMedia(new MagazineArticle("Reti neurali", 2019, "Rossi", "Le Scienze", "10.1000/xyz"));
+    const RoaringBitmap tutti = biblioteca.eseguiQuery(MediaFilter::Query());
+
+    QTemporaryDir dir;
+    assert(dir.isValid());
+    const auto leggi = [](const QString &path) {
+        QFile file(path);
+        const bool aperto = file.open(QIODevice::ReadOnly);
+        assert(aperto);
+        Q_UNUSED(aperto);
+        return file.readAll();
+    };
+
+    // Blocchi piccoli: l'uscita parallela coincide byte per byte con quella sequenziale
+    StreamExporter::Opzioni opzioni;
+    opzioni.recordPerBlocco = 3;
+    for (const StreamExporter::Formato formato : {StreamExporter::Formato::Csv, StreamExporter::Formato::JsonLines}) {
+        opzioni.formato = formato;
+        opzioni.parallelo = true;
+        const StreamExporter::Report report = StreamExporter::esportaThrows(biblioteca, tutti, dir.filePath("parallelo"), opzioni);
+        opzioni.parallelo = false;
+        StreamExporter::esportaThrows(biblioteca, tutti, dir.filePath("sequenziale"), opzioni);
+        assert(report.esportati == 43);
+        assert(report.byte == QFileInfo(dir.filePath("parallelo")).size());
+        assert(leggi(dir.filePath("parallelo")) == leggi(dir.filePath("sequenziale")));
+    }
+
+    // Le righe JSON sono i record di JsonSerializer
+    const QList<QByteArray> righe = leggi(dir.filePath("parallelo")).split('\n');
+    assert(righe.size() == 44 && righe.last().isEmpty());
+    const QJsonObject film = QJsonDocument::fromJson(righe.at(40)).object();
+    assert(film.value(MediaKeys::Type).toString() == "Film");
+    assert(film.value(MediaKeys::Title).toString() == "Titolo, con \"virgolette\"\ne a capo");
+    assert(film.value(MediaKeys::Duration).toInt() == 174);
+
+    // CSV e JSON-lines si reimportano con BatchImporter senza perdite
+    opzioni.parallelo = true;
+    for (const QString &nome : {QString("catalogo.csv"), QString("catalogo.jsonl")}) {
+        const bool riconosciuto = StreamExporter::formatoDaPath(dir.filePath(nome), &opzioni.formato);
+        assert(riconosciuto);
+        Q_UNUSED(riconosciuto);
+        StreamExporter::esportaThrows(biblioteca, tutti, dir.filePath(nome), opzioni);
+        Biblioteca reimportata;
+        const BatchImporter::Report report = BatchImporter::importaThrows(reimportata, dir.filePath(nome), BatchImporter::Opzioni());
+        assert(report.scartati == 0 && reimportata.dimensione() == biblioteca.dimensione());
+        for (int i = 0; i < biblioteca.dimensione(); ++i) {
+            assert(reimportata.getMediaAt(i)->serializza() == biblioteca.getMediaAt(i)->serializza());
+        }
+    }
+
+    // Filtro sui campi non indicizzati, combinato con la query sul tipo
+    MediaFilter::Query soloFilm;
+    soloFilm.tipo = MediaFilter::FilterType::FILMS_ONLY;
+    opzioni.formato = StreamExporter::Formato::Csv;
+    opzioni.filtro = [](const Media &media) {
+        return static_cast<const Film &>(media).getGenre() == "Commedia";
+    };
+    const StreamExporter::Report filtrato = StreamExporter::esportaThrows(biblioteca, biblioteca.eseguiQuery(soloFilm), dir.filePath("filtrato.csv"), opzioni);
+    assert(filtrato.esportati == 1);
+    assert(leggi(dir.filePath("filtrato.csv")) == StreamExporter::intestazioneCsv() + "Film,Commedia,1961,,,,,Monicelli,100,Commedia,,\n");
+    std::cout << "✓ Test Esportazione Streaming passed" << std::endl;
+}
+
+void testAccessoriSenzaCopia() {
+    // I getter *Ref restituiscono il membro stesso: nessuna copia della stringa
+    Book libro("Il Gattopardo", 1958, "Tomasi di Lampedusa", "978-88-07-00000-0", "Feltrinelli", "gattopardo.png");
+    assert(&libro.getTitleRef() == &libro.getTitleRef());
+    assert(libro.getTitleRef() == libro.getTitle());
+    assert(libro.getCoverImagePathRef() == "gattopardo.png");
+    assert(libro.getAuthorRef() == libro.getAuthor() && libro.getIsbnRef() == libro.getIsbn());
+    assert(libro.getPublisherRef() == "Feltrinelli");
+    const Film film("La dolce vita", 1960, "Fellini", 174, "Drammatico");
+    assert(film.getDirectorRef() == "Fellini" && film.getGenreRef() == "Drammatico");
+    const MagazineArticle articolo("Reti neurali", 2019, "Rossi", "Le Scienze", "10.1000/xyz");
+    assert(articolo.getAuthorRef() == "Rossi" && articolo.getMagazineRef() == "Le Scienze" && articolo.getDoiRef() == "10.1000/xyz");
+
+    // Lo schema legge i campi testuali per riferimento
+    const auto &autore = std::get<0>(Schema::MediaSchema<Book>::fields);
+    static_assert(std::is_same<decltype(autore.read(libro)), const QString &>::value, "lettura senza copia");
+    assert(&autore.read(libro) == &libro.getAuthorRef());
+    assert(&Schema::valueWithRole(libro, Schema::IsbnRole) == &libro.getIsbnRef());
+    assert(Schema::valueWithRole(film, Schema::IsbnRole).isEmpty());
+
+    // Un Media differito viene materializzato anche dai getter senza copia
+    Media *differito = Book::createEmpty(libro.getTitle(), libro.getYear());
+    differito->differisci(libro.serializza());
+    assert(differito->campiDifferiti());
+    assert(differito->getTitleRef() == "Il Gattopardo" && differito->campiDifferiti());
+    assert(static_cast<Book *>(differito)->getAuthorRef() == "Tomasi di Lampedusa");
+    assert(!differito->campiDifferiti());
+    delete differito;
+    std::cout << "✓ Test Accessori Senza Copia passed" << std::endl;
+}
+
 int main() {
     std::cout << "Running Model Tests..." << std::endl;
     
@@ -80,6 +1345,30 @@ int main() {
     testMagazineArticleCreation();
     testBibliotecaOperations();
     testSerialization();
+    testRoaringBitmap();
+    testBibliotecaQuery();
+    testQueryPaginata();
+    testDuplicateDetection();
+    testInserimentoBulk();
+    testRisultatiSenzaEccezioni();
+    testMediaTypeRegistry();
+    testMediaSchema();
+    testIstantaneaPerValore();
+    testVisitorGenerici();
+    testTracing();
+    testMetriche();
+    testMemoryFootprint();
+    testScambioBiblioteca();
+    testCaricamentoConAvanzamento();
+    testSalvataggioAsincrono();
+    testJournal();
+    testSnapshotRotation();
+    testCaricamentoDifferito();
+    testCatalogoShard();
+    testCompressione();
+    testImportazioneBatch();
+    testEsportazioneStreaming();
+    testAccessoriSenzaCopia();
     
     std::cout << "All tests passed! ✓" << std::endl;
     return 0;
@@ -0,0 +1,12 @@
+QT = core concurrent
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = test_model
+TEMPLATE = app
+
+include(../model/model.pri)
+
+SOURCES += \
+    test_model.cpp
@@ -56,9 +56,9 @@ void AddMediaDialog::setupUI()
 
     // Stacked widget for type-specific fields
     stackedWidget = new QStackedWidget();
-    createBookForm();
-    createFilmForm();
-    createMagazineArticleForm();
+    addTypeForm(MediaFieldsForm::forType<Book>());
+    addTypeForm(MediaFieldsForm::forType<Film>());
+    addTypeForm(MediaFieldsForm::forType<MagazineArticle>());
     mainLayout->addWidget(stackedWidget);
 
     // Dialog buttons
@@ -71,44 +71,13 @@ void AddMediaDialog::setupUI()
     onMediaTypeChanged(0);
 }
 
-void AddMediaDialog::createBookForm()
+void AddMediaDialog::addTypeForm(const MediaFieldsForm &form)
 {
-    QWidget *bookPage = new QWidget();
-    QFormLayout *formLayout = new QFormLayout(bookPage);
-    bookAuthorEdit = new QLineEdit();
-    bookIsbnEdit = new QLineEdit();
-    bookPublisherEdit = new QLineEdit();
-    formLayout->addRow("Autore:", bookAuthorEdit);
-    formLayout->addRow("ISBN:", bookIsbnEdit);
-    formLayout->addRow("Editore:", bookPublisherEdit);
-    stackedWidget->addWidget(bookPage);
-}
-
-void AddMediaDialog::createFilmForm()
-{
-    QWidget *filmPage = new QWidget();
-    QFormLayout *formLayout = new QFormLayout(filmPage);
-    filmDirectorEdit = new QLineEdit();
-    filmDurationSpinBox = new QSpinBox();
-    filmDurationSpinBox->setRange(1, 1000);
-    filmGenreEdit = new QLineEdit();
-    formLayout->addRow("Regista:", filmDirectorEdit);
-    formLayout->addRow("Durata (min):", filmDurationSpinBox);
-    formLayout->addRow("Genere:", filmGenreEdit);
-    stackedWidget->addWidget(filmPage);
-}
-
-void AddMediaDialog::createMagazineArticleForm()
-{
-    QWidget *articlePage = new QWidget();
-    QFormLayout *formLayout = new QFormLayout(articlePage);
-    articleAuthorEdit = new QLineEdit();
-    articleMagazineEdit = new QLineEdit();
-    articleDoiEdit = new QLineEdit();
-    formLayout->addRow("Autore:", articleAuthorEdit);
-    formLayout->addRow("Rivista:", articleMagazineEdit);
-    formLayout->addRow("DOI:", articleDoiEdit);
-    stackedWidget->addWidget(articlePage);
+    QWidget *page = new QWidget();
+    QFormLayout *formLayout = new QFormLayout(page);
+    typeForms.append(form);
+    typeForms.last().addRows(formLayout);
+    stackedWidget->addWidget(page);
 }
 
 void AddMediaDialog::onMediaTypeChanged(int index)
@@ -141,26 +110,22 @@ void AddMediaDialog::addMediaConfirmed()
         Media *newMedia = nullptr;
         int currentIndex = stackedWidget->currentIndex();
 
+        const MediaFieldsForm &form = typeForms.at(currentIndex);
+
         if (currentIndex == 0)
         { // Book
-            QString author = bookAuthorEdit->text();
-            QString isbn = bookIsbnEdit->text();
-            QString publisher = bookPublisherEdit->text();
-            newMedia = MediaFactory::createBook(title, year, author, isbn, publisher, coverImagePath);
+            newMedia = MediaFactory::createBook(title, year, form.text(MediaKeys::Author), form.text(MediaKeys::Isbn),
+                                                form.text(MediaKeys::Publisher), coverImagePath);
         }
         else if (currentIndex == 1)
         { // Film
-            QString director = filmDirectorEdit->text();
-            int duration = filmDurationSpinBox->value();
-            QString genre = filmGenreEdit->text();
-            newMedia = MediaFactory::createFilm(title, year, director, duration, genre, coverImagePath);
+            newMedia = MediaFactory::createFilm(title, year, form.text(MediaKeys::Director), form.integer(MediaKeys::Duration),
+                                                form.text(MediaKeys::Genre), coverImagePath);
         }
         else if (currentIndex == 2)
         { // MagazineArticle
-            QString author = articleAuthorEdit->text();
-            QString magazine = articleMagazineEdit->text();
-            QString doi = articleDoiEdit->text();
-            newMedia = MediaFactory::createMagazineArticle(title, year, author, magazine, doi, coverImagePath);
+            newMedia = MediaFactory::createMagazineArticle(title, year, form.text(MediaKeys::Author), form.text(MediaKeys::Magazine),
+                                                           form.text(MediaKeys::Doi), coverImagePath);
         }
 
         if (newMedia)
@@ -14,6 +14,7 @@
 #include "../model/Biblioteca.h"
 #include "../model/MediaFactory.h"
 #include "../model/Exceptions.h"
+#include "MediaFieldsForm.h"
 
 class AddMediaDialog : public QDialog
 {
@@ -37,25 +38,11 @@ private:
     QLabel *coverImagePreview;
     QString selectedCoverImagePath;
 
-    // Book fields
-    QLineEdit *bookAuthorEdit;
-    QLineEdit *bookIsbnEdit;
-    QLineEdit *bookPublisherEdit;
-
-    // Film fields
-    QLineEdit *filmDirectorEdit;
-    QSpinBox *filmDurationSpinBox;
-    QLineEdit *filmGenreEdit;
-
-    // Magazine Article fields
-    QLineEdit *articleAuthorEdit;
-    QLineEdit *articleMagazineEdit;
-    QLineEdit *articleDoiEdit;
+    // Type-specific fields, one page per type in combo box order
+    QList<MediaFieldsForm> typeForms;
 
     void setupUI();
-    void createBookForm();
-    void createFilmForm();
-    void createMagazineArticleForm();
+    void addTypeForm(const MediaFieldsForm &form);
 };
 
 #endif // ADDMEDIADIALOG_H
@@ -10,7 +10,8 @@
 #include <QFileInfo>
 
 EditMediaDialog::EditMediaDialog(Biblioteca& biblioteca, Media* mediaToEdit, QWidget *parent)
-    : QDialog(parent), biblioteca(biblioteca), currentMedia(mediaToEdit) {
+    : QDialog(parent), biblioteca(biblioteca), currentMedia(mediaToEdit),
+      specificFields(currentMedia ? Schema::fieldInfosFor(*currentMedia) : QList<Schema::FieldInfo>()) {
     setupUI();
     populateFields();
     setWindowTitle("Modifica Media");
@@ -45,12 +46,10 @@ void EditMediaDialog::setupUI() {
 
     mainLayout->addLayout(commonFormLayout);
 
-    // Stacked widget for type-specific fields
-    stackedWidget = new QStackedWidget();
-    createBookForm();
-    createFilmForm();
-    createMagazineArticleForm();
-    mainLayout->addWidget(stackedWidget);
+    // Type-specific fields, generated from the media schema
+    QFormLayout *specificFormLayout = new QFormLayout();
+    specificFields.addRows(specificFormLayout);
+    mainLayout->addLayout(specificFormLayout);
 
     // Dialog buttons
     QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
@@ -59,43 +58,6 @@ void EditMediaDialog::setupUI() {
     mainLayout->addWidget(buttonBox);
 }
 
-void EditMediaDialog::createBookForm() {
-    QWidget *bookPage = new QWidget();
-    QFormLayout *formLayout = new QFormLayout(bookPage);
-    bookAuthorEdit = new QLineEdit();
-    bookIsbnEdit = new QLineEdit();
-    bookPublisherEdit = new QLineEdit();
-    formLayout->addRow("Autore:", bookAuthorEdit);
-    formLayout->addRow("ISBN:", bookIsbnEdit);
-    formLayout->addRow("Editore:", bookPublisherEdit);
-    stackedWidget->addWidget(bookPage);
-}
-
-void EditMediaDialog::createFilmForm() {
-    QWidget *filmPage = new QWidget();
-    QFormLayout *formLayout = new QFormLayout(filmPage);
-    filmDirectorEdit = new QLineEdit();
-    filmDurationSpinBox = new QSpinBox();
-    filmDurationSpinBox->setRange(1, 1000);
-    filmGenreEdit = new QLineEdit();
-    formLayout->addRow("Regista:", filmDirectorEdit);
-    formLayout->addRow("Durata (min):", filmDurationSpinBox);
-    formLayout->addRow("Genere:", filmGenreEdit);
-    stackedWidget->addWidget(filmPage);
-}
-
-void EditMediaDialog::createMagazineArticleForm() {
-    QWidget *articlePage = new QWidget();
-    QFormLayout *formLayout = new QFormLayout(articlePage);
-    articleAuthorEdit = new QLineEdit();
-    articleMagazineEdit = new QLineEdit();
-    articleDoiEdit = new QLineEdit();
-    formLayout->addRow("Autore:", articleAuthorEdit);
-    formLayout->addRow("Rivista:", articleMagazineEdit);
-    formLayout->addRow("DOI:", articleDoiEdit);
-    stackedWidget->addWidget(articlePage);
-}
-
 void EditMediaDialog::populateFields() {
     if (!currentMedia) return;
 
@@ -108,23 +70,7 @@ void EditMediaDialog::populateFields() {
         coverImagePreview->setPixmap(pixmap.scaled(coverImagePreview->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
     }
 
-    // Determine media type and populate specific fields
-    if (Book* book = dynamic_cast<Book*>(currentMedia)) {
-        stackedWidget->setCurrentIndex(0); // Book is at index 0
-        bookAuthorEdit->setText(book->getAuthor());
-        bookIsbnEdit->setText(book->getIsbn());
-        bookPublisherEdit->setText(book->getPublisher());
-    } else if (Film* film = dynamic_cast<Film*>(currentMedia)) {
-        stackedWidget->setCurrentIndex(1); // Film is at index 1
-        filmDirectorEdit->setText(film->getDirector());
-        filmDurationSpinBox->setValue(film->getDuration());
-        filmGenreEdit->setText(film->getGenre());
-    } else if (MagazineArticle* article = dynamic_cast<MagazineArticle*>(currentMedia)) {
-        stackedWidget->setCurrentIndex(2); // MagazineArticle is at index 2
-        articleAuthorEdit->setText(article->getAuthor());
-        articleMagazineEdit->setText(article->getMagazine());
-        articleDoiEdit->setText(article->getDoi());
-    }
+    specificFields.load(currentMedia);
 }
 
 void EditMediaDialog::selectCoverImage() {
@@ -155,19 +101,7 @@ void EditMediaDialog::editMediaConfirmed() {
     currentMedia->setCoverImagePath(coverImagePath);
 
     // Update type-specific fields
-    if (Book* book = dynamic_cast<Book*>(currentMedia)) {
-        book->setAuthor(bookAuthorEdit->text());
-        book->setIsbn(bookIsbnEdit->text());
-        book->setPublisher(bookPublisherEdit->text());
-    } else if (Film* film = dynamic_cast<Film*>(currentMedia)) {
-        film->setDirector(filmDirectorEdit->text());
-        film->setDuration(filmDurationSpinBox->value());
-        film->setGenre(filmGenreEdit->text());
-    } else if (MagazineArticle* article = dynamic_cast<MagazineArticle*>(currentMedia)) {
-        article->setAuthor(articleAuthorEdit->text());
-        article->setMagazine(articleMagazineEdit->text());
-        article->setDoi(articleDoiEdit->text());
-    }
+    specificFields.store(currentMedia);
 
     QMessageBox::information(this, "Successo", "Media modificato con successo!");
     accept();
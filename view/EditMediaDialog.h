@@ -13,6 +13,7 @@
 #include <QFileDialog>
 #include "../model/Biblioteca.h"
 #include "../model/Media.h"
+#include "MediaFieldsForm.h"
 
 class EditMediaDialog : public QDialog {
     Q_OBJECT
@@ -28,32 +29,16 @@ private slots:
 private:
     Biblioteca& biblioteca;
     Media* currentMedia;
-    QStackedWidget *stackedWidget;
     QLineEdit *titleEdit;
     QSpinBox *yearSpinBox;
     QLineEdit *coverImagePathEdit;
     QLabel *coverImagePreview;
     QString selectedCoverImagePath;
 
-    // Book fields
-    QLineEdit *bookAuthorEdit;
-    QLineEdit *bookIsbnEdit;
-    QLineEdit *bookPublisherEdit;
-
-    // Film fields
-    QLineEdit *filmDirectorEdit;
-    QSpinBox *filmDurationSpinBox;
-    QLineEdit *filmGenreEdit;
-
-    // Magazine Article fields
-    QLineEdit *articleAuthorEdit;
-    QLineEdit *articleMagazineEdit;
-    QLineEdit *articleDoiEdit;
+    // Type-specific fields of the edited media, generated from the schema
+    MediaFieldsForm specificFields;
 
     void setupUI();
-    void createBookForm();
-    void createFilmForm();
-    void createMagazineArticleForm();
     void populateFields();
 };
 
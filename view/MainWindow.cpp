@@ -2,7 +2,13 @@
 #include "../model/Book.h"
 #include "../model/Film.h"
 #include "../model/MagazineArticle.h"
+#include "../model/MediaFactory.h"
+#include "../model/MediaTypeRegistry.h"
 #include "../persistence/JsonSerializer.h"
+#include "../persistence/BlockCompression.h"
+#include "../persistence/BatchImporter.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
 #include <QPixmap>
 #include <QFileInfo>
 #include <QMouseEvent>
@@ -10,10 +16,59 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QTimer>
+#include <QShortcut>
+#include <QApplication>
+#include <QJsonDocument>
+#include <QClipboard>
+#include <QFontDatabase>
+#include <QtConcurrent>
+
+namespace
+{
+    // Scala del dialogo di caricamento: lettura fino a QuotaLettura,
+    // analisi del JSON fino a QuotaParsing, poi deserializzazione dei record
+    constexpr int AvanzamentoMassimo = 1000;
+    constexpr int QuotaLettura = 300;
+    constexpr int QuotaParsing = 500;
+
+    // Group commit del journal: le modifiche ravvicinate condividono un fsync
+    constexpr int IntervalloCommit = 200;
+    // Record dopo i quali il journal viene compattato in un nuovo snapshot
+    constexpr int SogliaCompattazione = 1000;
+    // Autosalvataggio periodico della sessione e copie dello snapshot conservate
+    constexpr int IntervalloAutosalvataggio = 5 * 60 * 1000;
+    constexpr int CopieSessione = 3;
+}
+
+// Stato condiviso tra la GUI e il thread che carica
+struct MainWindow::CaricamentoInCorso
+{
+    QString fileName;
+    std::atomic<bool> annullato{false};
+    Biblioteca risultato;
+    MediaStore istantanea; // copia per valore di risultato, per lo snapshot della sessione
+    std::exception_ptr errore;
+};
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), selectedMedia(nullptr)
+    : MainWindow(sessionFilePath(), parent)
 {
+}
+
+MainWindow::MainWindow(const QString &sessionPath, QWidget *parent)
+    : QMainWindow(parent), selectedMedia(nullptr), salvataggi(new AsyncSaver(this)),
+      sessione(sessionPath, CopieSessione), commitTimer(new QTimer(this)), autosaveTimer(new QTimer(this))
+{
+    connect(salvataggi, &AsyncSaver::salvato, this, &MainWindow::onLibrarySaved);
+    connect(salvataggi, &AsyncSaver::fallito, this, &MainWindow::onLibrarySaveFailed);
+    commitTimer->setSingleShot(true);
+    commitTimer->setInterval(IntervalloCommit);
+    connect(commitTimer, &QTimer::timeout, this, &MainWindow::commitJournal);
+    autosaveTimer->setInterval(IntervalloAutosalvataggio);
+    connect(autosaveTimer, &QTimer::timeout, this, &MainWindow::autosaveSession);
+    autosaveTimer->start();
+    sessione.setCaricamentoDifferito(true);
+    resetPagination();
     setupUI();
     setupMenuBar();
     setupStatusBar();
@@ -23,6 +78,16 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // Il thread di lavoro usa this per accodare l'avanzamento: va fermato prima
+    if (caricamentoWatcher)
+    {
+        caricamento->annullato.store(true);
+        caricamentoWatcher->waitForFinished();
+    }
+
+    // La finestra è già chiusa: si completa l'autosalvataggio senza più dialoghi
+    salvataggi->disconnect(this);
+    salvataggi->attendi();
 }
 
 void MainWindow::setupUI()
@@ -76,8 +141,21 @@ void MainWindow::setupUI()
     scrollArea->setWidgetResizable(true);
     scrollArea->setMinimumHeight(600);
 
+    // Pagination bar
+    QHBoxLayout *paginationLayout = new QHBoxLayout();
+    QPushButton *prevPageBtn = new QPushButton("◀ Precedente");
+    QPushButton *nextPageBtn = new QPushButton("Successiva ▶");
+    QLabel *pageLabel = new QLabel();
+
+    paginationLayout->addStretch();
+    paginationLayout->addWidget(prevPageBtn);
+    paginationLayout->addWidget(pageLabel);
+    paginationLayout->addWidget(nextPageBtn);
+    paginationLayout->addStretch();
+
     mainLayout->addLayout(toolbarLayout);
     mainLayout->addWidget(scrollArea);
+    mainLayout->addLayout(paginationLayout);
 
     // Store references for later use
     this->mediaTypeFilter = mediaTypeFilter;
@@ -85,6 +163,9 @@ void MainWindow::setupUI()
     this->gridLayout = gridLayout;
     this->contentWidget = contentWidget;
     this->scrollArea = scrollArea;
+    this->prevPageBtn = prevPageBtn;
+    this->nextPageBtn = nextPageBtn;
+    this->pageLabel = pageLabel;
 
     // Connect signals
     connect(mediaTypeFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onFilterChanged);
@@ -94,6 +175,8 @@ void MainWindow::setupUI()
     connect(editBtn, &QPushButton::clicked, this, &MainWindow::editMedia);
     connect(deleteBtn, &QPushButton::clicked, this, &MainWindow::deleteMedia);
     connect(detailsBtn, &QPushButton::clicked, this, &MainWindow::showMediaDetails);
+    connect(prevPageBtn, &QPushButton::clicked, this, &MainWindow::previousPage);
+    connect(nextPageBtn, &QPushButton::clicked, this, &MainWindow::nextPage);
 
     setWindowTitle("Biblioteca Virtuale");
     resize(1200, 800);
@@ -106,6 +189,7 @@ void MainWindow::setupMenuBar()
     QMenu *fileMenu = menuBar->addMenu("&File");
     fileMenu->addAction("&Carica Biblioteca", this, &MainWindow::loadLibrary, QKeySequence::Open);
     fileMenu->addAction("&Salva Biblioteca", this, &MainWindow::saveLibrary, QKeySequence::Save);
+    fileMenu->addAction("&Importa Biblioteca...", this, &MainWindow::importLibrary);
     fileMenu->addSeparator();
     fileMenu->addAction("&Esci", this, &QWidget::close, QKeySequence::Quit);
 
@@ -115,6 +199,10 @@ void MainWindow::setupMenuBar()
     mediaMenu->addAction("&Elimina", this, &MainWindow::deleteMedia, QKeySequence::Delete);
     mediaMenu->addSeparator();
     mediaMenu->addAction("&Cerca", this, &MainWindow::searchMedia, QKeySequence::Find);
+
+    // Pannello diagnostico nascosto: nessuna voce di menu, solo la scorciatoia
+    QShortcut *diagnostics = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(diagnostics, &QShortcut::activated, this, &MainWindow::showDiagnostics);
 }
 
 void MainWindow::setupStatusBar()
@@ -124,10 +212,24 @@ void MainWindow::setupStatusBar()
 
 void MainWindow::updateMediaDisplay()
 {
+    BIBLIO_TRACE_SCOPE("vista", "MainWindow::updateMediaDisplay");
+    // Query e ricostruzione della griglia: la latenza percepita di filtri e ricerche
+    static Metrics::Histogram &latenzaVista = Metrics::histogram("vista.aggiornamento_us");
+    Metrics::ScopedLatency latenza(latenzaVista);
     clearMediaDisplay();
 
-    QList<Media *> mediaToDisplay = getFilteredMedia();
-    populateDisplayWithMedia(mediaToDisplay);
+    paginaCorrente = getFilteredMedia();
+
+    // Dopo un'eliminazione la pagina corrente può essere rimasta vuota
+    while (paginaCorrente.items.isEmpty() && cursoriPagine.size() > 1)
+    {
+        cursoriPagine.removeLast();
+        paginaCorrente = getFilteredMedia();
+    }
+
+    populateDisplayWithMedia(paginaCorrente.items);
+    updatePaginationControls();
+    Metrics::gauge("vista.widget_griglia").set(gridLayout->count());
 }
 
 void MainWindow::clearMediaDisplay()
@@ -135,50 +237,90 @@ void MainWindow::clearMediaDisplay()
     clearLayout(gridLayout);
 }
 
-QList<Media *> MainWindow::getFilteredMedia() const
+MediaFilter::Query MainWindow::getCurrentQuery() const
 {
     QString currentFilter = mediaTypeFilter->currentData().toString();
-    QString searchTerm = searchEdit->text().trimmed();
 
-    QList<Media *> allMedia;
+    MediaFilter::Query query;
+    query.titolo = searchEdit->text().trimmed();
 
-    // Get all media based on type filter using Visitor pattern
-    if (currentFilter == "all")
-    {
-        allMedia = biblioteca.getTuttiMedia();
-    }
-    else if (currentFilter == "book")
+    // Il filtro per tipo usa le partizioni costruite dal Visitor
+    if (currentFilter == "book")
     {
-        allMedia = biblioteca.collectMediaByType(MediaFilter::FilterType::BOOKS_ONLY);
+        query.tipo = MediaFilter::FilterType::BOOKS_ONLY;
     }
     else if (currentFilter == "film")
     {
-        allMedia = biblioteca.collectMediaByType(MediaFilter::FilterType::FILMS_ONLY);
+        query.tipo = MediaFilter::FilterType::FILMS_ONLY;
     }
     else if (currentFilter == "article")
     {
-        allMedia = biblioteca.collectMediaByType(MediaFilter::FilterType::ARTICLES_ONLY);
+        query.tipo = MediaFilter::FilterType::ARTICLES_ONLY;
     }
 
-    // Apply search filter if present
-    if (!searchTerm.isEmpty())
+    return query;
+}
+
+MediaFilter::Page MainWindow::getFilteredMedia() const
+{
+    // Tipo e ricerca vengono combinati sulle bitmap; si materializza solo la pagina visibile
+    return biblioteca.eseguiQueryDaCursore(getCurrentQuery(), cursoriPagine.last(), MediaPerPagina);
+}
+
+void MainWindow::resetPagination()
+{
+    cursoriPagine.clear();
+    cursoriPagine.append(0);
+}
+
+void MainWindow::updatePaginationControls()
+{
+    const int pagina = cursoriPagine.size();
+    QString totale = paginaCorrente.totaleEsatto
+                         ? QString::number(paginaCorrente.totaleStimato)
+                         : QString("~%1").arg(paginaCorrente.totaleStimato);
+
+    if (paginaCorrente.totaleEsatto)
     {
-        QList<Media *> searchResults;
-        for (Media *media : allMedia)
-        {
-            if (media->getTitle().contains(searchTerm, Qt::CaseInsensitive))
-            {
-                searchResults.append(media);
-            }
-        }
-        return searchResults;
+        const int pagineTotali = qMax(1, (paginaCorrente.totaleStimato + MediaPerPagina - 1) / MediaPerPagina);
+        pageLabel->setText(QString("Pagina %1 di %2 (%3 risultati)").arg(pagina).arg(pagineTotali).arg(totale));
+    }
+    else
+    {
+        pageLabel->setText(QString("Pagina %1 (%2 risultati)").arg(pagina).arg(totale));
+    }
+
+    prevPageBtn->setEnabled(pagina > 1);
+    nextPageBtn->setEnabled(paginaCorrente.altriRisultati);
+}
+
+void MainWindow::nextPage()
+{
+    if (!paginaCorrente.altriRisultati)
+    {
+        return;
     }
+    cursoriPagine.append(paginaCorrente.cursore);
+    selectedMedia = nullptr;
+    updateMediaDisplay();
+    scrollArea->ensureVisible(0, 0);
+}
 
-    return allMedia;
+void MainWindow::previousPage()
+{
+    if (cursoriPagine.size() <= 1)
+    {
+        return;
+    }
+    cursoriPagine.removeLast();
+    selectedMedia = nullptr;
+    updateMediaDisplay();
+    scrollArea->ensureVisible(0, 0);
 }
 
 void MainWindow::populateDisplayWithMedia(const QList<Media *> &mediaList)
 {
+    BIBLIO_TRACE_SCOPE("vista", "MainWindow::populateDisplayWithMedia");
     int columns = 4; // Media per riga
     int currentRow = gridLayout->rowCount();
     int currentCol = 0;
@@ -214,6 +356,7 @@ void MainWindow::addMediaWidgetToGrid(Media *media, int row, int col)
 }
 void MainWindow::clearLayout(QLayout *layout)
 {
+    BIBLIO_TRACE_SCOPE("vista", "MainWindow::clearLayout");
     if (!layout)
         return;
 
@@ -239,6 +382,7 @@ void MainWindow::clearLayout(QLayout *layout)
 
 void MainWindow::onFilterChanged()
 {
+    resetPagination();
     updateMediaDisplay();
     selectedMedia = nullptr; // Clear selection when filter changes
 }
@@ -271,21 +415,24 @@ void MainWindow::addMedia()
         return;
     }
 
-    // Crea il media temporaneo per il visitor
-    Media *tempMedia = nullptr;
+    // Tag del registro dei tipi corrispondente alla voce scelta
+    QString tag;
     if (selectedType == "Libro")
     {
-        tempMedia = new Book("", 2024, "", "", "", "");
+        tag = "Book";
     }
     else if (selectedType == "Film")
     {
-        tempMedia = new Film("", 2024, "", 0, "", "");
+        tag = "Film";
     }
     else if (selectedType == "Articolo di Rivista")
     {
-        tempMedia = new MagazineArticle("", 2024, "", "", "", "");
+        tag = "MagazineArticle";
     }
 
+    // Crea il media temporaneo per il visitor
+    Media *tempMedia = MediaTypeRegistry::instance().createEmpty(tag, "", 2024);
+
     if (!tempMedia)
     {
         return;
@@ -320,35 +467,24 @@ void MainWindow::addMedia()
 
     if (dialog.exec() == QDialog::Accepted)
     {
-        // Crea il nuovo media con i dati inseriti
+        // Crea il nuovo media con i dati inseriti: i campi del form sono generati dallo schema
         MediaWidgetVisitor *editVisitor = static_cast<MediaWidgetVisitor *>(visitor);
 
-        Media *newMedia = nullptr;
-        if (selectedType == "Libro")
-        {
-            newMedia = new Book(editVisitor->getTitle(), editVisitor->getYear(),
-                                editVisitor->getAuthor(), editVisitor->getIsbn(),
-                                editVisitor->getPublisher(), editVisitor->getCoverImagePath());
-        }
-        else if (selectedType == "Film")
-        {
-            newMedia = new Film(editVisitor->getTitle(), editVisitor->getYear(),
-                                editVisitor->getDirector(), editVisitor->getDuration(),
-                                editVisitor->getGenre(), editVisitor->getCoverImagePath());
-        }
-        else if (selectedType == "Articolo di Rivista")
+        try
         {
-            newMedia = new MagazineArticle(editVisitor->getTitle(), editVisitor->getYear(),
-                                           editVisitor->getArticleAuthor(), editVisitor->getMagazine(),
-                                           editVisitor->getDoi(), editVisitor->getCoverImagePath());
-        }
+            Media *newMedia = MediaFactory::createMedia(tag, editVisitor->getTitle(), editVisitor->getYear());
+            editVisitor->store(newMedia);
 
-        if (newMedia)
-        {
             biblioteca.aggiungiMedia(newMedia);
+            sessione.registraAggiunta(*newMedia);
+            scheduleJournalCommit();
             updateMediaDisplay();
             statusBar()->showMessage("Media aggiunto con successo", 2000);
         }
+        catch (const InvalidDataException &e)
+        {
+            QMessageBox::warning(this, "Dati non validi", QString::fromStdString(e.what()));
+        }
     }
 
     // Cleanup
@@ -409,31 +545,12 @@ void MainWindow::editMedia()
 
     if (dialog.exec() == QDialog::Accepted)
     {
-        // Aggiorna il media esistente
-        selectedMedia->setTitle(editVisitor->getTitle());
-        selectedMedia->setYear(editVisitor->getYear());
-        selectedMedia->setCoverImagePath(editVisitor->getCoverImagePath());
-
-        // Aggiorna i campi specifici del tipo
-        if (Book *book = dynamic_cast<Book *>(selectedMedia))
-        {
-            book->setAuthor(editVisitor->getAuthor());
-            book->setIsbn(editVisitor->getIsbn());
-            book->setPublisher(editVisitor->getPublisher());
-        }
-        else if (Film *film = dynamic_cast<Film *>(selectedMedia))
-        {
-            film->setDirector(editVisitor->getDirector());
-            film->setDuration(editVisitor->getDuration());
-            film->setGenre(editVisitor->getGenre());
-        }
-        else if (MagazineArticle *article = dynamic_cast<MagazineArticle *>(selectedMedia))
-        {
-            article->setAuthor(editVisitor->getArticleAuthor());
-            article->setMagazine(editVisitor->getMagazine());
-            article->setDoi(editVisitor->getDoi());
-        }
+        // Aggiorna il media esistente: campi comuni e campi specifici dello schema
+        editVisitor->store(selectedMedia);
 
+        biblioteca.notificaModifica(selectedMedia);
+        sessione.registraModifica(biblioteca.indiceDi(selectedMedia), *selectedMedia);
+        scheduleJournalCommit();
         updateMediaDisplay();
         statusBar()->showMessage("Media modificato con successo", 2000);
     }
@@ -468,7 +585,12 @@ void MainWindow::deleteMedia()
 
     if (ret == QMessageBox::Yes)
     {
-        biblioteca.rimuoviMedia(selectedMedia);
+        const int indice = biblioteca.indiceDi(selectedMedia);
+        if (biblioteca.rimuoviMedia(selectedMedia))
+        {
+            sessione.registraRimozione(indice);
+            scheduleJournalCommit();
+        }
         selectedMedia = nullptr;
         updateMediaDisplay();
         statusBar()->showMessage("Media eliminato con successo", 2000);
@@ -477,13 +599,16 @@ void MainWindow::deleteMedia()
 
 void MainWindow::searchMedia()
 {
+    resetPagination();
     updateMediaDisplay(); // Il filtro di ricerca è già gestito in getFilteredMedia()
 
     QString searchTerm = searchEdit->text().trimmed();
     if (!searchTerm.isEmpty())
     {
-        QList<Media *> results = getFilteredMedia();
-        statusBar()->showMessage(QString("Trovati %1 risultati per \"%2\"").arg(results.size()).arg(searchTerm), 3000);
+        QString totale = paginaCorrente.totaleEsatto
+                             ? QString::number(paginaCorrente.totaleStimato)
+                             : QString("circa %1").arg(paginaCorrente.totaleStimato);
+        statusBar()->showMessage(QString("Trovati %1 risultati per \"%2\"").arg(totale).arg(searchTerm), 3000);
     }
     else
     {
@@ -497,31 +622,65 @@ void MainWindow::saveLibrary()
     QString defaultDir = QCoreApplication::applicationDirPath() + "/data/bibliotecas";
     QDir().mkpath(defaultDir); // Crea la cartella se non esiste
 
+    const QString filtroCompresso = "JSON compresso (*.json.bvz)";
+    QString filtroScelto;
     QString fileName = QFileDialog::getSaveFileName(this,
                                                     "Salva Biblioteca",
                                                     defaultDir + "/biblioteca.json",
-                                                    "JSON Files (*.json);;All Files (*)");
+                                                    "JSON Files (*.json);;" + filtroCompresso + ";;"
+                                                    "Catalogo a shard (*.manifest.json);;All Files (*)",
+                                                    &filtroScelto);
     if (!fileName.isEmpty())
     {
         // Assicurati che il file abbia l'estensione .json
+        // (con .manifest.json AsyncSaver scrive un catalogo a shard, vedi ShardedCatalog;
+        // con .bvz un file compresso a blocchi, vedi BlockCompression)
+        const bool compresso = BlockCompression::isCompressoPath(fileName) || filtroScelto == filtroCompresso;
+        if (fileName.endsWith(BlockCompression::Estensione, Qt::CaseInsensitive))
+        {
+            fileName.chop(BlockCompression::Estensione.size());
+        }
         if (!fileName.endsWith(".json", Qt::CaseInsensitive))
         {
             fileName += ".json";
         }
-
-        JsonSerializer serializer;
-        if (serializer.salvaBiblioteca(biblioteca, fileName))
+        if (compresso)
         {
-            statusBar()->showMessage(QString("Biblioteca salvata: %1").arg(QFileInfo(fileName).fileName()), 3000);
-            QMessageBox::information(this, "Salvataggio Completato",
-                                     QString("La biblioteca è stata salvata con successo in:\n%1").arg(fileName));
+            fileName += BlockCompression::Estensione;
         }
-        else
+
+        salvataggioManuale = fileName;
+        salvataggi->salva(biblioteca, fileName);
+        statusBar()->showMessage(QString("Salvataggio in corso: %1").arg(QFileInfo(fileName).fileName()));
+    }
+}
+
+void MainWindow::onLibrarySaved(const QString &fileName, int elementi, qint64 generazioneJournal)
+{
+    if (fileName != salvataggioManuale)
+    {
+        if (fileName == sessione.snapshotPath() && generazioneJournal >= 0)
         {
-            QMessageBox::critical(this, "Errore di Salvataggio",
-                                  "Impossibile salvare la biblioteca.\nVerifica i permessi di scrittura del file.");
+            sessione.snapshotCompletato(generazioneJournal);
         }
+        statusBar()->showMessage("Sessione salvata automaticamente", 1000);
+        return;
+    }
+    salvataggioManuale.clear();
+    statusBar()->showMessage(QString("Biblioteca salvata: %1 (%2 media)").arg(QFileInfo(fileName).fileName()).arg(elementi), 3000);
+    QMessageBox::information(this, "Salvataggio Completato",
+                             QString("La biblioteca è stata salvata con successo in:\n%1").arg(fileName));
+}
+
+void MainWindow::onLibrarySaveFailed(const QString &fileName, const QString &messaggio)
+{
+    if (fileName == salvataggioManuale)
+    {
+        salvataggioManuale.clear();
     }
+    statusBar()->clearMessage();
+    QMessageBox::critical(this, "Errore di Salvataggio",
+                          QString("Impossibile salvare la biblioteca.\nVerifica i permessi di scrittura del file.\n\n%1").arg(messaggio));
 }
 
 void MainWindow::loadLibrary()
@@ -533,7 +692,8 @@ void MainWindow::loadLibrary()
     QString fileName = QFileDialog::getOpenFileName(this,
                                                     "Carica Biblioteca",
                                                     defaultDir,
-                                                    "JSON Files (*.json);;All Files (*)");
+                                                    "JSON Files (*.json *.json.bvz);;"
+                                                    "Catalogo a shard (*.manifest.json);;All Files (*)");
     if (!fileName.isEmpty())
     {
         // Conferma se la biblioteca attuale ha dei media
@@ -553,59 +713,456 @@ void MainWindow::loadLibrary()
             }
         }
 
-        try
-        {
-            JsonSerializer serializer;
-            Biblioteca loadedLibrary;
+        startLibraryLoad(fileName);
+    }
+}
 
-            // Usa la versione con eccezioni per un controllo migliore
-            serializer.caricaBibliotecaThrows(loadedLibrary, fileName);
+/**
+ * Sostituisce la biblioteca con il contenuto del file, in modo sincrono
+ * (usato dai benchmark), istantanea per la sessione compresa. In caso di
+ * errore lancia l'eccezione del serializer e la biblioteca attuale resta invariata.
+ */
+void MainWindow::loadLibraryFromFile(const QString &fileName)
+{
+    BIBLIO_TRACE_SCOPE("vista", "MainWindow::loadLibraryFromFile");
+    Biblioteca loadedLibrary;
+    JsonSerializer::Avanzamento opzioni;
+    opzioni.campiDifferiti = true;
+    JsonSerializer::caricaBibliotecaThrows(loadedLibrary, fileName, opzioni);
+    MediaStore istantanea = loadedLibrary.istantanea();
+    installLibrary(loadedLibrary, std::move(istantanea));
+}
 
-            // Prima pulisci tutto completamente
-            selectedMedia = nullptr;
-            clearMediaDisplay();
+/**
+ * Scambia la biblioteca con quella appena caricata e ricostruisce la vista.
+ * Lo scambio non copia i Media: nuova riceve il contenuto precedente.
+ * istantanea è la copia per valore di nuova, presa da chi l'ha caricata:
+ * diventa lo snapshot della sessione senza ripercorrere i Media qui.
+ */
+void MainWindow::installLibrary(Biblioteca &nuova, MediaStore istantanea)
+{
+    selectedMedia = nullptr;
+    resetPagination();
+    clearMediaDisplay(); // i widget non devono più riferirsi ai Media sostituiti
+    biblioteca.swap(nuova);
+    compactSession(std::move(istantanea)); // il journal registra modifiche, non sostituzioni dell'intera biblioteca
+    updateMediaDisplay();
+}
 
-            // Forza l'elaborazione degli eventi per assicurarsi che i widget siano completamente distrutti
-            QCoreApplication::processEvents();
+QString MainWindow::sessionFilePath()
+{
+    return QCoreApplication::applicationDirPath() + "/data/bibliotecas/ultima_sessione.json";
+}
 
-            // Ora carica la nuova biblioteca
-            biblioteca = loadedLibrary;
+void MainWindow::scheduleJournalCommit()
+{
+    // Non riavviato a ogni modifica: il ritardo massimo resta IntervalloCommit
+    if (!commitTimer->isActive())
+    {
+        commitTimer->start();
+    }
+}
 
-            // Attendi un momento prima di aggiornare il display
-            QTimer::singleShot(100, this, [this]()
-                               { updateMediaDisplay(); });
+/**
+ * Conferma su disco le modifiche registrate dall'ultimo commit (pochi byte,
+ * indipendentemente dalla dimensione della biblioteca) e, superata la
+ * soglia, avvia la compattazione.
+ */
+void MainWindow::commitJournal()
+{
+    commitTimer->stop();
+    try
+    {
+        sessione.commit();
+    }
+    catch (const BibliotecaException &e)
+    {
+        statusBar()->showMessage(QString("Journal non salvato: %1").arg(e.what()), 5000);
+        return;
+    }
+    if (sessione.recordGenerazione() >= SogliaCompattazione)
+    {
+        compactSession();
+    }
+}
 
-            statusBar()->showMessage(QString("Biblioteca caricata: %1 elementi").arg(biblioteca.dimensione()), 3000);
-            QMessageBox::information(this, "Caricamento Completato",
-                                     QString("La biblioteca è stata caricata con successo!\n"
-                                             "Elementi caricati: %1\n"
-                                             "File: %2")
-                                         .arg(biblioteca.dimensione())
-                                         .arg(QFileInfo(fileName).fileName()));
-        }
-        catch (const FileNotFoundException &e)
-        {
-            QMessageBox::critical(this, "File non trovato",
-                                  QString("Il file selezionato non può essere aperto:\n%1")
-                                      .arg(QString::fromStdString(e.what())));
-        }
-        catch (const JsonParseException &e)
-        {
-            QMessageBox::critical(this, "Errore nel formato del file",
-                                  QString("Il file JSON non è valido o è corrotto:\n%1")
-                                      .arg(QString::fromStdString(e.what())));
-        }
-        catch (const BibliotecaException &e)
+/**
+ * Autosalvataggio periodico: solo se dall'ultimo snapshot ci sono state
+ * modifiche e nessun salvataggio è in corso. Le modifiche sono già nel
+ * journal; lo snapshot accorcia il ripristino e aggiunge una copia verificata.
+ */
+void MainWindow::autosaveSession()
+{
+    if (salvataggi->occupato())
+    {
+        return;
+    }
+    commitJournal();
+    if (sessione.recordGenerazione() > 0)
+    {
+        compactSession();
+    }
+}
+
+/**
+ * Nuovo snapshot della sessione scritto in background. Le modifiche
+ * successive vanno nella nuova generazione del journal; le precedenti
+ * vengono eliminate in onLibrarySaved() quando lo snapshot è su disco.
+ */
+void MainWindow::compactSession()
+{
+    compactSession(biblioteca.istantanea());
+}
+
+void MainWindow::compactSession(MediaStore istantanea)
+{
+    QDir().mkpath(QFileInfo(sessione.snapshotPath()).path());
+    try
+    {
+        salvataggi->salva(std::move(istantanea), sessione.snapshotPath(), sessione.nuovaGenerazione(),
+                          sessione.copieSnapshot());
+    }
+    catch (const BibliotecaException &e)
+    {
+        statusBar()->showMessage(QString("Sessione non salvata: %1").arg(e.what()), 5000);
+    }
+}
+
+/**
+ * Avvia il caricamento in un thread del pool globale.
+ * La finestra resta reattiva: il dialogo di avanzamento mostra byte letti e
+ * record deserializzati e permette di annullare; i primi record compaiono
+ * nella griglia come anteprima appena disponibili. Al termine la biblioteca
+ * caricata viene scambiata con quella corrente in onLibraryLoadFinished().
+ */
+void MainWindow::startLibraryLoad(const QString &fileName)
+{
+    if (caricamento)
+    {
+        return; // un caricamento alla volta
+    }
+
+    std::shared_ptr<CaricamentoInCorso> stato = std::make_shared<CaricamentoInCorso>();
+    stato->fileName = fileName;
+    caricamento = stato;
+
+    caricamentoDialog = new QProgressDialog("Lettura del file...", "Annulla", 0, AvanzamentoMassimo, this);
+    caricamentoDialog->setWindowTitle("Caricamento Biblioteca");
+    caricamentoDialog->setWindowModality(Qt::WindowModal);
+    caricamentoDialog->setMinimumDuration(300);
+    caricamentoDialog->setAutoClose(false);
+    caricamentoDialog->setAutoReset(false);
+    caricamentoDialog->setValue(0);
+    connect(caricamentoDialog, &QProgressDialog::canceled, this, [stato]()
+            { stato->annullato.store(true); });
+
+    // Le funzioni di avanzamento girano nel thread di lavoro: gli aggiornamenti
+    // sono accodati al thread della GUI. Il distruttore attende la fine del
+    // lavoro, quindi this è sempre valido quando vengono invocate.
+    JsonSerializer::Avanzamento avanzamento;
+    avanzamento.annullato = &stato->annullato;
+    avanzamento.dimensioneAnteprima = MediaPerPagina;
+    avanzamento.campiDifferiti = true; // la griglia materializza solo i Media visualizzati
+    avanzamento.lettura = [this](qint64 letti, qint64 totali)
+    {
+        QMetaObject::invokeMethod(this, [this, letti, totali]()
+                                  { showLoadProgress(QString("Lettura: %1 di %2 MB")
+                                                         .arg(letti / 1048576.0, 0, 'f', 1)
+                                                         .arg(totali / 1048576.0, 0, 'f', 1),
+                                                     int(QuotaLettura * letti / qMax(qint64(1), totali))); },
+                                  Qt::QueuedConnection);
+    };
+    avanzamento.record = [this](int record, int totali)
+    {
+        QMetaObject::invokeMethod(this, [this, record, totali]()
+                                  { showLoadProgress(QString("Record: %1 di %2").arg(record).arg(totali),
+                                                     QuotaParsing + int(qint64(AvanzamentoMassimo - QuotaParsing) * record / qMax(1, totali))); },
+                                  Qt::QueuedConnection);
+    };
+    avanzamento.anteprima = [this](const QList<Media *> &primi)
+    {
+        QMetaObject::invokeMethod(this, [this, primi]()
+                                  { showLoadPreview(primi); },
+                                  Qt::QueuedConnection);
+    };
+
+    caricamentoWatcher = new QFutureWatcher<void>(this);
+    connect(caricamentoWatcher, &QFutureWatcher<void>::finished, this, &MainWindow::onLibraryLoadFinished);
+    caricamentoWatcher->setFuture(QtConcurrent::run([stato, avanzamento]()
+                                                    {
+                                                        try
+                                                        {
+                                                            JsonSerializer::caricaBibliotecaThrows(stato->risultato, stato->fileName, avanzamento);
+                                                            // Copia per lo snapshot della sessione, qui e non nel thread della GUI
+                                                            stato->istantanea = stato->risultato.istantanea();
+                                                        }
+                                                        catch (...)
+                                                        {
+                                                            stato->errore = std::current_exception();
+                                                        }
+                                                    }));
+}
+
+void MainWindow::showLoadProgress(const QString &testo, int valore)
+{
+    if (!caricamentoDialog || caricamentoDialog->wasCanceled())
+    {
+        return;
+    }
+    if (valore == QuotaLettura)
+    {
+        // Dopo l'ultimo blocco letto il JSON viene analizzato in un solo passo
+        caricamentoDialog->setLabelText("Analisi del JSON...");
+        caricamentoDialog->setValue(QuotaParsing);
+        return;
+    }
+    caricamentoDialog->setLabelText(testo);
+    caricamentoDialog->setValue(valore);
+}
+
+/**
+ * Mostra nella griglia i primi record del file mentre il caricamento prosegue.
+ * I Media dell'anteprima sono copie: la biblioteca corrente non viene toccata
+ * finché il caricamento non termina.
+ */
+void MainWindow::showLoadPreview(const QList<Media *> &primi)
+{
+    if (!caricamento || caricamento->annullato.load())
+    {
+        qDeleteAll(primi);
+        return;
+    }
+    selectedMedia = nullptr;
+    clearMediaDisplay();
+    anteprima.svuota();
+    anteprima.aggiungiMediaBulk(primi);
+    populateDisplayWithMedia(anteprima.getTuttiMedia());
+    pageLabel->setText(QString("Anteprima: primi %1 elementi, caricamento in corso...").arg(anteprima.dimensione()));
+    prevPageBtn->setEnabled(false);
+    nextPageBtn->setEnabled(false);
+}
+
+void MainWindow::onLibraryLoadFinished()
+{
+    std::shared_ptr<CaricamentoInCorso> stato = std::move(caricamento);
+    caricamentoWatcher->deleteLater();
+    caricamentoWatcher = nullptr;
+    caricamentoDialog->close();
+    caricamentoDialog->deleteLater();
+    caricamentoDialog = nullptr;
+
+    clearMediaDisplay();
+    anteprima.svuota();
+
+    if (!stato->errore)
+    {
+        installLibrary(stato->risultato, std::move(stato->istantanea)); // la biblioteca precedente viene liberata con stato
+        statusBar()->showMessage(QString("Biblioteca caricata: %1 elementi").arg(biblioteca.dimensione()), 3000);
+        QMessageBox::information(this, "Caricamento Completato",
+                                 QString("La biblioteca è stata caricata con successo!\n"
+                                         "Elementi caricati: %1\n"
+                                         "File: %2")
+                                     .arg(biblioteca.dimensione())
+                                     .arg(QFileInfo(stato->fileName).fileName()));
+        return;
+    }
+
+    // Errore o annullamento: si torna alla biblioteca corrente, invariata
+    updateMediaDisplay();
+    try
+    {
+        std::rethrow_exception(stato->errore);
+    }
+    catch (const OperazioneAnnullataException &)
+    {
+        statusBar()->showMessage("Caricamento annullato", 3000);
+    }
+    catch (const FileNotFoundException &e)
+    {
+        QMessageBox::critical(this, "File non trovato",
+                              QString("Il file selezionato non può essere aperto:\n%1")
+                                  .arg(QString::fromStdString(e.what())));
+    }
+    catch (const JsonParseException &e)
+    {
+        QMessageBox::critical(this, "Errore nel formato del file",
+                              QString("Il file JSON non è valido o è corrotto:\n%1")
+                                  .arg(QString::fromStdString(e.what())));
+    }
+    catch (const BibliotecaException &e)
+    {
+        QMessageBox::critical(this, "Errore di caricamento",
+                              QString("Si è verificato un errore durante il caricamento:\n%1")
+                                  .arg(QString::fromStdString(e.what())));
+    }
+    catch (...)
+    {
+        QMessageBox::critical(this, "Errore imprevisto",
+                              "Si è verificato un errore imprevisto durante il caricamento della biblioteca.");
+    }
+}
+
+/**
+ * Raccoglie le metriche del registro dopo aver aggiornato gli indicatori calcolati
+ * su richiesta: composizione della biblioteca, widget esistenti e percentuale di
+ * successo della cache delle copertine.
+ */
+QJsonObject MainWindow::metricsSnapshot() const
+{
+    biblioteca.aggiornaMetriche();
+    Metrics::gauge("vista.widget_totali").set(QApplication::allWidgets().size());
+
+    const qint64 hit = Metrics::counter("copertine.cache_hit").value();
+    const qint64 miss = Metrics::counter("copertine.cache_miss").value();
+    Metrics::gauge("copertine.percentuale_hit").set(hit + miss > 0 ? hit * 100 / (hit + miss) : 0);
+
+    return Metrics::Registry::instance().snapshot();
+}
+
+/**
+ * Pannello diagnostico (Ctrl+Shift+D): metriche correnti in forma testuale,
+ * con aggiornamento, azzeramento, copia in JSON e salvataggio della traccia
+ * quando il tracing è attivo.
+ */
+void MainWindow::showDiagnostics()
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle("Diagnostica");
+    dialog.resize(640, 480);
+
+    QVBoxLayout *dialogLayout = new QVBoxLayout(&dialog);
+    QTextEdit *report = new QTextEdit();
+    report->setReadOnly(true);
+    report->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    dialogLayout->addWidget(report);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    QPushButton *refreshBtn = new QPushButton("Aggiorna");
+    QPushButton *resetBtn = new QPushButton("Azzera");
+    QPushButton *copyBtn = new QPushButton("Copia JSON");
+    QPushButton *traceBtn = new QPushButton("Salva traccia...");
+    QPushButton *closeBtn = new QPushButton("Chiudi");
+    traceBtn->setEnabled(Tracing::isEnabled());
+
+    buttonLayout->addWidget(refreshBtn);
+    buttonLayout->addWidget(resetBtn);
+    buttonLayout->addWidget(copyBtn);
+    buttonLayout->addWidget(traceBtn);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeBtn);
+    dialogLayout->addLayout(buttonLayout);
+
+    auto refresh = [this, report]()
+    { report->setPlainText(Metrics::formatSnapshot(metricsSnapshot())); };
+
+    connect(refreshBtn, &QPushButton::clicked, &dialog, refresh);
+    connect(resetBtn, &QPushButton::clicked, &dialog, [refresh]()
+            {
+                Metrics::Registry::instance().reset();
+                refresh();
+            });
+    connect(copyBtn, &QPushButton::clicked, &dialog, [this]()
+            { QApplication::clipboard()->setText(QString::fromUtf8(QJsonDocument(metricsSnapshot()).toJson())); });
+    connect(traceBtn, &QPushButton::clicked, &dialog, [&dialog]()
+            {
+                const QString fileName = QFileDialog::getSaveFileName(&dialog, "Salva traccia", "traccia.json",
+                                                                      "JSON Files (*.json)");
+                if (!fileName.isEmpty() && !Tracing::writeChromeTrace(fileName))
+                {
+                    QMessageBox::critical(&dialog, "Errore", "Impossibile scrivere la traccia.");
+                }
+            });
+    connect(closeBtn, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    refresh();
+    dialog.exec();
+}
+
+void MainWindow::importLibrary()
+{
+    QString defaultDir = QCoreApplication::applicationDirPath() + "/data/bibliotecas";
+    QDir().mkpath(defaultDir);
+
+    QString fileName = QFileDialog::getOpenFileName(this,
+                                                    "Importa Biblioteca",
+                                                    defaultDir,
+                                                    "JSON Files (*.json *.json.bvz);;"
+                                                    "CSV, JSON-lines, MARC (*.csv *.jsonl *.ndjson *.mrk);;All Files (*)");
+    if (fileName.isEmpty())
+    {
+        return;
+    }
+
+    QStringList politiche;
+    politiche << "Scarta i duplicati" << "Unisci i duplicati" << "Importa e segnala i duplicati";
+
+    bool ok;
+    QString scelta = QInputDialog::getItem(this, "Importa Biblioteca",
+                                           "Come gestire i media già presenti?",
+                                           politiche, 0, false, &ok);
+    if (!ok)
+    {
+        return;
+    }
+
+    Deduplicazione::Politica politica = Deduplicazione::Politica::RIFIUTA;
+    if (scelta == politiche.at(1))
+    {
+        politica = Deduplicazione::Politica::UNISCI;
+    }
+    else if (scelta == politiche.at(2))
+    {
+        politica = Deduplicazione::Politica::SEGNALA;
+    }
+
+    try
+    {
+        Deduplicazione::Report report;
+        QString scartati;
+        BatchImporter::Formato formato;
+        if (BatchImporter::formatoDaPath(fileName, &formato))
         {
-            QMessageBox::critical(this, "Errore di caricamento",
-                                  QString("Si è verificato un errore durante il caricamento:\n%1")
-                                      .arg(QString::fromStdString(e.what())));
+            BatchImporter::Opzioni opzioni;
+            opzioni.politica = politica;
+            opzioni.maxErrori = 1;
+            const BatchImporter::Report importazione = BatchImporter::importaThrows(biblioteca, fileName, opzioni);
+            report = importazione.deduplicazione;
+            if (importazione.scartati > 0)
+            {
+                scartati = QString("\nRighe non valide: %1 (prima: riga %2, %3)")
+                               .arg(importazione.scartati)
+                               .arg(importazione.errori.first().riga)
+                               .arg(importazione.errori.first().messaggio);
+            }
         }
-        catch (...)
+        else
         {
-            QMessageBox::critical(this, "Errore imprevisto",
-                                  "Si è verificato un errore imprevisto durante il caricamento della biblioteca.");
+            report = JsonSerializer::importaBibliotecaThrows(biblioteca, fileName, politica);
         }
+        compactSession();
+
+        selectedMedia = nullptr;
+        updateMediaDisplay();
+
+        statusBar()->showMessage(QString("Importati %1 elementi").arg(report.aggiunti), 3000);
+        QMessageBox::information(this, "Importazione Completata",
+                                 QString("Elementi esaminati: %1\n"
+                                         "Aggiunti: %2\n"
+                                         "Duplicati scartati: %3\n"
+                                         "Duplicati uniti: %4\n"
+                                         "Duplicati segnalati: %5%6")
+                                     .arg(report.esaminati)
+                                     .arg(report.aggiunti)
+                                     .arg(report.rifiutati)
+                                     .arg(report.uniti)
+                                     .arg(report.segnalati)
+                                     .arg(scartati));
+    }
+    catch (const BibliotecaException &e)
+    {
+        QMessageBox::critical(this, "Errore di importazione",
+                              QString("Si è verificato un errore durante l'importazione:\n%1")
+                                  .arg(QString::fromStdString(e.what())));
     }
 }
 
@@ -646,7 +1203,7 @@ void MainWindow::onMediaWidgetClicked()
 
                 try
                 {
-                    QString title = media->getTitle();
+                    const QString &title = media->getTitleRef();
                     if (!title.isNull())
                     {
                         statusBar()->showMessage(QString("Selezionato: %1").arg(title), 2000);
@@ -706,7 +1263,7 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
             // Verifica che il puntatore sia effettivamente accessibile (test di lettura sicura)
             try
             {
-                QString testTitle = media->getTitle();
+                const QString &testTitle = media->getTitleRef();
                 if (testTitle.isNull())
                 {
                     // Il puntatore non è valido
@@ -750,7 +1307,7 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
                 try
                 {
                     // Verifica che il titolo sia accessibile prima di usarlo
-                    QString title = media->getTitle();
+                    const QString &title = media->getTitleRef();
                     if (!title.isNull())
                     {
                         statusBar()->showMessage(QString("Selezionato: %1").arg(title), 2000);
@@ -781,50 +1338,53 @@ void MainWindow::loadDefaultLibrary()
 
     if (fileInfo.exists() && fileInfo.isReadable())
     {
-        JsonSerializer serializer;
-        Biblioteca loadedLibrary;
-        if (serializer.caricaBiblioteca(loadedLibrary, exampleFile))
+        // Caricamento differito: all'avvio si decodificano solo tipo, titolo e anno
+        JsonSerializer::Avanzamento opzioni;
+        opzioni.campiDifferiti = true;
+        try
         {
-            biblioteca = loadedLibrary;
+            Biblioteca loadedLibrary;
+            JsonSerializer::caricaBibliotecaThrows(loadedLibrary, exampleFile, opzioni);
+            biblioteca.swap(loadedLibrary);
             selectedMedia = nullptr; // Reset selection
+            compactSession();        // la sessione riparte dalla biblioteca di esempio
             statusBar()->showMessage(QString("Biblioteca di esempio caricata (%1 elementi)").arg(biblioteca.dimensione()), 2000);
         }
+        catch (const BibliotecaException &e)
+        {
+            qDebug() << "Biblioteca di esempio non caricata:" << e.what();
+        }
     }
     else
     {
-        // Se il file di esempio non esiste, controlliamo se c'è un backup dell'ultima sessione
-        QString backupFile = QCoreApplication::applicationDirPath() + "/data/bibliotecas/ultima_sessione.json";
-        QFileInfo backupInfo(backupFile);
-
-        if (backupInfo.exists() && backupInfo.isReadable())
+        // Se il file di esempio non esiste, ripristiniamo l'ultima sessione:
+        // snapshot più le modifiche registrate nel journal
+        try
         {
-            JsonSerializer serializer;
             Biblioteca loadedLibrary;
-            if (serializer.caricaBiblioteca(loadedLibrary, backupFile))
+            const int modifiche = sessione.ripristina(loadedLibrary);
+            biblioteca.swap(loadedLibrary);
+            selectedMedia = nullptr; // Reset selection
+            if (biblioteca.dimensione() > 0 || modifiche > 0)
             {
-                biblioteca = loadedLibrary;
-                selectedMedia = nullptr; // Reset selection
-                statusBar()->showMessage(QString("Ultima sessione ripristinata (%1 elementi)").arg(biblioteca.dimensione()), 2000);
+                statusBar()->showMessage(QString("Ultima sessione ripristinata (%1 elementi, %2 modifiche dal journal)")
+                                             .arg(biblioteca.dimensione())
+                                             .arg(modifiche),
+                                         2000);
             }
         }
+        catch (const BibliotecaException &e)
+        {
+            qDebug() << "Ripristino della sessione non riuscito:" << e.what();
+        }
     }
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
 {
-    // Salva automaticamente la sessione prima di chiudere
-    if (biblioteca.dimensione() > 0)
-    {
-        QString backupDir = QCoreApplication::applicationDirPath() + "/data/bibliotecas";
-        QDir().mkpath(backupDir);
-        QString backupFile = backupDir + "/ultima_sessione.json";
-
-        JsonSerializer serializer;
-        if (serializer.salvaBiblioteca(biblioteca, backupFile))
-        {
-            statusBar()->showMessage("Sessione salvata automaticamente", 1000);
-        }
-    }
+    // La sessione è già sul disco come snapshot più journal: basta confermare
+    // le ultime modifiche; l'eventuale compattazione viene completata dal distruttore
+    commitJournal();
 
     // Accetta l'evento di chiusura
     event->accept();
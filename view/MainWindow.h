@@ -26,9 +26,15 @@
 #include <QDialog>
 #include <QTimer>
 #include <QCoreApplication>
+#include <QJsonObject>
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <memory>
 #include "../model/Biblioteca.h"
 #include "../model/Exceptions.h"
 #include "../persistence/JsonSerializer.h"
+#include "../persistence/AsyncSaver.h"
+#include "../persistence/Journal.h"
 #include "MediaWidgetVisitor.h"
 
 Q_DECLARE_METATYPE(void *)
@@ -39,8 +45,16 @@ class MainWindow : public QMainWindow
 
 public:
     MainWindow(QWidget *parent = nullptr);
+    // Sessione (snapshot e journal) in sessionPath invece che accanto all'eseguibile
+    explicit MainWindow(const QString &sessionPath, QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Carica una biblioteca senza dialoghi (usato anche dai benchmark)
+    void loadLibraryFromFile(const QString &fileName);
+
+    // Metriche correnti, con gli indicatori della biblioteca e della vista aggiornati
+    QJsonObject metricsSnapshot() const;
+
 private slots:
     void addMedia();
     void editMedia();
@@ -48,9 +62,18 @@ private slots:
     void searchMedia();
     void saveLibrary();
     void loadLibrary();
+    void importLibrary();
     void onFilterChanged();
     void showMediaDetails();
     void onMediaWidgetClicked();
+    void nextPage();
+    void previousPage();
+    void showDiagnostics();
+    void onLibraryLoadFinished();
+    void onLibrarySaved(const QString &fileName, int elementi, qint64 generazioneJournal);
+    void commitJournal();
+    void autosaveSession();
+    void onLibrarySaveFailed(const QString &fileName, const QString &messaggio);
 
 private:
     void setupUI();
@@ -62,8 +85,19 @@ private:
     Media *getSelectedMedia();
     void clearLayout(QLayout *layout);
     void addMediaWidgetToGrid(Media *media, int row, int col);
-    QList<Media *> getFilteredMedia() const;
+    MediaFilter::Query getCurrentQuery() const;
+    MediaFilter::Page getFilteredMedia() const;
+    void resetPagination();
+    void updatePaginationControls();
     void loadDefaultLibrary();
+    void installLibrary(Biblioteca &nuova, MediaStore istantanea);
+    void startLibraryLoad(const QString &fileName);
+    void showLoadProgress(const QString &testo, int valore);
+    void showLoadPreview(const QList<Media *> &primi);
+    void scheduleJournalCommit();
+    void compactSession();
+    void compactSession(MediaStore istantanea);
+    static QString sessionFilePath();
 
 protected:
     bool eventFilter(QObject *obj, QEvent *event) override;
@@ -78,9 +112,37 @@ private:
     QScrollArea *scrollArea;
     QWidget *contentWidget;
     QGridLayout *gridLayout;
+    QPushButton *prevPageBtn;
+    QPushButton *nextPageBtn;
+    QLabel *pageLabel;
+
+    // Paginazione: cursore di inizio di ogni pagina visitata (l'ultimo è la pagina corrente)
+    static const int MediaPerPagina = 40;
+    QList<quint32> cursoriPagine;
+    MediaFilter::Page paginaCorrente;
 
     // Selected media for operations
     Media *selectedMedia;
+
+    // Caricamento in background: stato condiviso con il thread di lavoro,
+    // dialogo di avanzamento e copie dei primi record mostrati come anteprima
+    struct CaricamentoInCorso;
+    std::shared_ptr<CaricamentoInCorso> caricamento;
+    QFutureWatcher<void> *caricamentoWatcher = nullptr;
+    QProgressDialog *caricamentoDialog = nullptr;
+    Biblioteca anteprima;
+
+    // Salvataggi in background; salvataggioManuale è il file scelto dall'utente,
+    // per cui mostrare la conferma (l'autosalvataggio aggiorna solo la barra di stato)
+    AsyncSaver *salvataggi;
+    QString salvataggioManuale;
+
+    // Sessione: snapshot ultima_sessione.json (a rotazione) più il journal delle modifiche
+    // successive, confermato in gruppo dopo IntervalloCommit ms e compattato in background
+    // dopo SogliaCompattazione record o, se ci sono modifiche, ogni IntervalloAutosalvataggio ms
+    Journal sessione;
+    QTimer *commitTimer;
+    QTimer *autosaveTimer;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,79 @@
+#include "MediaFieldsForm.h"
+#include <QLineEdit>
+#include <QSpinBox>
+
+MediaFieldsForm::MediaFieldsForm(const QList<Schema::FieldInfo> &fields)
+    : fields(fields)
+{
+}
+
+void MediaFieldsForm::addRows(QFormLayout *layout)
+{
+    for (const Schema::FieldInfo &field : fields)
+    {
+        QWidget *editor = nullptr;
+        if (field.kind == Schema::FieldKind::Integer)
+        {
+            QSpinBox *spin = new QSpinBox();
+            spin->setRange(field.minimum, field.maximum);
+            spin->setSuffix(field.suffix);
+            editor = spin;
+        }
+        else
+        {
+            editor = new QLineEdit();
+        }
+        editors.insert(QString(field.key), editor);
+        layout->addRow(field.label + ":", editor);
+    }
+}
+
+void MediaFieldsForm::load(const Media *media)
+{
+    if (!media)
+        return;
+
+    for (const Schema::FieldInfo &field : fields)
+    {
+        QWidget *editor = editors.value(QString(field.key));
+        if (QSpinBox *spin = qobject_cast<QSpinBox *>(editor))
+        {
+            spin->setValue(field.read(media).toInt());
+        }
+        else if (QLineEdit *edit = qobject_cast<QLineEdit *>(editor))
+        {
+            edit->setText(field.read(media).toString());
+        }
+    }
+}
+
+void MediaFieldsForm::store(Media *media) const
+{
+    if (!media)
+        return;
+
+    for (const Schema::FieldInfo &field : fields)
+    {
+        QWidget *editor = editors.value(QString(field.key));
+        if (QSpinBox *spin = qobject_cast<QSpinBox *>(editor))
+        {
+            field.write(media, spin->value());
+        }
+        else if (QLineEdit *edit = qobject_cast<QLineEdit *>(editor))
+        {
+            field.write(media, edit->text());
+        }
+    }
+}
+
+QString MediaFieldsForm::text(QLatin1String key) const
+{
+    QLineEdit *edit = qobject_cast<QLineEdit *>(editors.value(QString(key)));
+    return edit ? edit->text() : QString();
+}
+
+int MediaFieldsForm::integer(QLatin1String key) const
+{
+    QSpinBox *spin = qobject_cast<QSpinBox *>(editors.value(QString(key)));
+    return spin ? spin->value() : 0;
+}
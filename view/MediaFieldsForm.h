@@ -0,0 +1,44 @@
+#ifndef MEDIAFIELDSFORM_H
+#define MEDIAFIELDSFORM_H
+
+#include <QFormLayout>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QWidget>
+#include "../model/MediaSchema.h"
+
+/**
+ * MediaFieldsForm - Righe di form per i campi specifici di un tipo di Media
+ *
+ * Gli editor (QLineEdit per il testo, QSpinBox per gli interi) vengono generati dallo
+ * schema del tipo: un campo aggiunto in MediaSchema compare automaticamente nei form
+ * di inserimento e modifica. I widget creati appartengono al layout che li ospita.
+ */
+class MediaFieldsForm
+{
+public:
+    explicit MediaFieldsForm(const QList<Schema::FieldInfo> &fields);
+
+    template <typename T>
+    static MediaFieldsForm forType()
+    {
+        return MediaFieldsForm(Schema::fieldInfos<T>());
+    }
+
+    // Crea un editor per ogni campo e lo aggiunge al layout
+    void addRows(QFormLayout *layout);
+
+    // Copia i valori dal Media agli editor e viceversa
+    void load(const Media *media);
+    void store(Media *media) const;
+
+    QString text(QLatin1String key) const;
+    int integer(QLatin1String key) const;
+
+private:
+    QList<Schema::FieldInfo> fields;
+    QHash<QString, QWidget *> editors; // chiave JSON -> editor
+};
+
+#endif // MEDIAFIELDSFORM_H
@@ -2,51 +2,28 @@
 #include "../model/Book.h"
 #include "../model/Film.h"
 #include "../model/MagazineArticle.h"
+#include "../diagnostics/Metrics.h"
+#include "../diagnostics/Tracing.h"
 #include <QFrame>
 #include <QFont>
+#include <QPixmapCache>
 
 MediaWidgetVisitor::MediaWidgetVisitor(bool isEditMode)
     : editMode(isEditMode), currentWidget(nullptr),
       titleEdit(nullptr), yearSpin(nullptr), coverImageEdit(nullptr), browseImageBtn(nullptr),
-      authorEdit(nullptr), isbnEdit(nullptr), publisherEdit(nullptr),
-      directorEdit(nullptr), durationSpin(nullptr), genreEdit(nullptr),
-      articleAuthorEdit(nullptr), magazineEdit(nullptr), doiEdit(nullptr) {}
+      specificFields(nullptr) {}
 
-MediaWidgetVisitor::~MediaWidgetVisitor() {}
+MediaWidgetVisitor::~MediaWidgetVisitor()
+{
+    delete specificFields;
+}
 
 QWidget *MediaWidgetVisitor::visit(Book *book)
 {
     if (editMode)
     {
-        // Modalità edit - crea form di modifica
-        currentWidget = new QWidget();
-        currentWidget->setFixedSize(400, 500);
-
-        QVBoxLayout *mainLayout = new QVBoxLayout(currentWidget);
-        QFormLayout *formLayout = new QFormLayout();
-
-        // Campi comuni
-        createCommonFields(formLayout);
-
-        // Campi specifici per Book
-        authorEdit = new QLineEdit();
-        isbnEdit = new QLineEdit();
-        publisherEdit = new QLineEdit();
-
-        formLayout->addRow("Autore:", authorEdit);
-        formLayout->addRow("ISBN:", isbnEdit);
-        formLayout->addRow("Editore:", publisherEdit);
-
-        mainLayout->addLayout(formLayout);
-
-        // Se c'è un book esistente, popola i campi
-        if (book)
-        {
-            populateFields(book);
-            authorEdit->setText(book->getAuthor());
-            isbnEdit->setText(book->getIsbn());
-            publisherEdit->setText(book->getPublisher());
-        }
+        // Modalità edit - form generato dallo schema di Book
+        currentWidget = createEditForm(Schema::fieldInfos<Book>(), book);
     }
     else
     {
@@ -61,37 +38,8 @@ QWidget *MediaWidgetVisitor::visit(Film *film)
 {
     if (editMode)
     {
-        // Modalità edit - crea form di modifica
-        currentWidget = new QWidget();
-        currentWidget->setFixedSize(400, 500);
-
-        QVBoxLayout *mainLayout = new QVBoxLayout(currentWidget);
-        QFormLayout *formLayout = new QFormLayout();
-
-        // Campi comuni
-        createCommonFields(formLayout);
-
-        // Campi specifici per Film
-        directorEdit = new QLineEdit();
-        durationSpin = new QSpinBox();
-        durationSpin->setRange(1, 600);
-        durationSpin->setSuffix(" min");
-        genreEdit = new QLineEdit();
-
-        formLayout->addRow("Regista:", directorEdit);
-        formLayout->addRow("Durata:", durationSpin);
-        formLayout->addRow("Genere:", genreEdit);
-
-        mainLayout->addLayout(formLayout);
-
-        // Se c'è un film esistente, popola i campi
-        if (film)
-        {
-            populateFields(film);
-            directorEdit->setText(film->getDirector());
-            durationSpin->setValue(film->getDuration());
-            genreEdit->setText(film->getGenre());
-        }
+        // Modalità edit - form generato dallo schema di Film
+        currentWidget = createEditForm(Schema::fieldInfos<Film>(), film);
     }
     else
     {
@@ -106,35 +54,8 @@ QWidget *MediaWidgetVisitor::visit(MagazineArticle *article)
 {
     if (editMode)
     {
-        // Modalità edit - crea form di modifica
-        currentWidget = new QWidget();
-        currentWidget->setFixedSize(400, 500);
-
-        QVBoxLayout *mainLayout = new QVBoxLayout(currentWidget);
-        QFormLayout *formLayout = new QFormLayout();
-
-        // Campi comuni
-        createCommonFields(formLayout);
-
-        // Campi specifici per MagazineArticle
-        articleAuthorEdit = new QLineEdit();
-        magazineEdit = new QLineEdit();
-        doiEdit = new QLineEdit();
-
-        formLayout->addRow("Autore Articolo:", articleAuthorEdit);
-        formLayout->addRow("Rivista:", magazineEdit);
-        formLayout->addRow("DOI:", doiEdit);
-
-        mainLayout->addLayout(formLayout);
-
-        // Se c'è un articolo esistente, popola i campi
-        if (article)
-        {
-            populateFields(article);
-            articleAuthorEdit->setText(article->getAuthor());
-            magazineEdit->setText(article->getMagazine());
-            doiEdit->setText(article->getDoi());
-        }
+        // Modalità edit - form generato dallo schema di MagazineArticle
+        currentWidget = createEditForm(Schema::fieldInfos<MagazineArticle>(), article);
     }
     else
     {
@@ -169,8 +90,25 @@ QWidget *MediaWidgetVisitor::createBaseWidget(const QString &title, int year, co
 
     if (!coverImagePath.isEmpty() && QFileInfo::exists(coverImagePath))
     {
-        QPixmap pixmap(coverImagePath);
-        coverLabel->setPixmap(pixmap.scaled(coverLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+        BIBLIO_TRACE_SCOPE("vista", "MediaWidgetVisitor::copertina");
+        static Metrics::Counter &cacheHit = Metrics::counter("copertine.cache_hit");
+        static Metrics::Counter &cacheMiss = Metrics::counter("copertine.cache_miss");
+
+        // Le miniature già scalate restano in QPixmapCache: ricostruire la griglia
+        // (filtro, pagina) non rilegge né riscala le immagini dal disco
+        const QString chiave = QString("copertina:%1@%2x%3").arg(coverImagePath).arg(coverLabel->width()).arg(coverLabel->height());
+        QPixmap miniatura;
+        if (QPixmapCache::find(chiave, &miniatura))
+        {
+            cacheHit.add();
+        }
+        else
+        {
+            cacheMiss.add();
+            miniatura = QPixmap(coverImagePath).scaled(coverLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            QPixmapCache::insert(chiave, miniatura);
+        }
+        coverLabel->setPixmap(miniatura);
     }
     else
     {
@@ -305,6 +243,29 @@ void MediaWidgetVisitor::addMagazineArticleSpecificInfo(QWidget *widget, const Q
 }
 
 // Metodi per la modalità edit
+QWidget *MediaWidgetVisitor::createEditForm(const QList<Schema::FieldInfo> &fields, Media *media)
+{
+    QWidget *widget = new QWidget();
+    widget->setFixedSize(400, 500);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(widget);
+    QFormLayout *formLayout = new QFormLayout();
+
+    // Campi comuni
+    createCommonFields(formLayout);
+
+    // Campi specifici del tipo
+    delete specificFields;
+    specificFields = new MediaFieldsForm(fields);
+    specificFields->addRows(formLayout);
+
+    mainLayout->addLayout(formLayout);
+
+    // Se c'è un media esistente, popola i campi
+    populateFields(media);
+    return widget;
+}
+
 void MediaWidgetVisitor::createCommonFields(QFormLayout *layout)
 {
     titleEdit = new QLineEdit();
@@ -361,51 +322,6 @@ QString MediaWidgetVisitor::getCoverImagePath() const
     return coverImageEdit ? coverImageEdit->text() : QString();
 }
 
-QString MediaWidgetVisitor::getAuthor() const
-{
-    return authorEdit ? authorEdit->text() : QString();
-}
-
-QString MediaWidgetVisitor::getIsbn() const
-{
-    return isbnEdit ? isbnEdit->text() : QString();
-}
-
-QString MediaWidgetVisitor::getPublisher() const
-{
-    return publisherEdit ? publisherEdit->text() : QString();
-}
-
-QString MediaWidgetVisitor::getDirector() const
-{
-    return directorEdit ? directorEdit->text() : QString();
-}
-
-int MediaWidgetVisitor::getDuration() const
-{
-    return durationSpin ? durationSpin->value() : 0;
-}
-
-QString MediaWidgetVisitor::getGenre() const
-{
-    return genreEdit ? genreEdit->text() : QString();
-}
-
-QString MediaWidgetVisitor::getArticleAuthor() const
-{
-    return articleAuthorEdit ? articleAuthorEdit->text() : QString();
-}
-
-QString MediaWidgetVisitor::getMagazine() const
-{
-    return magazineEdit ? magazineEdit->text() : QString();
-}
-
-QString MediaWidgetVisitor::getDoi() const
-{
-    return doiEdit ? doiEdit->text() : QString();
-}
-
 void MediaWidgetVisitor::populateFields(Media *media)
 {
     if (!media)
@@ -417,4 +333,21 @@ void MediaWidgetVisitor::populateFields(Media *media)
         yearSpin->setValue(media->getYear());
     if (coverImageEdit)
         coverImageEdit->setText(media->getCoverImagePath());
+    if (specificFields)
+        specificFields->load(media);
+}
+
+void MediaWidgetVisitor::store(Media *media) const
+{
+    if (!media)
+        return;
+
+    if (titleEdit)
+        media->setTitle(titleEdit->text());
+    if (yearSpin)
+        media->setYear(yearSpin->value());
+    if (coverImageEdit)
+        media->setCoverImagePath(coverImageEdit->text());
+    if (specificFields)
+        specificFields->store(media);
 }
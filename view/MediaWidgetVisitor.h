@@ -3,6 +3,7 @@
 
 #include "../model/MediaVisitor.h"
 #include "../model/Media.h"
+#include "MediaFieldsForm.h"
 #include <QWidget>
 #include <QLabel>
 #include <QVBoxLayout>
@@ -37,20 +38,8 @@ public:
     int getYear() const;
     QString getCoverImagePath() const;
 
-    // Metodi specifici per Book
-    QString getAuthor() const;
-    QString getIsbn() const;
-    QString getPublisher() const;
-
-    // Metodi specifici per Film
-    QString getDirector() const;
-    int getDuration() const;
-    QString getGenre() const;
-
-    // Metodi specifici per MagazineArticle
-    QString getArticleAuthor() const;
-    QString getMagazine() const;
-    QString getDoi() const;
+    // Copia nel media i campi comuni e quelli specifici generati dallo schema
+    void store(Media *media) const;
 
     // Metodo per popolare i campi in modalità edit
     void populateFields(Media *media);
@@ -68,20 +57,8 @@ private:
     QLineEdit *coverImageEdit;
     QPushButton *browseImageBtn;
 
-    // Campi specifici Book
-    QLineEdit *authorEdit;
-    QLineEdit *isbnEdit;
-    QLineEdit *publisherEdit;
-
-    // Campi specifici Film
-    QLineEdit *directorEdit;
-    QSpinBox *durationSpin;
-    QLineEdit *genreEdit;
-
-    // Campi specifici MagazineArticle
-    QLineEdit *articleAuthorEdit;
-    QLineEdit *magazineEdit;
-    QLineEdit *doiEdit;
+    // Campi specifici del tipo, generati dallo schema
+    MediaFieldsForm *specificFields;
 
     // Metodi helper per modalità display
     QWidget *createBaseWidget(const QString &title, int year, const QString &coverImagePath);
@@ -90,6 +67,7 @@ private:
     void addMagazineArticleSpecificInfo(QWidget *widget, const QString &author, const QString &magazine, const QString &doi);
 
     // Metodi helper per modalità edit
+    QWidget *createEditForm(const QList<Schema::FieldInfo> &fields, Media *media);
     void createCommonFields(QFormLayout *layout);
     void setupImageSelection();
 };
@@ -0,0 +1,19 @@
+# Sorgenti dell'interfaccia grafica, condivisi da app e benchmark GUI
+
+QT *= widgets
+
+SOURCES += \
+    $$PWD/MainWindow.cpp \
+    $$PWD/LoginDialog.cpp \
+    $$PWD/MediaWidgetVisitor.cpp \
+    $$PWD/AddMediaDialog.cpp \
+    $$PWD/EditMediaDialog.cpp \
+    $$PWD/MediaFieldsForm.cpp
+
+HEADERS += \
+    $$PWD/MainWindow.h \
+    $$PWD/LoginDialog.h \
+    $$PWD/MediaWidgetVisitor.h \
+    $$PWD/AddMediaDialog.h \
+    $$PWD/EditMediaDialog.h \
+    $$PWD/MediaFieldsForm.h